@@ -81,83 +81,4139 @@
 
 #include <xc.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
 
-#define Z80_CLK 6000000UL 	// Z80 clock frequency(Max 16MHz)
+#ifndef Z80_CLK
+#define Z80_CLK 6000000UL 	// Z80 clock until one is stored (Max 16MHz)
+#endif
+
+#define UART_DREG 0x00		//Data REG
+#define UART_CREG 0x01		//Control REG
+#define UART_BREG 0x02		//Baud rate REG
+#define CLK_REG 0x03		//Z80 clock REG
+#define INT_CTRL 0x06		//Z80 interrupt enable/status REG
+#define INT_VECT 0x07		//Z80 interrupt IM2 vector REG
+#define STAT_PORT 0x08		//IO statistics port/bucket select REG
+#define STAT_CMD 0x09		//IO statistics command REG
+#define STAT_DATA 0x0a		//IO statistics data REG
+#define TRACE_DUMP 0x0b		//IO trace dump request REG
+
+#define DISK_DRIVE 0x10		//Disk drive REG
+#define DISK_TRACK 0x11		//Disk track REG
+#define DISK_TRACKH 0x12	//Disk track REG high
+#define DISK_SECTOR 0x13	//Disk sector REG
+#define DISK_CMD 0x14		//Disk command/status REG
+#define DISK_DATA 0x15		//Disk data REG
+
+#define BLK_ADDRL 0x18		//Block transfer RAM address low
+#define BLK_ADDRH 0x19		//Block transfer RAM address high
+#define BLK_LENL 0x1a		//Block transfer length low
+#define BLK_LENH 0x1b		//Block transfer length high
+#define BLK_ARG 0x1c		//Block transfer source argument
+#define BLK_CMD 0x1d		//Block transfer command/status REG
+
+#define TIM_US 0x20		//Microsecond counter, 4 bytes LSB first
+#define TIM_TICKL 0x24		//Tick period in ms low
+#define TIM_TICKH 0x25		//Tick period in ms high
+#define TIM_STAT 0x26		//Tick status REG
+
+#define SNAP_SPL 0x28		//Snapshot Z80 SP low
+#define SNAP_SPH 0x29		//Snapshot Z80 SP high
+#define SNAP_CMD 0x2a		//Snapshot command/status REG
+
+#define BLT_SRCL 0x30		//Blitter source address low
+#define BLT_SRCH 0x31		//Blitter source address high
+#define BLT_DSTL 0x32		//Blitter destination address low
+#define BLT_DSTH 0x33		//Blitter destination address high
+#define BLT_LENL 0x34		//Blitter length low
+#define BLT_LENH 0x35		//Blitter length high
+#define BLT_VAL 0x36		//Blitter fill value
+#define BLT_CMD 0x37		//Blitter command/status REG
+
+#define CP_DATA 0x38		//Coprocessor operand/result REG
+#define CP_CMD 0x39		//Coprocessor command/status REG
+
+#ifndef UART_BAUD
+#define UART_BAUD 0			//Baud rate at reset, index into baud_table[]
+#endif
+
+//#define USE_SD			//SD card disk, needs SD_CS wiring
+//#define SD_CS LATxx		//SD card /CS output latch
+//#define SD_CS_TRIS TRISxx
+
+//#define USE_Z80_INT		//Z80 /INT from the PIC, needs /INT and M1 wiring
+//#define Z80_INT LATxx		//Z80 /INT output latch
+//#define Z80_INT_TRIS TRISxx
+//#define Z80_M1 Rxx		//Z80 /M1 input
+//#define Z80_M1_TRIS TRISxx
+//#define Z80_M1_ANSEL ANSELxx
+
+#ifndef ROM_UPLOAD_DMA
+#define ROM_UPLOAD_DMA		//Upload images by DMA, comment out for CPU copy
+#endif
+#ifndef BOOT_IMAGE
+#define BOOT_IMAGE 0		//Default entry of images[]
+#endif
+#ifndef BOOT_SELECT_MS
+#define BOOT_SELECT_MS 1000	//Time to press ESC for the image menu at boot
+#endif
+//#define IO_STATS			//IO counters and CLC_ISR time histogram, costs every IO cycle
+//#define IO_TRACE			//Ring of the last 256 IO cycles, console t dumps it
+//#define Z80_PROF			//Address bus sampling profiler, console p, costs a 97us ISR
+//#define RAM_TEST			//RAM test and bandwidth at boot, 32KB March test
+//#define RAM_TEST_FAST		//RAM_TEST with one data background only, else all three
+
+#ifndef UART_RXBUF_SIZE
+#define UART_RXBUF_SIZE 128	//RX ring buffer (power of 2)
+#endif
+#ifndef UART_TXBUF_SIZE
+#define UART_TXBUF_SIZE 128	//TX ring buffer (power of 2)
+#endif
+#ifndef BLK_UART_TIMEOUT_MS
+#define BLK_UART_TIMEOUT_MS 1000	//Block transfer gives up on a silent UART
+#endif
+#ifndef DISK_FLUSH_MS
+#define DISK_FLUSH_MS 1000	//Disk cache write-back after this long without a write
+#endif
+
+#define _XTAL_FREQ 64000000UL
+
+//Z80 bus interface
+//The IO cycle handshake in the ISRs and io_* code uses these. Pin setup in
+//main(), bus_master()/bus_slave() (TRISB/TRISD/TRISE2, RA2PPS/RA4PPS), the
+//upload DMA (DMAnDSA = &LATC) and the profiler (PORTA) still name registers.
+#define BUS_ADDR_L		PORTB		// A7-A0 input
+#define BUS_DATA_IN		PORTC		// D7-D0 input
+#define BUS_DATA_OUT	LATC		// D7-D0 output latch
+#define BUS_DATA_DIR	TRISC		// D7-D0 direction (0x00:output 0xff:input)
+#define BUS_IO_WRITE	RA5			// /RD=1 in IO cycle: write cycle
+#define BUS_IORQ		RA0			// /IORQ input
+#define BUS_WAIT		RD7			// /WAIT (CLC3 output)
+#define BUS_WAIT_RELEASE()	{ G3POL = 1; G3POL = 0; }	// D-FF reset
+#define BUS_WAIT_DONE()	CLC3IF = 0	// Clear interrupt flag
+#define BUS_READ_END_ARM()	{ IOCAF0 = 0; IOCIE = 1; }	// Catch /IORQ rising edge
+#define BUS_READ_END_DONE()	{ IOCAF0 = 0; IOCIE = 0; }
+
+//Z80 ROM upload interface
+#define BUS_ADDR_OUT_L	LATB		// A7-A0 output latch
+#define BUS_ADDR_OUT_H	LATD		// A15-A8 output latch
+#define BUS_ADDR_OUT_A14 LATE2		// A14 output latch
+#define BUS_WE			LATA2		// /WE output latch
+#define BUS_OE			LATA4		// /OE output latch
+#define BUS_BUSREQ		LATE0		// /BUSREQ output latch
+
+//Z80 image table, see end of this file (generated by tools/mkimage)
+struct image_seg {
+	unsigned int addr;			// Load address
+	unsigned int len;			// Bytes in Z80 RAM
+	unsigned int crc;			// CRC-16/XMODEM of those bytes
+	unsigned char lz;			// data is an LZ stream (tools/lz.h)
+	const unsigned char *data;
+};
+
+struct image {
+	const char *name;
+	unsigned int entry;			// Z80 start address
+	unsigned char seg;			// First entry in image_segs[]
+	unsigned char nseg;			// Number of segments
+};
+
+extern const struct image_seg image_segs[];
+extern const struct image images[];
+extern const unsigned char image_count;
+extern const unsigned char image_seg_count;
+
+//Address Bus
+union {
+	unsigned int w;			//16 bits Address
+	struct {
+		unsigned char l;	//Address low
+		unsigned char h;	//Address high
+	};
+} ab;
+
+//Background tasks
+//Work too slow for an ISR is posted as a bit in task_pend and run by
+//task_run() from the main loop, one task at a time and each to the end,
+//lowest bit first. TASK_POST() and TASK_CLEAR() are single BSF/BCF
+//instructions on a constant mask, so any ISR posts without locking and
+//a post that comes in while its task runs is not lost (the bit is cleared
+//before the task starts). A task posted twice runs once, its data travels
+//in the rings and flags the ISRs already keep (io_wq, tx_buf, io_job).
+#define TASK_JOB		0x01	// io_job, the Z80 waits on /WAIT
+#define TASK_IOWQ		0x02	// Queued OUTs
+#define TASK_UART		0x04	// Baud rate change
+#define TASK_CLK		0x08	// Clock setting into the EEPROM
+#define TASK_DISK		0x10	// Disk cache write-back
+#define TASK_TRACE		0x20	// IO trace dump
+#define TASK_CONSOLE	0x40	// PIC console
+
+volatile unsigned char task_pend;
+
+#define TASK_POST(t)	task_pend |= (t)
+#define TASK_CLEAR(t)	task_pend &= (unsigned char)~(t)
+
+//Z80 IO port handlers
+//CLC_ISR calls io_rd[port] / io_wr[port] directly, so every port costs the
+//same no matter how many devices are mapped. Devices plug in with
+//io_register() before the Z80 starts. Writes are queued and run later
+//(see io_wq_run()), io_register_sync() maps a port whose writes run in
+//CLC_ISR while /WAIT holds the Z80, io_register_direct() one whose reads
+//never see a queued write. Reads of UART_DREG and UART_CREG,
+//which the Z80 polls, are plain calls in CLC_ISR instead of going
+//through the function pointer in io_rd[]. Handlers mark an argument they
+//don't use with (void).
+typedef unsigned char (*io_rd_t)(unsigned char port);
+typedef void (*io_wr_t)(unsigned char port, unsigned char data);
+
+io_rd_t io_rd[256];
+io_wr_t io_wr[256];
+unsigned char io_sync[256 / 8];	// One bit per port
+unsigned char io_obs[256 / 8];	// Reads run the write queue first
+const unsigned char io_bit[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+
+#define IO_SYNC(p)	(io_sync[(p) >> 3] & io_bit[(p) & 7])
+#define IO_OBS(p)	(io_obs[(p) >> 3] & io_bit[(p) & 7])
+
+// Unmapped port
+unsigned char io_rd_none(unsigned char port) {
+	(void)port;
+	return 0xff;				// Invalid data
+}
+
+void io_wr_none(unsigned char port, unsigned char data) {
+	(void)port;
+	(void)data;
+}
+
+// Map a device on a port, NULL leaves that direction unmapped
+void io_register(unsigned char port, io_rd_t rd, io_wr_t wr) {
+	io_rd[port] = rd ? rd : io_rd_none;
+	io_wr[port] = wr ? wr : io_wr_none;
+	io_sync[port >> 3] &= (unsigned char)~io_bit[port & 7];
+	if(rd)
+		io_obs[port >> 3] |= io_bit[port & 7];
+	else
+		io_obs[port >> 3] &= (unsigned char)~io_bit[port & 7];
+}
+
+// Map a device whose writes must run before the Z80 goes on (io_hold())
+void io_register_sync(unsigned char port, io_rd_t rd, io_wr_t wr) {
+	io_register(port, rd, wr);
+	io_sync[port >> 3] |= io_bit[port & 7];
+}
+
+// Map a device whose reads no queued write can change, not even one to
+// another port, so CLC_ISR answers them without emptying the queue
+void io_register_direct(unsigned char port, io_rd_t rd, io_wr_t wr) {
+	io_register(port, rd, wr);
+	io_obs[port >> 3] &= (unsigned char)~io_bit[port & 7];
+}
+
+void io_init(void) {
+	unsigned char i = 0;
+
+	do {
+		io_register(i, NULL, NULL);
+	} while(++i);
+}
+
+//Deferred IO writes
+//CLC_ISR latches the port and data of an OUT into this queue and
+//releases /WAIT at once, the main loop runs the handlers later, oldest
+//first. The order seen by the Z80 is kept by emptying the queue in
+//CLC_ISR before anything that could observe it: an IN from a mapped port
+//not registered with io_register_direct(), an interrupt acknowledge and
+//an OUT to a sync port. Those still run with /WAIT asserted, and so does
+//an OUT that finds the queue full. Handlers always run with CLC_ISR and
+//the low priority ISRs kept out, as in CLC_ISR. A handler that calls
+//io_hold() must be registered with io_register_sync(), the Z80 has gone
+//on by the time a queued write runs.
+#ifndef IO_WQ_SIZE
+#define IO_WQ_SIZE 16		// Queued writes (power of 2), 1 for none
+#endif
+
+unsigned char io_wq_port[IO_WQ_SIZE], io_wq_data[IO_WQ_SIZE];
+volatile unsigned char io_wq_wp, io_wq_rp;	// Write/read index
+
+#define IO_WQ_EMPTY()	(io_wq_wp == io_wq_rp)
+#define IO_WQ_ROOM()	(((io_wq_wp + 1) & (IO_WQ_SIZE - 1)) != io_wq_rp)
+#define IO_WQ_COUNT()	((unsigned char)(io_wq_wp - io_wq_rp) & (IO_WQ_SIZE - 1))
+
+//Main code and the low priority ISRs share state with CLC_ISR. They mask
+//CLC3 and the low priority interrupts, never GIE: IORQ_ISR must still take
+//the data bus off at the /IORQ rising edge after an IN, or the PIC drives
+//D7-D0 into the next opcode fetch of the Z80.
+#define IO_LOCK()	{ INTCON0bits.GIEL = 0; CLC3IE = 0; }
+#define IO_UNLOCK()	{ CLC3IE = 1; INTCON0bits.GIEL = 1; }
+#define IO_LOCKED()	(!INTCON0bits.GIEL)
+
+// Run every queued write (under IO_LOCK() or from CLC_ISR)
+void io_drain(void) {
+	unsigned char rp;
+
+	while(!IO_WQ_EMPTY()) {
+		rp = io_wq_rp;
+		io_wq_rp = (rp + 1) & (IO_WQ_SIZE - 1);
+		io_wr[io_wq_port[rp]](io_wq_port[rp], io_wq_data[rp]);
+	}
+}
+
+// TASK_IOWQ, one write per IO_LOCK() window
+void io_wq_run(void) {
+	unsigned char rp;
+
+	while(!IO_WQ_EMPTY()) {
+		IO_LOCK();				// Keep CLC_ISR out of the handler
+		if(!IO_WQ_EMPTY()) {	// CLC_ISR may have emptied it
+			rp = io_wq_rp;
+			io_wq_rp = (rp + 1) & (IO_WQ_SIZE - 1);
+			io_wr[io_wq_port[rp]](io_wq_port[rp], io_wq_data[rp]);
+		}
+		IO_UNLOCK();
+	}
+}
+
+//Z80 IO statistics
+//IN/OUT count per port and a histogram of CLC_ISR time from entry to the
+//WAIT release, taken with TMR1 at Fosc/4 (62.5ns). Bucket n counts cycles
+//of n-n+1us, the last one everything longer. The interrupt latency before
+//CLC_ISR runs (3-5Tcy, fixed) is not included. Jobs held for TASK_JOB only
+//count the OUT. The Z80 reads them at STAT_DATA after selecting with
+//STAT_PORT and STAT_CMD, the PIC console dumps them.
+#define STAT_BUCKETS 16
+
+#ifdef IO_STATS
+unsigned long stat_in[256], stat_out[256];
+unsigned long stat_hist[STAT_BUCKETS];
+unsigned int stat_t;
+
+#define STAT_START()	stat_t = TMR1
+#define STAT_END()		{ stat_t = TMR1 - stat_t; \
+						  stat_hist[stat_t >= STAT_BUCKETS * 16 ? STAT_BUCKETS - 1 : stat_t >> 4]++; }
+#define STAT_IN(p)		stat_in[p]++
+#define STAT_OUT(p)		stat_out[p]++
+#else
+#define STAT_START()
+#define STAT_END()
+#define STAT_IN(p)
+#define STAT_OUT(p)
+#endif
+
+//Z80 IO trace
+//CLC_ISR appends every IO cycle to a 256 entry ring: port, data, flags
+//and TMR0, the low 16 bits of the TIM_US microsecond counter. It is
+//stored after /WAIT is released, so the Z80 only waits for it when its
+//next IO cycle follows within about 1us. One array per field keeps the
+//store to an 8-bit index. The console t command or an OUT to TRACE_DUMP
+//sends the ring to the UART, tools/iotrace decodes it.
+#define TRACE_OUT	0x01	// OUT, else IN
+#define TRACE_INTA	0x02	// Interrupt acknowledge, data is the vector
+#define TRACE_HELD	0x04	// OUT held for a bus job
+#define TRACE_QUEUED	0x08	// OUT queued for the main loop
+
+#ifdef IO_TRACE
+unsigned char trace_port[256], trace_data[256], trace_flag[256];
+unsigned char trace_tl[256], trace_th[256];
+unsigned char trace_wp;			// Next entry
+unsigned char trace_wrap;		// Ring has been filled once
+
+#define TRACE(f, d)		{ trace_tl[trace_wp] = TMR0L; trace_th[trace_wp] = TMR0H; \
+						  trace_port[trace_wp] = ab.l; trace_data[trace_wp] = d; \
+						  trace_flag[trace_wp] = f; if(!++trace_wp) trace_wrap = 1; }
+#else
+#define TRACE(f, d)
+#endif
+
+
+//UART3 ring buffers
+//RX: filled by UART_RX_ISR, drained by the Z80 through UART_DREG
+//TX: filled by the Z80 and putch(), drained by UART_TX_ISR
+unsigned char rx_buf[UART_RXBUF_SIZE];
+unsigned char tx_buf[UART_TXBUF_SIZE];
+volatile unsigned char rx_wp, rx_rp;	// RX write/read index
+volatile unsigned char tx_wp, tx_rp;	// TX write/read index
+
+#define CONSOLE_KEY 0x1c	// Ctrl-'\', kept out of rx_buf, starts the PIC console
+volatile unsigned char console_req;
+
+#define TX_COUNT()	((unsigned char)(tx_wp - tx_rp) & (UART_TXBUF_SIZE - 1))
+#define RX_READY()	(rx_wp != rx_rp)
+#define TX_READY()	(TX_COUNT() != UART_TXBUF_SIZE - 1)
+
+#ifdef USE_Z80_INT
+//Z80 maskable interrupt
+//The PIC holds /INT low while an enabled condition is true: RX data in
+//the buffer, room in the TX buffer (enable that one only while there is
+//something to send) or an unread timer tick. The interrupt acknowledge
+//(IORQ with M1) also stops the Z80 on /WAIT; CLC_ISR answers it with
+//INT_VECT for RX, INT_VECT+2 for TX and INT_VECT+4 for the tick (IM2),
+//IM1 ignores the byte. Needs a pin for /INT and
+//one for /M1, without M1 an acknowledge would look like an OUT.
+#if !defined(Z80_INT) || !defined(Z80_M1)
+#error "USE_Z80_INT needs Z80_INT, Z80_INT_TRIS, Z80_M1, Z80_M1_TRIS and Z80_M1_ANSEL"
+#endif
+#define INT_RX		0x01
+#define INT_TX		0x02
+#define INT_TICK	0x04
+
+unsigned char int_mask;		// Enabled conditions
+unsigned char int_vect;		// IM2 vector, bit0 is ignored
+extern volatile unsigned char tim_ticks;
+
+unsigned char int_pending(void) {
+	return (unsigned char)(((RX_READY() ? INT_RX : 0) | (TX_READY() ? INT_TX : 0)
+		| (tim_ticks ? INT_TICK : 0)) & int_mask);
+}
+
+void int_update(void) {
+	Z80_INT = int_pending() ? 0 : 1;
+}
+
+unsigned char int_vector(void) {
+	unsigned char p = int_pending();
+
+	return (int_vect & 0xfe) + (p & INT_RX ? 0 : p & INT_TX ? 2 : 4);
+}
+
+#define INT_UPDATE()		int_update()
+#define INT_UPDATE_LOW()	{ IO_LOCK(); int_update(); IO_UNLOCK(); }	// From low priority ISRs and jobs
+#else
+#define INT_UPDATE()
+#define INT_UPDATE_LOW()
+#endif
+
+//UART3 baud rate
+//Writing an index to UART_BREG requests a change. It is applied once
+//everything already in the TX buffer has left the shift register, so no
+//byte goes out half at the old rate: UART_TX_ISR enables the TX shift
+//register empty interrupt when tx_buf runs dry, and UART_TXMT_ISR posts
+//TASK_UART. Reading UART_BREG returns the active index with bit7 set
+//while a change is still pending.
+const unsigned long baud_table[] = {
+	9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000
+};
+#define BAUD_TABLE_SIZE (sizeof(baud_table) / sizeof(baud_table[0]))
+unsigned char uart_baud;				// Active index
+volatile unsigned char uart_baud_req;	// Requested index
+
+void uart_set_baud(unsigned char n) {
+	unsigned long b = baud_table[n];
+
+	if(b < 57600) {
+		U3CON0bits.BRGS = 0;	// Normal speed: Fosc/16
+		U3BRG = (unsigned int)((_XTAL_FREQ / 16 + b / 2) / b - 1);
+	} else {
+		U3CON0bits.BRGS = 1;	// High speed: Fosc/4
+		U3BRG = (unsigned int)((_XTAL_FREQ / 4 + b / 2) / b - 1);
+	}
+	uart_baud = uart_baud_req = n;
+}
+
+// TASK_UART: apply a pending baud rate change once TX is idle
+void uart_baud_task(void) {
+	if(uart_baud_req == uart_baud || tx_wp != tx_rp)
+		return;					// UART_TX_ISR arms TXMTIE when tx_buf is empty
+	if(!U3TXMTIF) {
+		U3ERRIEbits.TXMTIE = 1;	// Last byte still in the shift register
+		return;
+	}
+	uart_set_baud(uart_baud_req);
+}
+
+// UART3 status seen by the Z80 at UART_CREG (same bits as PIR9)
+// bit0: RX data available, bit1: TX buffer has room
+// TX room counts every queued write as a UART_DREG byte, so the port
+// needs no io_drain() and a queued byte is never dropped
+unsigned char uart_creg_rd(unsigned char port) {
+	(void)port;
+	return (unsigned char)((RX_READY() ? 0x01 : 0)
+		| (TX_COUNT() + IO_WQ_COUNT() < UART_TXBUF_SIZE - 1 ? 0x02 : 0));
+}
+
+// Insert into TX buffer, 0 when it is full (caller keeps CLC_ISR from racing)
+// Only UART_TX_ISR takes bytes out: CLC_ISR can interrupt it half way.
+unsigned char uart_tx_put(unsigned char c) {
+	if(!TX_READY())
+		return 0;
+	tx_buf[tx_wp] = c;
+	tx_wp = (tx_wp + 1) & (UART_TXBUF_SIZE - 1);
+	U3TXIE = 1;					// Start draining
+	return 1;
+}
+
+// Put in RX buffer, dropped on overrun
+void uart_rx_put(unsigned char c) {
+	unsigned char wp = (rx_wp + 1) & (UART_RXBUF_SIZE - 1);
+
+	if(wp != rx_rp) {
+		rx_buf[rx_wp] = c;
+		rx_wp = wp;
+	}
+}
+
+// Take from RX buffer, 0xff when empty
+unsigned char uart_rx_get(void) {
+	unsigned char c;
+
+	if(!RX_READY())
+		return 0xff;
+	c = rx_buf[rx_rp];
+	rx_rp = (rx_rp + 1) & (UART_RXBUF_SIZE - 1);
+	return c;
+}
+
+// UART3 ports
+unsigned char uart_dreg_rd(unsigned char port) {
+	unsigned char c = uart_rx_get();
+
+	(void)port;
+	INT_UPDATE();
+	return c;
+}
+
+// A byte written while UART_CREG bit1 reads 0 is dropped
+void uart_dreg_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	uart_tx_put(data);
+	INT_UPDATE();
+}
+
+unsigned char uart_breg_rd(unsigned char port) {
+	(void)port;
+	return uart_baud_req != uart_baud ? uart_baud | 0x80 : uart_baud;
+}
+
+void uart_breg_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	if(data < BAUD_TABLE_SIZE) {
+		uart_baud_req = data;	// Request baud rate change
+		TASK_POST(TASK_UART);
+	}
+}
+
+//Z80 timer
+//TIM_US-TIM_US+3: free running 32-bit microsecond counter, TMR0 at
+//Fosc/4 1:16 for the low 16 bits and its overflow interrupt for the high
+//16. Reading TIM_US latches all four bytes, read it first.
+//TIM_TICKL/H: tick period in ms (0: off), TMR4 interrupts every 1ms.
+//TIM_STAT read: ticks since the last read (stops at 255), then clears.
+//With USE_Z80_INT a pending tick raises /INT (INT_TICK).
+volatile unsigned int tim_hi;			// Counter bits 31-16
+volatile unsigned char tim_ticks;		// Ticks not read yet
+unsigned int tim_period, tim_ms;
+union {
+	unsigned long l;
+	unsigned char b[4];
+} tim_latch;
+
+unsigned char tim_reg_rd(unsigned char port) {
+	unsigned char l, t;
+	unsigned int hi;
+
+	switch(port) {
+	case TIM_US:
+		l = TMR0L;				// Latches TMR0H
+		tim_latch.b[0] = l;
+		tim_latch.b[1] = TMR0H;
+		hi = tim_hi;
+		if(TMR0IF && !(tim_latch.b[1] & 0x80))
+			hi++;				// Wrapped, TIM_ISR has not run yet
+		tim_latch.b[2] = hi & 0xff;
+		tim_latch.b[3] = hi >> 8;
+		return l;
+	case TIM_US + 1:
+	case TIM_US + 2:
+	case TIM_US + 3:
+		return tim_latch.b[port - TIM_US];
+	case TIM_TICKL:
+		return tim_period & 0xff;
+	case TIM_TICKH:
+		return tim_period >> 8;
+	}
+	t = tim_ticks;
+	tim_ticks = 0;
+	INT_UPDATE();
+	return t;
+}
+
+void tim_reg_wr(unsigned char port, unsigned char data) {
+	if(port == TIM_TICKL)
+		tim_period = (tim_period & 0xff00) | data;
+	else if(port == TIM_TICKH)
+		tim_period = (tim_period & 0x00ff) | ((unsigned int)data << 8);
+	else
+		return;
+	tim_ms = 0;					// Restart the period
+}
+
+// Called after boot: TMR0 was the upload timer until here
+void tim_init(void) {
+	unsigned char p;
+
+	T0CON0 = 0x00;			// Stop
+	T0CON1 = 0x44;			// Fosc/4, 1:16 = 1us
+	TMR0H = 0;
+	TMR0L = 0;
+	TMR0IF = 0;
+	T0CON0 = 0x90;			// Enable, 16-bit
+
+	T4CLKCON = 0x01;		// Fosc/4
+	T4HLT = 0x00;			// Free running
+	T4PR = 124;				// 16MHz / 128 / 125 = 1kHz
+	T4CON = 0xf0;			// On, 1:128, postscaler 1:1
+
+	for(p = TIM_US; p <= TIM_STAT; p++)
+		io_register(p, tim_reg_rd, tim_reg_wr);
+}
+
+#ifdef USE_Z80_INT
+// INT_CTRL read: pending conditions, write: enable mask
+unsigned char int_reg_rd(unsigned char port) {
+	return port == INT_CTRL ? int_pending() : int_vect;
+}
+
+void int_reg_wr(unsigned char port, unsigned char data) {
+	if(port == INT_CTRL)
+		int_mask = data & (INT_RX | INT_TX | INT_TICK);
+	else
+		int_vect = data;
+	int_update();
+}
+#endif
+
+void uart_io_init(void) {
+	io_register_direct(UART_DREG, uart_dreg_rd, uart_dreg_wr);
+	io_register_direct(UART_CREG, uart_creg_rd, NULL);
+	io_register(UART_BREG, uart_breg_rd, uart_breg_wr);
+#ifdef USE_Z80_INT
+	io_register(INT_CTRL, int_reg_rd, int_reg_wr);
+	io_register(INT_VECT, int_reg_rd, int_reg_wr);
+#endif
+}
+
+// UART3 Transmit
+void putch(char c) {
+	unsigned char ok;
+
+	if(!GIE || IO_LOCKED()) {	// Before Z80 start or from a handler
+		while(!U3TXIF);			// UART_TX_ISR can't run, straight to the UART
+		U3TXB = c;
+		return;
+	}
+	do {
+		while(!TX_READY())		// Let UART_TX_ISR make room
+			;
+		IO_LOCK();				// Keep CLC_ISR out of the buffer
+		ok = uart_tx_put(c);	// The Z80 may have taken the room
+		IO_UNLOCK();
+	} while(!ok);
+}
+
+// UART3 Recive
+char getch(void) {
+	while(!RX_READY());			// Wait for UART_RX_ISR
+	return (char)uart_rx_get();
+}
+
+// Never called, logically
+void __interrupt(irq(default),base(8)) Default_ISR(){}
+
+//Z80 RAM access with the PIC as bus master (Z80 held by /BUSREQ)
+void bus_addr(unsigned int addr) {
+	ab.w = addr;
+	BUS_ADDR_OUT_H = ab.h;
+	BUS_ADDR_OUT_A14 = (ab.h >> 6) & 1;
+	BUS_ADDR_OUT_L = ab.l;
+}
+
+void bus_write(unsigned int addr, unsigned char data) {
+	bus_addr(addr);
+	BUS_DATA_DIR = 0x00;	// Set as output
+	BUS_WE = 0;		// /WE=0
+	BUS_DATA_OUT = data;
+	BUS_WE = 1;		// /WE=1
+}
+
+void bus_write_block(unsigned int addr, const unsigned char *src, unsigned int len) {
+	bus_addr(addr);
+	BUS_DATA_DIR = 0x00;	// Set as output
+	while(len--) {
+		BUS_WE = 0;		// /WE=0
+		BUS_DATA_OUT = *src++;
+		BUS_WE = 1;		// /WE=1
+		if(!++BUS_ADDR_OUT_L)	// Next page
+			bus_addr((ab.w & 0xff00) + 0x100);
+	}
+}
+
+unsigned char bus_read(unsigned int addr) {
+	unsigned char data;
+
+	bus_addr(addr);
+	BUS_DATA_DIR = 0xff;	// Set as input
+	BUS_OE = 0;		// /OE=0
+	NOP();			// SRAM access time
+	NOP();
+	data = BUS_DATA_IN;
+	BUS_OE = 1;		// /OE=1
+	return data;
+}
+
+void bus_read_block(unsigned int addr, unsigned char *dst, unsigned int len) {
+	bus_addr(addr);
+	BUS_DATA_DIR = 0xff;	// Set as input
+	while(len--) {
+		BUS_OE = 0;		// /OE=0
+		NOP();			// SRAM access time
+		NOP();
+		*dst++ = BUS_DATA_IN;
+		BUS_OE = 1;		// /OE=1
+		if(!++BUS_ADDR_OUT_L)	// Next page
+			bus_addr((ab.w & 0xff00) + 0x100);
+	}
+}
+
+//Z80 IO jobs that need the bus
+//An io_wr handler that has to move data over the Z80 bus calls io_hold().
+//CLC_ISR then returns with /WAIT still asserted and TASK_JOB runs it,
+//so the UART interrupts keep going while it works. The job takes the bus
+//with z80_bus_acquire() and gives it back with z80_bus_release().
+typedef void (*io_job_t)(void);
+volatile io_job_t io_job;
+
+void io_hold(io_job_t job) {
+	io_job = job;
+	TASK_POST(TASK_JOB);
+}
+
+// TASK_JOB
+void io_job_run(void) {
+	io_job_t job = io_job;
+
+	if(job) {
+		io_job = NULL;			// Z80 is held, nothing can set it meanwhile
+		job();
+	}
+}
+
+// PIC drives the address bus, /WE and /OE (Z80 already off the bus)
+void bus_master(void) {
+	BUS_WE = 1;				// /WE=1
+	BUS_OE = 1;				// /OE=1
+	RA2PPS = 0x00;			// LATA2 -> RA2
+	RA4PPS = 0x00;			// LATA4 -> RA4
+	TRISB = 0x00;			// A7-A0 output
+	TRISD = 0x40;			// A13-A8 output, RD6 /RFSH input, RD7 /WAIT
+	TRISE2 = 0;				// A14 output
+}
+
+// CRC-16/XMODEM, as in the image table
+unsigned int crc16(unsigned int crc, unsigned char c) {
+	unsigned char i;
+
+	crc ^= (unsigned int)c << 8;
+	for(i = 0; i < 8; i++)
+		crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	return crc;
+}
+
+// Binary dumps to the console: bytes go out through dump_crc
+unsigned int dump_crc;
+
+void dump_put(unsigned char c) {
+	dump_crc = crc16(dump_crc, c);
+	putch((char)c);
+}
+
+//Take the bus from a Z80 held in an IO write
+//First /BUSREQ goes low while /WAIT still holds the Z80, then WAIT is
+//released so it finishes the IO cycle and floats the bus.
+void z80_bus_acquire(void) {
+	BUS_BUSREQ = 0;			// /BUSREQ=0
+	BUS_WAIT_RELEASE();
+	while(!BUS_IORQ);		// IO cycle over
+	__delay_us(2);			// Bus floats at the end of the machine cycle
+	bus_master();
+}
+
+// PIC lets go of the bus, /OE and /WE back to the CLCs (Z80 still held)
+void bus_slave(void) {
+	BUS_DATA_DIR = 0xff;	// Set as input
+	TRISB = 0xff;			// A7-A0 input
+	TRISD = 0x7f;			// A13-A8 input, RD7 /WAIT
+	TRISE2 = 1;				// A14 input
+	RA4PPS = 0x01;			// CLC1 -> RA4 -> /OE
+	RA2PPS = 0x02;			// CLC2 -> RA2 -> /WE
+}
+
+void z80_bus_release(void) {
+	bus_slave();
+	BUS_BUSREQ = 1;			// /BUSREQ=1
+}
+
+//Stop a running Z80 for a background task
+//First /BUSREQ goes low and the Z80 floats the bus at the end of its
+//machine cycle. An IO cycle it was in has been through CLC_ISR by then:
+//a queued OUT runs here, while a bus job keeps the Z80 on /WAIT and on
+//the bus. Then /BUSREQ goes back up and 0 tells the task to post itself
+//again, TASK_JOB runs first. Setting /BUSREQ=1 lets the Z80 go on
+//(z80_bus_release() after bus_master()).
+unsigned char z80_stop(void) {
+	BUS_BUSREQ = 0;			// /BUSREQ=0
+	__delay_us(10);			// Z80 finishes its machine cycle
+	if(io_job) {
+		BUS_BUSREQ = 1;		// /BUSREQ=1
+		return 0;
+	}
+	io_wq_run();			// Its last OUTs
+	return 1;
+}
+
+#ifdef USE_SD
+//SD card on SPI1
+//MEZ80RAM has no spare pins, so SPI1 borrows D0-D2 while the Z80 is off
+//the bus (/BUSREQ). The card /CS needs a line of its own: define SD_CS
+//and SD_CS_TRIS for the pin it is wired to.
+#ifndef SD_CS
+#error "USE_SD needs SD_CS and SD_CS_TRIS"
+#endif
+#define PPS_SPI1SCK		0x31		// RxyPPS: SPI1 SCK
+#define PPS_SPI1SDO		0x32		// RxyPPS: SPI1 SDO
+#define SPI_BAUD_INIT	79			// 64MHz / (2 * 80) = 400kHz
+#define SPI_BAUD_FAST	3			// 64MHz / (2 * 4) = 8MHz
+
+unsigned char sd_hc;				// Block addressed (SDHC/SDXC)
+
+// D0:SDO D1:SCK D2:SDI
+void spi_bus_on(void) {
+	BUS_DATA_DIR = 0xfc;		// RC0,RC1 output
+	RC0PPS = PPS_SPI1SDO;
+	RC1PPS = PPS_SPI1SCK;
+	SPI1SCKPPS = 0x11;			// RC1 (slave clock input, unused in master)
+	SPI1SDIPPS = 0x12;			// RC2 <- SDI
+	SPI1CON0bits.EN = 1;
+}
+
+void spi_bus_off(void) {
+	SPI1CON0bits.EN = 0;
+	RC0PPS = 0x00;				// LATC0 -> RC0
+	RC1PPS = 0x00;				// LATC1 -> RC1
+	BUS_DATA_DIR = 0xff;		// Set as input
+}
+
+unsigned char spi_xfer(unsigned char d) {
+	SPI1TXB = d;
+	while(!SPI1RXIF);
+	return SPI1RXB;
+}
+
+unsigned char sd_cmd(unsigned char cmd, unsigned long arg, unsigned char crc) {
+	unsigned char r, i;
+
+	SD_CS = 1;
+	spi_xfer(0xff);
+	SD_CS = 0;
+	spi_xfer(0xff);
+	spi_xfer(0x40 | cmd);
+	spi_xfer((unsigned char)(arg >> 24));
+	spi_xfer((unsigned char)(arg >> 16));
+	spi_xfer((unsigned char)(arg >> 8));
+	spi_xfer((unsigned char)arg);
+	spi_xfer(crc);
+	for(i = 0; i < 10; i++) {
+		r = spi_xfer(0xff);
+		if(!(r & 0x80))
+			break;
+	}
+	return r;
+}
+
+void sd_end(void) {
+	SD_CS = 1;
+	spi_xfer(0xff);
+}
+
+// Wait for the card to leave busy, 0 on timeout
+unsigned char sd_wait_ready(void) {
+	unsigned long n;
+
+	for(n = 0; n < 500000UL; n++)
+		if(spi_xfer(0xff) == 0xff)
+			return 1;
+	return 0;
+}
+
+// 0 on success
+unsigned char sd_init(void) {
+	unsigned char i, r, ocr[4];
+	unsigned int n;
+
+	SPI1CON0 = 0x03;		// Master, BMODE, disabled
+	SPI1CON1 = 0x40;		// Mode 0
+	SPI1CON2 = 0x03;		// Full duplex
+	SPI1CLK = 0x00;			// Fosc
+	SPI1BAUD = SPI_BAUD_INIT;
+	SD_CS = 1;
+	SD_CS_TRIS = 0;			// Set as output
+	spi_bus_on();
+
+	for(i = 0; i < 10; i++)	// 80 clocks with /CS high
+		spi_xfer(0xff);
+	r = 1;
+	if(sd_cmd(0, 0, 0x95) != 0x01)	// GO_IDLE_STATE
+		goto out;
+	sd_hc = 0;
+	if(sd_cmd(8, 0x1aa, 0x87) == 0x01) {	// SEND_IF_COND: v2 card
+		for(i = 0; i < 4; i++)
+			ocr[i] = spi_xfer(0xff);
+		sd_hc = 1;
+	}
+	for(n = 0; n < 1000; n++) {
+		sd_cmd(55, 0, 0x01);				// APP_CMD
+		if(sd_cmd(41, sd_hc ? 0x40000000UL : 0, 0x01) == 0)	// SD_SEND_OP_COND
+			break;
+		__delay_ms(1);
+	}
+	if(n == 1000)
+		goto out;
+	if(sd_hc) {
+		if(sd_cmd(58, 0, 0x01))				// READ_OCR
+			goto out;
+		for(i = 0; i < 4; i++)
+			ocr[i] = spi_xfer(0xff);
+		sd_hc = (ocr[0] & 0x40) != 0;		// CCS
+	}
+	if(!sd_hc && sd_cmd(16, 512, 0x01))		// SET_BLOCKLEN
+		goto out;
+	r = 0;
+out:
+	sd_end();
+	SPI1CON0bits.EN = 0;
+	SPI1BAUD = SPI_BAUD_FAST;
+	spi_bus_off();
+	return r;
+}
+
+// 0 on success
+unsigned char sd_read(unsigned long lba, unsigned char *buf) {
+	unsigned int n;
+	unsigned char r = 0xff;
+
+	if(sd_cmd(17, sd_hc ? lba : lba << 9, 0x01))	// READ_SINGLE_BLOCK
+		goto err;
+	for(n = 0; n < 50000 && r == 0xff; n++)
+		r = spi_xfer(0xff);
+	if(r != 0xfe)							// Data token
+		goto err;
+	for(n = 0; n < 512; n++)
+		buf[n] = spi_xfer(0xff);
+	spi_xfer(0xff);							// CRC
+	spi_xfer(0xff);
+	sd_end();
+	return 0;
+err:
+	sd_end();
+	return 1;
+}
+
+// Multi block write: sd_write_start, sd_write_block..., sd_write_end
+unsigned char sd_write_start(unsigned long lba) {
+	return sd_cmd(25, sd_hc ? lba : lba << 9, 0x01) != 0;	// WRITE_MULTIPLE_BLOCK
+}
+
+unsigned char sd_write_block(const unsigned char *buf) {
+	unsigned int n;
+
+	spi_xfer(0xff);
+	spi_xfer(0xfc);							// Data token
+	for(n = 0; n < 512; n++)
+		spi_xfer(buf[n]);
+	spi_xfer(0xff);							// CRC
+	spi_xfer(0xff);
+	if((spi_xfer(0xff) & 0x1f) != 0x05)		// Data accepted
+		return 1;
+	return !sd_wait_ready();
+}
+
+unsigned char sd_write_end(void) {
+	unsigned char r;
+
+	spi_xfer(0xfd);							// Stop token
+	spi_xfer(0xff);
+	r = !sd_wait_ready();
+	sd_end();
+	return r;
+}
+
+//Sector cache
+//LRU write-back cache of 512 byte blocks. Dirty blocks are written back
+//together, neighbours coalesced into one multi block write.
+#ifdef _18F47Q43
+#define DISK_CACHE_BLOCKS 4
+#else
+#define DISK_CACHE_BLOCKS 12
+#endif
+
+#define DISK_LBA_BAD 0xffffffffUL	// No such block, see drive_lba()
+
+struct cache {
+	unsigned long lba;
+	unsigned long age;				// Last use, 0 = empty
+	unsigned char dirty;
+	unsigned char buf[512];
+} cache[DISK_CACHE_BLOCKS];
+unsigned long cache_tick;
+
+//Every disk write restarts a DISK_FLUSH_MS countdown in TICK_ISR, handed
+//over through disk_wb_req so no lock is needed. TASK_DISK writes the
+//dirty blocks back once the Z80 has stopped writing, a reset or power
+//off loses at most that much.
+volatile unsigned char disk_wb_req;
+unsigned int disk_wb_ms;			// TICK_ISR only
+
+// Write back every dirty block, 0 on success. On an error the block that
+// failed and the ones not written yet stay dirty for the next flush.
+unsigned char disk_flush(void) {
+	unsigned char i, j;
+	struct cache *c;
+
+	while(1) {
+		c = NULL;						// Lowest dirty block
+		for(i = 0; i < DISK_CACHE_BLOCKS; i++)
+			if(cache[i].dirty && (!c || cache[i].lba < c->lba))
+				c = &cache[i];
+		if(!c)
+			return 0;
+		if(sd_write_start(c->lba)) {
+			sd_end();
+			return 1;
+		}
+		do {							// Run of consecutive blocks
+			if(sd_write_block(c->buf)) {
+				sd_write_end();
+				return 1;
+			}
+			c->dirty = 0;
+			j = 0;
+			for(i = 0; i < DISK_CACHE_BLOCKS; i++)
+				if(cache[i].dirty && cache[i].lba == c->lba + 1) {
+					c = &cache[i];
+					j = 1;
+					break;
+				}
+		} while(j);
+		if(sd_write_end())
+			return 1;
+	}
+}
+
+// Block buffer for lba, read from the card when fill is set. NULL on error
+// and for DISK_LBA_BAD
+struct cache *cache_get(unsigned long lba, unsigned char fill) {
+	unsigned char i;
+	struct cache *c = &cache[0];
+
+	if(lba == DISK_LBA_BAD)
+		return NULL;
+	for(i = 0; i < DISK_CACHE_BLOCKS; i++) {
+		if(cache[i].age && cache[i].lba == lba) {
+			cache[i].age = ++cache_tick;
+			return &cache[i];
+		}
+		if(cache[i].age < c->age)
+			c = &cache[i];				// Least recently used
+	}
+	if(c->dirty && disk_flush())
+		return NULL;
+	c->lba = lba;
+	c->age = 0;
+	if(fill && sd_read(lba, c->buf))
+		return NULL;
+	c->age = ++cache_tick;
+	return c;
+}
+
+struct cache *disk_cache(unsigned long lba) {
+	return cache_get(lba, 1);
+}
+
+//FAT32 volume
+//Drive A-D are the files DRIVEA.DSK-DRIVED.DSK in the root directory.
+#define DISK_DRIVES 4
+
+unsigned long fat_lba;				// First FAT sector
+unsigned long data_lba;				// Cluster 2
+unsigned char fat_spc;				// Sectors per cluster
+unsigned long fat_root;				// Root directory cluster
+
+struct drive {
+	unsigned long start;			// First cluster, 0 = none
+	unsigned long size;				// Bytes
+	unsigned long cl;				// Cluster cl_idx of the file
+	unsigned long cl_idx;
+} drive[DISK_DRIVES];
+struct drive snap_file;				// SNAPSHOT.BIN, see RAM snapshot
+
+// Little endian fields, widened before the shift (int is 16 bits)
+unsigned int get16(const unsigned char *p) {
+	return p[0] | ((unsigned int)p[1] << 8);
+}
+
+unsigned long get32(const unsigned char *p) {
+	return p[0] | ((unsigned long)p[1] << 8) | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+// First cluster of a directory entry
+unsigned long fat_dir_cluster(const unsigned char *p) {
+	return ((unsigned long)get16(&p[20]) << 16) | get16(&p[26]);
+}
+
+unsigned long fat_next(unsigned long cl) {
+	struct cache *c = disk_cache(fat_lba + (cl >> 7));
+
+	if(!c)
+		return 0x0fffffffUL;
+	return get32(&c->buf[(cl & 0x7f) * 4]) & 0x0fffffffUL;
+}
+
+unsigned long fat_cl_lba(unsigned long cl) {
+	return data_lba + (cl - 2) * fat_spc;
+}
+
+// 0 on success
+unsigned char fat_mount(void) {
+	struct cache *c;
+	unsigned long part = 0;
+	unsigned char *b;
+
+	if(!(c = disk_cache(0)))
+		return 1;
+	b = c->buf;
+	if(b[510] != 0x55 || b[511] != 0xaa)
+		return 1;
+	if(b[0x1c2] == 0x0b || b[0x1c2] == 0x0c) {	// MBR, FAT32 partition 1
+		part = get32(&b[0x1c6]);
+		if(!(c = disk_cache(part)))
+			return 1;
+		b = c->buf;
+	}
+	if(b[11] != 0x00 || b[12] != 0x02 || !b[13])	// 512 bytes/sector
+		return 1;
+	fat_spc = b[13];
+	fat_lba = part + get16(&b[14]);
+	data_lba = fat_lba + b[16] * get32(&b[36]);
+	fat_root = get32(&b[44]);
+	return 0;
+}
+
+// Look up DRIVEx.DSK in the root directory
+void fat_open_drives(void) {
+	unsigned long cl = fat_root;
+	unsigned char s, e, d;
+	unsigned char *p;
+	struct cache *c;
+
+	while(cl >= 2 && cl < 0x0ffffff8UL) {
+		for(s = 0; s < fat_spc; s++) {
+			if(!(c = disk_cache(fat_cl_lba(cl) + s)))
+				return;
+			for(e = 0; e < 16; e++) {
+				p = &c->buf[e * 32];
+				if(p[0] == 0x00)				// End of directory
+					return;
+				if(p[0] == 0xe5 || (p[11] & 0x18))	// Deleted, volume, dir (and LFN)
+					continue;
+				if(!memcmp(p, "SNAPSHOTBIN", 11)) {
+					snap_file.start = snap_file.cl = fat_dir_cluster(p);
+					snap_file.cl_idx = 0;
+					snap_file.size = get32(&p[28]);
+					continue;
+				}
+				if(memcmp(p, "DRIVE", 5) || memcmp(&p[6], "  DSK", 5))
+					continue;
+				d = p[5] - 'A';
+				if(d >= DISK_DRIVES)
+					continue;
+				drive[d].start = drive[d].cl = fat_dir_cluster(p);
+				drive[d].cl_idx = 0;
+				drive[d].size = get32(&p[28]);
+			}
+		}
+		cl = fat_next(cl);
+	}
+}
+
+// SD block holding block blk of the drive's file, DISK_LBA_BAD when the
+// FAT can't be read or the chain ends first
+unsigned long drive_lba(struct drive *dp, unsigned long blk) {
+	unsigned long idx = blk / fat_spc;
+	unsigned long cl;
+
+	if(idx < dp->cl_idx) {				// Walk from the start again
+		dp->cl = dp->start;
+		dp->cl_idx = 0;
+	}
+	while(dp->cl_idx < idx) {
+		cl = fat_next(dp->cl);
+		if(cl < 2 || cl >= 0x0ffffff7UL)	// Read error, bad or end of chain
+			return DISK_LBA_BAD;
+		dp->cl = cl;
+		dp->cl_idx++;
+	}
+	return fat_cl_lba(dp->cl) + blk % fat_spc;
+}
+
+//CP/M disk controller
+//Z80 side: set drive, track and sector, then OUT a command to DISK_CMD.
+//Read moves the 128 byte sector into a buffer read through DISK_DATA,
+//write takes the 128 bytes written to DISK_DATA before the command.
+//Reading DISK_CMD returns the status of the last command, 0 = OK.
+#define DISK_SPT 26					// Sectors per track (8" IBM 3740)
+
+#define DISK_CMD_READ	0
+#define DISK_CMD_WRITE	1
+#define DISK_CMD_FLUSH	2			// Write back the cache
+
+unsigned char disk_drive, disk_sector, disk_status;
+unsigned int disk_track;
+unsigned char disk_buf[128];
+unsigned char disk_idx;
+
+unsigned char disk_cmd;
+
+unsigned char disk_exec(unsigned char cmd) {
+	struct drive *dp;
+	struct cache *c;
+	unsigned long off;
+
+	if(cmd == DISK_CMD_FLUSH)
+		return disk_flush();
+	if(disk_drive >= DISK_DRIVES || disk_sector >= DISK_SPT)
+		return 1;
+	dp = &drive[disk_drive];
+	off = ((unsigned long)disk_track * DISK_SPT + disk_sector) * 128;
+	if(!dp->start || off >= dp->size)
+		return 1;
+	if(!(c = disk_cache(drive_lba(dp, off >> 9))))
+		return 1;
+	if(cmd == DISK_CMD_READ) {
+		memcpy(disk_buf, &c->buf[off & 0x180], 128);
+	} else if(cmd == DISK_CMD_WRITE) {
+		memcpy(&c->buf[off & 0x180], disk_buf, 128);
+		c->dirty = 1;
+		disk_wb_req = 1;
+	} else
+		return 1;
+	return 0;
+}
+
+// SPI1 shares D0-D2 with the Z80, so the command runs off the bus
+unsigned char disk_run(unsigned char cmd) {
+	unsigned char st;
+
+	spi_bus_on();
+	st = disk_exec(cmd);
+	spi_bus_off();
+	return st;
+}
+
+void disk_job(void) {
+	z80_bus_acquire();
+	disk_status = disk_run(disk_cmd);
+	z80_bus_release();
+}
+
+// TASK_DISK, a block that fails stays dirty, the next DISK_CMD_FLUSH or
+// cache miss tries it again and reports the error to the Z80
+void disk_wb_task(void) {
+	unsigned char i;
+
+	for(i = 0; i < DISK_CACHE_BLOCKS && !cache[i].dirty; i++);
+	if(i == DISK_CACHE_BLOCKS)		// DISK_CMD_FLUSH got there first
+		return;
+	if(!z80_stop()) {
+		TASK_POST(TASK_DISK);
+		return;
+	}
+	bus_master();
+	disk_run(DISK_CMD_FLUSH);
+	z80_bus_release();
+}
+
+void disk_cmd_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	disk_idx = 0;
+	disk_cmd = data;
+	io_hold(disk_job);
+}
+
+unsigned char disk_cmd_rd(unsigned char port) {
+	(void)port;
+	return disk_status;
+}
+
+void disk_reg_wr(unsigned char port, unsigned char data) {
+	disk_idx = 0;
+	if(port == DISK_DRIVE)
+		disk_drive = data;
+	else if(port == DISK_TRACK)
+		disk_track = (disk_track & 0xff00) | data;
+	else if(port == DISK_TRACKH)
+		disk_track = (disk_track & 0x00ff) | ((unsigned int)data << 8);
+	else						// Out of range fails the next command
+		disk_sector = data < DISK_SPT ? data : DISK_SPT;
+}
+
+unsigned char disk_data_rd(unsigned char port) {
+	(void)port;
+	return disk_buf[disk_idx++ & 0x7f];
+}
+
+void disk_data_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	disk_buf[disk_idx++ & 0x7f] = data;
+}
+
+// Called at boot while the PIC still owns the bus
+void disk_init(void) {
+	unsigned char d;
+
+	if(sd_init()) {
+		printf("SD: no card\r\n");
+		return;
+	}
+	spi_bus_on();
+	if(fat_mount()) {
+		spi_bus_off();
+		printf("SD: no FAT32 volume\r\n");
+		return;
+	}
+	fat_open_drives();
+	spi_bus_off();
+	printf("SD:");
+	for(d = 0; d < DISK_DRIVES; d++)
+		if(drive[d].start)
+			printf(" %c:%luKB", 'A' + d, drive[d].size / 1024);
+	printf("\r\n");
+
+	io_register(DISK_DRIVE, NULL, disk_reg_wr);
+	io_register(DISK_TRACK, NULL, disk_reg_wr);
+	io_register(DISK_TRACKH, NULL, disk_reg_wr);
+	io_register(DISK_SECTOR, NULL, disk_reg_wr);
+	io_register_sync(DISK_CMD, disk_cmd_rd, disk_cmd_wr);
+	io_register(DISK_DATA, disk_data_rd, disk_data_wr);
+}
+#endif
+
+//Block transfer engine
+//Z80 side: set the RAM address, length and argument, then OUT a command
+//to BLK_CMD. The PIC takes the bus with /BUSREQ and moves the whole block
+//in one grant instead of one IN/OUT per byte.
+//  bit7 0: source -> RAM, 1: RAM -> destination
+//  bit1-0 device
+//    BLK_UART  UART3 RX buffer / TX buffer
+//    BLK_DISK  CP/M sector at DISK_DRIVE/TRACK/SECTOR, read or written
+//              in the same grant (up to 128 bytes)
+//    BLK_IMAGE flash image segment BLK_ARG (to RAM only, not LZ)
+//Reading BLK_CMD returns the status, 0 = OK, 1 also for a block past
+//0x7FFF (the PIC only drives A0-A14), nothing is moved then. The address
+//and length registers read back the next address and the bytes not moved.
+#define BLK_TOP			0x8000UL
+#define BLK_FROM_RAM	0x80
+#define BLK_UART		0
+#define BLK_DISK		1
+#define BLK_IMAGE		2
+
+union {
+	unsigned int w;
+	struct {
+		unsigned char l;
+		unsigned char h;
+	};
+} blk_addr, blk_len;
+unsigned char blk_arg, blk_cmd, blk_status;
+
+// Wait for UART3 RX, 1 when it stays silent
+unsigned char blk_uart_wait(void) {
+	unsigned long t;
+
+	for(t = 0; !RX_READY(); t++) {
+		if(t >= BLK_UART_TIMEOUT_MS * 100UL)
+			return 1;
+		__delay_us(10);
+	}
+	return 0;
+}
+
+unsigned char blk_exec(void) {
+	const struct image_seg *sp;
+	unsigned int n;
+
+	if((unsigned long)blk_addr.w + blk_len.w > BLK_TOP)
+		return 1;
+	switch(blk_cmd) {
+	case BLK_UART:
+		for(; blk_len.w; blk_len.w--, blk_addr.w++) {
+			if(blk_uart_wait())
+				return 1;
+			bus_write(blk_addr.w, uart_rx_get());
+		}
+		return 0;
+	case BLK_UART | BLK_FROM_RAM:
+		for(; blk_len.w; blk_len.w--, blk_addr.w++)
+			putch((char)bus_read(blk_addr.w));
+		return 0;
+#ifdef USE_SD
+	case BLK_DISK:
+		if(blk_len.w > 128 || disk_run(DISK_CMD_READ))
+			return 1;
+		bus_write_block(blk_addr.w, disk_buf, blk_len.w);
+		break;
+	case BLK_DISK | BLK_FROM_RAM:
+		if(blk_len.w > 128)
+			return 1;
+		bus_read_block(blk_addr.w, disk_buf, blk_len.w);
+		if(disk_run(DISK_CMD_WRITE))
+			return 1;
+		break;
+#endif
+	case BLK_IMAGE:
+		if(blk_arg >= image_seg_count || image_segs[blk_arg].lz)
+			return 1;
+		sp = &image_segs[blk_arg];
+		n = blk_len.w < sp->len ? blk_len.w : sp->len;
+		bus_write_block(blk_addr.w, sp->data, n);
+		blk_addr.w += n;
+		blk_len.w -= n;
+		return 0;
+	default:
+		return 1;
+	}
+	blk_addr.w += blk_len.w;
+	blk_len.w = 0;
+	return 0;
+}
+
+void blk_job(void) {
+	z80_bus_acquire();
+	blk_status = blk_exec();
+	INT_UPDATE_LOW();			// UART buffers moved
+	z80_bus_release();
+}
+
+unsigned char blk_reg_rd(unsigned char port) {
+	switch(port) {
+	case BLK_ADDRL: return blk_addr.l;
+	case BLK_ADDRH: return blk_addr.h;
+	case BLK_LENL: return blk_len.l;
+	case BLK_LENH: return blk_len.h;
+	case BLK_ARG: return blk_arg;
+	}
+	return blk_status;
+}
+
+void blk_reg_wr(unsigned char port, unsigned char data) {
+	switch(port) {
+	case BLK_ADDRL: blk_addr.l = data; break;
+	case BLK_ADDRH: blk_addr.h = data; break;
+	case BLK_LENL: blk_len.l = data; break;
+	case BLK_LENH: blk_len.h = data; break;
+	case BLK_ARG: blk_arg = data; break;
+	default:
+		blk_cmd = data;
+		io_hold(blk_job);
+	}
+}
+
+void blk_init(void) {
+	unsigned char p;
+
+	for(p = BLK_ADDRL; p < BLK_CMD; p++)
+		io_register(p, blk_reg_rd, blk_reg_wr);
+	io_register_sync(BLK_CMD, blk_reg_rd, blk_reg_wr);
+}
+
+//RAM blitter
+//Z80 side: set source, destination, length and fill value, then OUT an
+//operation to BLT_CMD. The PIC holds the Z80 with /BUSREQ and works on
+//the RAM as bus master, BLT_BUF bytes at a time through blt_buf, several
+//times faster than LDIR at 21 T states a byte.
+//  BLT_COPY  SRC to DST ascending, the same result as LDIR even when the
+//            blocks overlap (the LDIR fill idiom repeats the pattern)
+//  BLT_MOVE  SRC to DST keeping the source when they overlap (memmove)
+//  BLT_FILL  BLT_VAL to DST
+//  BLT_CMP   SRC against DST
+//Reading BLT_CMD returns the status: 0 OK, 1 bad command or a block past
+//0x7FFF (the PIC only drives A0-A14), 2 the compare found a difference.
+//The address registers then point at the first differing bytes and the
+//length is what is left from there, otherwise they hold the addresses
+//after the blocks and 0.
+#define BLT_TOP		0x8000UL
+#define BLT_BUF		128
+#define BLT_COPY	0
+#define BLT_MOVE	1
+#define BLT_FILL	2
+#define BLT_CMP		3
+
+unsigned char blt_buf[BLT_BUF], blt_buf2[BLT_BUF];
+union {
+	unsigned int w;
+	struct {
+		unsigned char l;
+		unsigned char h;
+	};
+} blt_src, blt_dst, blt_len;
+unsigned char blt_val, blt_cmd, blt_status;
+
+unsigned int blt_chunk(unsigned int len) {
+	return len < BLT_BUF ? len : BLT_BUF;
+}
+
+// The functions below need the PIC as bus master
+void blt_fill(unsigned int dst, unsigned int len, unsigned char v) {
+	bus_addr(dst);
+	BUS_DATA_DIR = 0x00;	// Set as output
+	BUS_DATA_OUT = v;
+	while(len--) {
+		BUS_WE = 0;		// /WE=0
+		NOP();			// Same width as bus_write_block
+		BUS_WE = 1;		// /WE=1
+		if(!++BUS_ADDR_OUT_L)	// Next page
+			bus_addr((ab.w & 0xff00) + 0x100);
+	}
+}
+
+// Ascending like LDIR. DST less than BLT_BUF above SRC inside the block
+// only ever repeats the first DST-SRC source bytes, so that is one read.
+void blt_copy(unsigned int src, unsigned int dst, unsigned int len) {
+	unsigned int d = dst - src, m, n;
+
+	if(dst > src && d < len && d < BLT_BUF) {
+		bus_read_block(src, blt_buf, d);
+		for(m = d; m + d <= BLT_BUF; m += d)
+			memcpy(blt_buf + m, blt_buf, d);
+		for(; len; dst += n, len -= n) {
+			n = len < m ? len : m;	// Whole periods, each chunk starts the pattern
+			bus_write_block(dst, blt_buf, n);
+		}
+		return;
+	}
+	for(; len; src += n, dst += n, len -= n) {
+		n = blt_chunk(len);		// Never more than the overlap, as LDIR reads
+		bus_read_block(src, blt_buf, n);
+		bus_write_block(dst, blt_buf, n);
+	}
+}
+
+// Overlapping blocks copy from the end when DST is above SRC
+void blt_move(unsigned int src, unsigned int dst, unsigned int len) {
+	unsigned int n;
+
+	if(dst <= src || dst - src >= len) {
+		blt_copy(src, dst, len);
+		return;
+	}
+	while(len) {
+		n = blt_chunk(len);
+		len -= n;
+		bus_read_block(src + len, blt_buf, n);
+		bus_write_block(dst + len, blt_buf, n);
+	}
+}
+
+// Offset of the first difference, len when the blocks match
+unsigned int blt_compare(unsigned int a, unsigned int b, unsigned int len) {
+	unsigned int k, n, i;
+
+	for(k = 0; k < len; k += n) {
+		n = blt_chunk(len - k);
+		bus_read_block(a + k, blt_buf, n);
+		bus_read_block(b + k, blt_buf2, n);
+		for(i = 0; i < n; i++)
+			if(blt_buf[i] != blt_buf2[i])
+				return k + i;
+	}
+	return len;
+}
+
+unsigned char blt_exec(void) {
+	unsigned int n = blt_len.w;
+
+	if((unsigned long)blt_dst.w + n > BLT_TOP
+		|| (blt_cmd != BLT_FILL && (unsigned long)blt_src.w + n > BLT_TOP))
+		return 1;
+	switch(blt_cmd) {
+	case BLT_COPY:
+		blt_copy(blt_src.w, blt_dst.w, n);
+		break;
+	case BLT_MOVE:
+		blt_move(blt_src.w, blt_dst.w, n);
+		break;
+	case BLT_FILL:
+		blt_fill(blt_dst.w, n, blt_val);
+		blt_dst.w += n;
+		blt_len.w = 0;
+		return 0;
+	case BLT_CMP:
+		n = blt_compare(blt_src.w, blt_dst.w, n);
+		break;
+	default:
+		return 1;
+	}
+	blt_src.w += n;
+	blt_dst.w += n;
+	blt_len.w -= n;
+	return blt_len.w ? 2 : 0;
+}
+
+void blt_job(void) {
+	z80_bus_acquire();
+	blt_status = blt_exec();
+	z80_bus_release();
+}
+
+unsigned char blt_reg_rd(unsigned char port) {
+	switch(port) {
+	case BLT_SRCL: return blt_src.l;
+	case BLT_SRCH: return blt_src.h;
+	case BLT_DSTL: return blt_dst.l;
+	case BLT_DSTH: return blt_dst.h;
+	case BLT_LENL: return blt_len.l;
+	case BLT_LENH: return blt_len.h;
+	case BLT_VAL: return blt_val;
+	}
+	return blt_status;
+}
+
+void blt_reg_wr(unsigned char port, unsigned char data) {
+	switch(port) {
+	case BLT_SRCL: blt_src.l = data; break;
+	case BLT_SRCH: blt_src.h = data; break;
+	case BLT_DSTL: blt_dst.l = data; break;
+	case BLT_DSTH: blt_dst.h = data; break;
+	case BLT_LENL: blt_len.l = data; break;
+	case BLT_LENH: blt_len.h = data; break;
+	case BLT_VAL: blt_val = data; break;
+	default:
+		blt_cmd = data;
+		io_hold(blt_job);
+	}
+}
+
+void blt_init(void) {
+	unsigned char p;
+
+	for(p = BLT_SRCL; p < BLT_CMD; p++)
+		io_register(p, blt_reg_rd, blt_reg_wr);
+	io_register_sync(BLT_CMD, blt_reg_rd, blt_reg_wr);
+}
+
+//Arithmetic coprocessor
+//Z80 side: write the operands to CP_DATA, OUT an operation to CP_CMD,
+//then read the status from CP_CMD and the results from CP_DATA. Writing
+//CP_CMD rewinds both CP_DATA pointers. The Z80 waits in the CP_CMD write
+//until the result is there.
+//  CP_MUL16U/S  A(16) * B(16), product(32) at 0-3
+//  CP_DIV16U/S  A(16) / B(16), quotient at 0-1, remainder at 4-5
+//  CP_MUL32U/S  A(32) * B(32), product(64) at 0-7
+//  CP_DIV32U/S  A(32) / B(32), quotient at 0-3, remainder at 4-7
+//Integers are little endian, A at operand bytes 0-3 and B at 4-7; signed
+//division truncates and the remainder takes the sign of A.
+//The CP_Fxxx operations take the BASIC ROM floating point accumulator:
+//FPREG, FPEXP, SGNRES (5 bytes) then BCDE as E, D, C, B, and return the
+//5 accumulator bytes. They give the same bits as the ROM routines, so the
+//patched BASIC (EMUBASIC-FP, tools/fppatch.asm) calls them from FPADD,
+//FPMULT, DVBCDE and SQR, and CP_MUL16U for its array index multiply.
+//  CP_FADD  FPREG + BCDE      CP_FSUB  BCDE - FPREG
+//  CP_FMUL  FPREG * BCDE      CP_FDIV  BCDE / FPREG
+//  CP_FSQR  SQR(FPREG), by LOG and EXP as the ROM does it
+//Status: 0 OK, 1 overflow, 2 division by zero, 3 SQR of a negative number,
+//0xff bad command.
+//tools/z80emu and tools/cptest build the lines from "Coprocessor math" to
+//"End of coprocessor math" out of this file, so they run this very code.
+//It takes fixed width types and no 64-bit arithmetic, so XC8 and the host
+//compute the same bits.
+
+//Coprocessor math
+#define CP_MUL16U	0x00
+#define CP_MUL16S	0x01
+#define CP_DIV16U	0x02
+#define CP_DIV16S	0x03
+#define CP_MUL32U	0x04
+#define CP_MUL32S	0x05
+#define CP_DIV32U	0x06
+#define CP_DIV32S	0x07
+#define CP_FADD		0x10
+#define CP_FSUB		0x11
+#define CP_FMUL		0x12
+#define CP_FDIV		0x13
+#define CP_FSQR		0x14
+#define CP_OV		1
+#define CP_DZ		2
+#define CP_FC		3
+#define CP_BAD		0xff
+
+//BASIC floating point, as in the ROM
+//A number is 4 bytes: mantissa LSB, NMSB, MSB with the sign in bit 7 in
+//place of the implied 1, then the exponent biased by 0x80, 0 for zero.
+//fp_reg and fp_sgn are the ROM's FPREG..FPEXP and SGNRES, a union fp
+//argument is its BCDE register set. Every step rounds and truncates where
+//the ROM does, so even the last bit comes out the same.
+union fp {
+	uint32_t l;
+	uint8_t b[4];
+};
+union fp fp_reg;
+uint8_t fp_sgn;
+uint8_t fp_err;
+
+#define FP_UNITY	0x81000000UL	// 1
+#define FP_HALF		0x80000000UL	// 0.5
+#define FP_MHALF	0x80800000UL	// -0.5
+#define FP_SQRHALF	0x803504f3UL	// SQR(0.5)
+#define FP_SQR2		0x813504f3UL	// SQR(2)
+#define FP_LN2		0x80317218UL	// LN(2)
+#define FP_RLN2		0x8138aa3bUL	// 1/LN(2)
+
+const uint32_t fp_logtab[] = {
+	0x801956aaUL, 0x807622f1UL, 0x8238aa45UL,
+};
+const uint32_t fp_exptab[] = {
+	0x74942e40UL, 0x772e4f70UL, 0x7a88026eUL, 0x7c2aa0e6UL,
+	0x7eaaaa50UL, 0x7f7fffffUL, 0x81800000UL, 0x81000000UL,
+};
+
+// SIGNS: implied ones back in, SGNRES from FPREG, BCDE sign relative to it
+uint8_t fp_signs(union fp *x) {
+	uint8_t a;
+
+	fp_sgn = ((fp_reg.b[2] >> 1 | 0x40) & 0x7f) | (fp_reg.b[2] & 0x80 ? 0 : 0x80);
+	fp_reg.b[2] |= 0x80;
+	a = (((x->b[2] >> 1 | 0x40) & 0x7f) | (x->b[2] & 0x80)) ^ fp_sgn;
+	x->b[2] |= 0x80;
+	return a;
+}
+
+// RONDUP: mantissa in the top 24 bits of m, rounded on bit 7
+void fp_round(uint32_t m) {
+	if(m & 0x80) {
+		m += 0x100;
+		if(!(m & 0xffffff00UL)) {	// Carried out of the mantissa
+			m = 0x80000000UL;
+			if(!++fp_reg.b[3]) {
+				fp_err = CP_OV;
+				return;
+			}
+		}
+	}
+	fp_reg.b[0] = (uint8_t)(m >> 8);
+	fp_reg.b[1] = (uint8_t)(m >> 16);
+	fp_reg.b[2] = (uint8_t)(m >> 24) ^ (fp_sgn & 0x80);
+}
+
+// BNORM: normalise m, adjust FPEXP and round
+void fp_norm(uint32_t m) {
+	uint8_t n = 0;
+
+	if(!m) {
+		fp_reg.b[3] = 0;
+		return;
+	}
+	while(!(m & 0xff000000UL)) {
+		m <<= 8;
+		n += 8;
+	}
+	while(!(m & 0x80000000UL)) {
+		m <<= 1;
+		n++;
+	}
+	if(n) {
+		if(fp_reg.b[3] <= n) {		// Underflow is zero
+			fp_reg.b[3] = 0;
+			return;
+		}
+		fp_reg.b[3] -= n;
+	}
+	fp_round(m);
+}
+
+// FPADD: FPREG = FPREG + BCDE
+void fp_add(union fp x) {
+	uint32_t m, r;
+	uint8_t d;
+
+	if(!x.b[3])
+		return;
+	if(!fp_reg.b[3]) {
+		fp_reg.l = x.l;
+		return;
+	}
+	if(fp_reg.b[3] < x.b[3]) {		// Larger one in FPREG
+		r = fp_reg.l;
+		fp_reg.l = x.l;
+		x.l = r;
+	}
+	d = fp_reg.b[3] - x.b[3];
+	if(d > 24)
+		return;
+	m = fp_signs(&x) & 0x80 ? 1 : 0;	// Same signs
+	r = fp_reg.l << 8;
+	x.l <<= 8;
+	x.l >>= d;
+	if(!m) {
+		m = r - x.l;
+		if(r < x.l) {				// Sign changes
+			fp_sgn = ~fp_sgn;
+			m = -m;
+		}
+		fp_norm(m);
+		return;
+	}
+	m = r + x.l;
+	if(m < r) {					// Carry, one more bit
+		if(!++fp_reg.b[3]) {
+			fp_err = CP_OV;
+			return;
+		}
+		m = m >> 1 | 0x80000000UL;
+	}
+	fp_round(m);
+}
+
+// ADDEXP: exponent of a product (l 0) or quotient (l 0xff), then SIGNS.
+// Returns 1 when the result is already settled.
+uint8_t fp_addexp(union fp *x, uint8_t l) {
+	uint16_t s;
+	uint8_t e;
+
+	if(!x->b[3]) {
+		fp_reg.b[3] = 0;
+		return 1;
+	}
+	s = (uint16_t)(uint8_t)(fp_reg.b[3] ^ l) + x->b[3];
+	e = (uint8_t)s;
+	if((s >> 8) == (e >> 7)) {		// Out of range
+		if(e & 0x80)
+			fp_err = CP_OV;
+		else
+			fp_reg.b[3] = 0;
+		return 1;
+	}
+	fp_reg.b[3] = e += 0x80;
+	if(!e)
+		return 1;
+	fp_sgn = fp_signs(x);
+	return 0;
+}
+
+// FPMULT: FPREG = FPREG * BCDE. The ROM shifts and adds 24 times dropping
+// a bit each time, which comes to the top 32 bits of the 48-bit product.
+void fp_mul(union fp x) {
+	uint32_t r, p;
+
+	if(!fp_reg.b[3] || fp_addexp(&x, 0))
+		return;
+	r = fp_reg.l & 0xffffffUL;
+	p = (r * x.b[0] >> 8) + r * x.b[1];
+	p = (p >> 8) + r * x.b[2];
+	fp_norm(p);
+}
+
+// DVBCDE: FPREG = BCDE / FPREG, restoring division one bit at a time
+void fp_div(union fp x) {
+	uint32_t d, r, q;
+	uint8_t b;
+
+	if(!fp_reg.b[3]) {
+		fp_err = CP_DZ;
+		return;
+	}
+	if(fp_addexp(&x, 0xff))
+		return;
+	fp_reg.b[3] += 2;
+	d = fp_reg.l & 0xffffffUL;
+	r = x.l & 0xffffffUL;
+	q = 0;
+	for(;;) {
+		b = r >= d;
+		if(b)
+			r -= d;
+		if(q & 0x800000UL)
+			break;
+		q = q << 1 | b;
+		r <<= 1;
+		if(!q && !--fp_reg.b[3]) {
+			fp_err = CP_OV;
+			return;
+		}
+	}
+	fp_round(q << 8 | (b ? 0x80 : 0));
+}
+
+// INT: FPREG = INT(FPREG), returns the low byte of the integer
+uint8_t fp_int(void) {
+	union fp x;
+	uint32_t m;
+	uint8_t n, a;
+
+	if(fp_reg.b[3] >= 0x98)
+		return fp_reg.b[0];
+	m = 0;
+	n = 0;
+	if(fp_reg.b[3]) {
+		x.l = fp_reg.l;
+		n = fp_reg.b[2] & 0x80;
+		fp_signs(&x);
+		m = x.l << 8;
+		if(n)
+			m -= 0x100;				// Towards minus infinity
+		a = 0x98 - fp_reg.b[3];
+		m = a < 32 ? m >> a : 0;
+		if(n)
+			m += 0x100;
+		m &= 0xffffff00UL;
+		if(n) {
+			fp_sgn = ~fp_sgn;
+			m = -m;
+		}
+	}
+	fp_reg.b[3] = 0x98;
+	a = (uint8_t)(m >> 8);
+	if(m & 0x80000000UL) {
+		fp_sgn = ~fp_sgn;
+		m = -m;
+	}
+	fp_norm(m);
+	return a;
+}
+
+// FLGREL: FPREG = signed a
+void fp_flgrel(uint8_t a) {
+	uint32_t m = (uint32_t)a << 24;
+
+	fp_reg.b[3] = 0x88;
+	fp_sgn = 0x80;
+	if(a & 0x80) {
+		fp_sgn = 0x7f;
+		m = -m;
+	}
+	fp_norm(m);
+}
+
+// SMSER1: polynomial in FPREG, n coefficients highest power first
+void fp_series(const uint32_t *c, uint8_t n) {
+	union fp x, y;
+
+	x.l = fp_reg.l;
+	fp_reg.l = *c++;
+	while(--n) {
+		fp_mul(x);
+		if(fp_err)
+			return;
+		y.l = *c++;
+		fp_add(y);
+		if(fp_err)
+			return;
+	}
+}
+
+// Shorthand for a constant operand
+void fp_addk(uint32_t k) {
+	union fp x;
+
+	x.l = k;
+	fp_add(x);
+}
+
+void fp_mulk(uint32_t k) {
+	union fp x;
+
+	x.l = k;
+	fp_mul(x);
+}
+
+// LOG of FPREG > 0
+void fp_log(void) {
+	union fp x;
+	uint8_t s;
+
+	s = fp_reg.b[3] - 0x80;			// Scale
+	fp_reg.b[3] = 0x80;
+	fp_addk(FP_SQRHALF);
+	x.l = FP_SQR2;
+	fp_div(x);
+	fp_reg.b[2] ^= 0x80;			// 1 - FPREG
+	fp_addk(FP_UNITY);
+	if(fp_err)
+		return;
+	x.l = fp_reg.l;					// SUMSER: x * P(x * x)
+	fp_mul(x);
+	fp_series(fp_logtab, sizeof(fp_logtab) / sizeof(fp_logtab[0]));
+	if(fp_err)
+		return;
+	fp_mul(x);
+	fp_addk(FP_MHALF);
+	if(fp_err)
+		return;
+	x.l = fp_reg.l;					// Plus the scale
+	fp_flgrel(s);
+	fp_add(x);
+	if(fp_err)
+		return;
+	fp_mulk(FP_LN2);
+}
+
+// EXP of FPREG
+void fp_exp(void) {
+	union fp x;
+	uint8_t a;
+
+	x.l = fp_reg.l;
+	fp_mulk(FP_RLN2);
+	if(fp_err)
+		return;
+	if(fp_reg.b[3] < 0x88) {
+		a = fp_int() + 0x80;
+		if(a < 0xfe)
+			goto reduce;
+	}
+	if(fp_reg.b[2] & 0x80)			// Far below 1 is zero
+		fp_reg.b[3] = 0;
+	else
+		fp_err = CP_OV;
+	return;
+reduce:
+	fp_addk(FP_UNITY);
+	fp_mulk(FP_LN2);
+	if(fp_err)
+		return;
+	fp_reg.b[2] ^= 0x80;			// FPREG - x
+	fp_add(x);
+	fp_reg.b[2] ^= 0x80;
+	if(fp_err)
+		return;
+	fp_series(fp_exptab, sizeof(fp_exptab) / sizeof(fp_exptab[0]));
+	if(fp_err)
+		return;
+	fp_mulk((uint32_t)(a + 2) << 24);
+}
+
+// SQR of FPREG > 0 the way POWER does it, EXP(LOG(x) * 0.5)
+void fp_sqr(void) {
+	fp_log();
+	if(fp_err)
+		return;
+	fp_mulk(FP_HALF);
+	if(fp_err)
+		return;
+	fp_exp();
+}
+
+// Operand / result bytes, little endian
+uint32_t cp_get(const uint8_t *p) {
+	return p[0] | (uint16_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+void cp_put(uint8_t *p, uint32_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+// 32 x 32 bits to 64 from 16-bit halves, high half at 4-7
+void cp_mul32(uint8_t *res, uint32_t a, uint32_t b, uint8_t s) {
+	uint32_t p0, p1, p2, t;
+
+	p0 = (a & 0xffff) * (b & 0xffff);
+	p1 = (a & 0xffff) * (b >> 16);
+	p2 = (a >> 16) * (b & 0xffff);
+	t = (p0 >> 16) + (p1 & 0xffff) + (p2 & 0xffff);
+	cp_put(res, (p0 & 0xffff) | t << 16);
+	t = (a >> 16) * (b >> 16) + (p1 >> 16) + (p2 >> 16) + (t >> 16);
+	if(s) {						// Signed: take the other operand off
+		if(a & 0x80000000UL)
+			t -= b;
+		if(b & 0x80000000UL)
+			t -= a;
+	}
+	cp_put(res + 4, t);
+}
+
+// Signed division of magnitudes, quotient and remainder to 0 and 4
+uint8_t cp_div32(uint8_t *res, uint32_t a, uint32_t b, uint32_t top) {
+	uint32_t q, r;
+	uint8_t na, nb;
+
+	if(!b)
+		return CP_DZ;
+	na = top && (a & top);
+	nb = top && (b & top);
+	if(na)
+		a = -a;
+	if(nb)
+		b = -b;
+	if(top) {						// Back to the operand width
+		a &= top | (top - 1);
+		b &= top | (top - 1);
+	}
+	q = a / b;
+	r = a % b;
+	cp_put(res, na != nb ? -q : q);
+	cp_put(res + 4, na ? -r : r);
+	return top && q == top && na == nb ? CP_OV : 0;	// MIN / -1
+}
+
+// Run cmd on the 9 operand bytes op, 8 result bytes to res
+uint8_t cp_exec(uint8_t cmd, const uint8_t *op, uint8_t *res) {
+	union fp x;
+	uint32_t a, b;
+
+	memset(res, 0, 8);
+	a = cp_get(op);
+	b = cp_get(op + 4);
+	switch(cmd) {
+	case CP_MUL16U:
+		cp_put(res, (a & 0xffff) * (b & 0xffff));
+		return 0;
+	case CP_MUL16S:
+		cp_put(res, (uint32_t)((int32_t)(int16_t)a * (int16_t)b));
+		return 0;
+	case CP_DIV16U:
+		return cp_div32(res, a & 0xffff, b & 0xffff, 0);
+	case CP_DIV16S:
+		return cp_div32(res, a & 0xffff, b & 0xffff, 0x8000);
+	case CP_MUL32U:
+	case CP_MUL32S:
+		cp_mul32(res, a, b, cmd & 1);
+		return 0;
+	case CP_DIV32U:
+		return cp_div32(res, a, b, 0);
+	case CP_DIV32S:
+		return cp_div32(res, a, b, 0x80000000UL);
+	}
+	if(cmd < CP_FADD || cmd > CP_FSQR)
+		return CP_BAD;
+	memcpy(fp_reg.b, op, 4);
+	fp_sgn = op[4];
+	x.b[0] = op[5];
+	x.b[1] = op[6];
+	x.b[2] = op[7];
+	x.b[3] = op[8];
+	fp_err = 0;
+	switch(cmd) {
+	case CP_FADD:
+		fp_add(x);
+		break;
+	case CP_FSUB:
+		fp_reg.b[2] ^= 0x80;
+		fp_add(x);
+		break;
+	case CP_FMUL:
+		fp_mul(x);
+		break;
+	case CP_FDIV:
+		fp_div(x);
+		break;
+	default:
+		if(!fp_reg.b[3])
+			fp_reg.l = 0;			// POWER with a zero base
+		else if(fp_reg.b[2] & 0x80)
+			fp_err = CP_FC;			// LOG of a negative number
+		else
+			fp_sqr();
+	}
+	memcpy(res, fp_reg.b, 4);
+	res[4] = fp_sgn;
+	return fp_err;
+}
+//End of coprocessor math
+
+unsigned char cp_op[9], cp_res[8];
+unsigned char cp_wi, cp_ri, cp_cmd, cp_status;
+
+// The Z80 waits in the CP_CMD write, no bus needed
+void cp_job(void) {
+	cp_status = cp_exec(cp_cmd, cp_op, cp_res);
+	BUS_WAIT_RELEASE();
+}
+
+unsigned char cp_reg_rd(unsigned char port) {
+	if(port == CP_DATA)
+		return cp_res[cp_ri++ & 7];
+	return cp_status;
+}
+
+void cp_reg_wr(unsigned char port, unsigned char data) {
+	if(port == CP_DATA) {
+		if(cp_wi < sizeof(cp_op))
+			cp_op[cp_wi++] = data;
+		return;
+	}
+	cp_cmd = data;
+	cp_wi = 0;
+	cp_ri = 0;
+	io_hold(cp_job);
+}
+
+void cp_init(void) {
+	io_register(CP_DATA, cp_reg_rd, cp_reg_wr);
+	io_register_sync(CP_CMD, cp_reg_rd, cp_reg_wr);
+}
+
+//RAM snapshot (hibernate)
+//The Z80 saves its own state: it pushes its registers and a resume
+//address, reports SP at SNAP_SPL/H and writes a command to SNAP_CMD.
+//The PIC holds it with /BUSREQ and writes the RAM image to SNAPSHOT.BIN
+//on the SD card or streams it to the UART. Resuming puts a stub just
+//below the saved SP (LD SP, then RET to the resume address) and a JP to
+//it at 0x0000; the stub puts back the three bytes it covered first.
+//A15 is not wired to the PIC, so the image is 0x0000-0x7FFF. A save
+//with SP at 0x8000 or above (or too low for the stub) is refused with
+//status 1: the program's stack, and so likely its data, is in RAM the
+//image leaves out.
+//SNAPSHOT.BIN resumes once: snap_boot invalidates it after the restore.
+//Image: 16 byte header, then the RAM at the offset in the header
+//(16 in a stream, 512 in SNAPSHOT.BIN). tools/snapconv converts it.
+#define SNAP_LEN		0x8000	// RAM the PIC can reach
+#define SNAP_HDR		16
+#define SNAP_STUB		19		// Resume stub length
+#define SNAP_CMD_SD		1		// Save to SNAPSHOT.BIN
+#define SNAP_CMD_UART	2		// Stream to the UART
+#define SNAP_CMD_CLEAR	3		// Invalidate SNAPSHOT.BIN
+
+const char snap_magic[8] = "Z80SNAP";
+unsigned int snap_sp;
+unsigned char snap_cmd, snap_status;
+unsigned char snap_ram_bad;		// RAM holds a restore that failed half way
+
+void snap_header(unsigned char *h, unsigned int sp, unsigned int crc, unsigned int off) {
+	memset(h, 0, SNAP_HDR);
+	memcpy(h, snap_magic, 8);
+	h[8] = sp & 0xff;
+	h[9] = sp >> 8;
+	h[10] = SNAP_LEN & 0xff;
+	h[11] = SNAP_LEN >> 8;
+	h[12] = crc & 0xff;
+	h[13] = crc >> 8;
+	h[14] = off & 0xff;
+	h[15] = off >> 8;
+}
+
+// SP of a usable header, 0 if not
+unsigned int snap_header_sp(const unsigned char *h, unsigned int off) {
+	unsigned int sp = h[8] | ((unsigned int)h[9] << 8);
+
+	if(memcmp(h, snap_magic, 8) || h[10] != (SNAP_LEN & 0xff) || h[11] != SNAP_LEN >> 8
+		|| (h[14] | ((unsigned int)h[15] << 8)) != off)
+		return 0;
+	if(sp < SNAP_STUB + 3 || sp > SNAP_LEN - 2)	// Room for the stub and RET
+		return 0;
+	return sp;
+}
+
+// Resume stub below sp and JP to it at 0x0000 (PIC owns the bus)
+void snap_stub(unsigned int sp) {
+	unsigned char code[SNAP_STUB], i, *p = code;
+	unsigned int at = sp - SNAP_STUB;
+
+	for(i = 0; i < 3; i++) {
+		*p++ = 0x3e;			// LD A,n
+		*p++ = bus_read(i);
+		*p++ = 0x32;			// LD (nn),A
+		*p++ = i;
+		*p++ = 0x00;
+	}
+	*p++ = 0x31;				// LD SP,nn
+	*p++ = sp & 0xff;
+	*p++ = sp >> 8;
+	*p = 0xc9;					// RET to the resume address
+	bus_write_block(at, code, SNAP_STUB);
+	bus_write(0x0000, 0xc3);	// JP stub
+	bus_write(0x0001, at & 0xff);
+	bus_write(0x0002, at >> 8);
+}
+
+// Stream header and RAM to the UART
+void snap_save_uart(unsigned int sp) {
+	unsigned char h[SNAP_HDR], i;
+	unsigned int a, crc = 0;
+
+	for(a = 0; a < SNAP_LEN; a++)
+		crc = crc16(crc, bus_read(a));
+	snap_header(h, sp, crc, SNAP_HDR);
+	for(i = 0; i < SNAP_HDR; i++)
+		putch((char)h[i]);
+	for(a = 0; a < SNAP_LEN; a++)
+		putch((char)bus_read(a));
+}
+
+// Receive a stream into RAM (PIC owns the bus), SP or 0 on error
+unsigned int snap_load_uart(void) {
+	unsigned char h[SNAP_HDR], i, c;
+	unsigned int a, sp, crc = 0;
+
+	for(i = 0; i < SNAP_HDR; i++)
+		h[i] = (unsigned char)getch();
+	if(!(sp = snap_header_sp(h, SNAP_HDR)))
+		return 0;
+	snap_ram_bad = 1;
+	for(a = 0; a < SNAP_LEN; a++) {
+		c = (unsigned char)getch();
+		bus_write(a, c);
+		crc = crc16(crc, c);
+	}
+	if(crc != (h[12] | ((unsigned int)h[13] << 8)))
+		return 0;
+	snap_ram_bad = 0;
+	snap_stub(sp);
+	return sp;
+}
+
+#ifdef USE_SD
+// Header block through the cache, NULL on error
+struct cache *snap_sd_header(void) {
+	struct cache *c;
+
+	if(!snap_file.start || snap_file.size < 512 + SNAP_LEN)
+		return NULL;
+	spi_bus_on();
+	c = disk_cache(drive_lba(&snap_file, 0));
+	spi_bus_off();
+	return c;
+}
+
+unsigned char snap_save_sd(unsigned int sp) {
+	struct cache *c;
+	unsigned int a, i, crc = 0;
+	unsigned char n, r;
+
+	if(!snap_sd_header())
+		return 1;
+	for(a = 0, n = 1; a < SNAP_LEN; a += 512, n++) {
+		spi_bus_on();
+		c = cache_get(drive_lba(&snap_file, n), 0);	// Overwritten, no read
+		spi_bus_off();
+		if(!c)
+			return 1;
+		bus_read_block(a, c->buf, 512);
+		c->dirty = 1;
+		for(i = 0; i < 512; i++)
+			crc = crc16(crc, c->buf[i]);
+	}
+	spi_bus_on();
+	r = disk_flush();				// RAM first, the header makes it valid
+	if(!r && (c = disk_cache(drive_lba(&snap_file, 0)))) {
+		memset(c->buf, 0, 512);
+		snap_header(c->buf, sp, crc, 512);
+		c->dirty = 1;
+		r = disk_flush();
+	} else
+		r = 1;
+	spi_bus_off();
+	return r;
+}
+
+unsigned char snap_clear_sd(void) {
+	struct cache *c;
+	unsigned char r;
+
+	if(!(c = snap_sd_header()))
+		return 1;
+	memset(c->buf, 0, SNAP_HDR);
+	c->dirty = 1;
+	spi_bus_on();
+	r = disk_flush();
+	spi_bus_off();
+	return r;
+}
+
+// Resume from SNAPSHOT.BIN if it holds a valid image, 1 when done.
+// Called before the Z80 starts, with the Z80 in reset and /BUSREQ low.
+// A read error half way leaves the Z80 in reset for the PIC console.
+unsigned char snap_boot(void) {
+	struct cache *c;
+	unsigned int a, i, sp, crc = 0;
+	unsigned char n;
+
+	if(!(c = snap_sd_header()) || !(sp = snap_header_sp(c->buf, 512)))
+		return 0;
+	a = c->buf[12] | ((unsigned int)c->buf[13] << 8);
+	spi_bus_on();
+	for(n = 1; n <= SNAP_LEN / 512; n++) {		// Check before touching RAM
+		if(!(c = disk_cache(drive_lba(&snap_file, n)))) {
+			spi_bus_off();
+			return 0;
+		}
+		for(i = 0; i < 512; i++)
+			crc = crc16(crc, c->buf[i]);
+	}
+	spi_bus_off();
+	if(crc != a) {
+		printf("Snapshot CRC NG\r\n");
+		return 0;
+	}
+	bus_master();
+	for(a = 0, n = 1; a < SNAP_LEN; a += 512, n++) {
+		spi_bus_on();
+		c = disk_cache(drive_lba(&snap_file, n));
+		spi_bus_off();
+		if(!c) {
+			bus_slave();
+			snap_ram_bad = 1;
+			console_req = 1;
+			printf("Snapshot read NG, Z80 held in reset\r\n");
+			return 0;
+		}
+		bus_write_block(a, c->buf, 512);
+	}
+	snap_stub(sp);
+	z80_bus_release();
+	printf("Resume 32KB from SNAPSHOT.BIN SP=%04X\r\n", sp);
+	if(snap_clear_sd())			// One resume per save
+		printf("SNAPSHOT.BIN not cleared, it resumes again at the next boot\r\n");
+	return 1;
+}
+#endif
+
+void snap_job(void) {
+	z80_bus_acquire();
+	switch(snap_cmd) {
+#ifdef USE_SD
+	case SNAP_CMD_SD:
+		snap_status = snap_save_sd(snap_sp);
+		break;
+	case SNAP_CMD_CLEAR:
+		snap_status = snap_clear_sd();
+		break;
+#endif
+	case SNAP_CMD_UART:
+		snap_save_uart(snap_sp);
+		snap_status = 0;
+		break;
+	default:
+		snap_status = 1;
+	}
+	z80_bus_release();
+}
+
+unsigned char snap_reg_rd(unsigned char port) {
+	(void)port;
+	return snap_status;
+}
+
+void snap_reg_wr(unsigned char port, unsigned char data) {
+	if(port == SNAP_SPL)
+		snap_sp = (snap_sp & 0xff00) | data;
+	else if(port == SNAP_SPH)
+		snap_sp = (snap_sp & 0x00ff) | ((unsigned int)data << 8);
+	else if(data != SNAP_CMD_CLEAR && (snap_sp < SNAP_STUB + 3 || snap_sp > SNAP_LEN - 2))
+		snap_status = 1;				// Stack in the upper 32KB, or no room for the stub
+	else {
+		snap_cmd = data;
+		io_hold(snap_job);
+	}
+}
+
+void snap_init(void) {
+	io_register(SNAP_SPL, NULL, snap_reg_wr);
+	io_register(SNAP_SPH, NULL, snap_reg_wr);
+	io_register_sync(SNAP_CMD, snap_reg_rd, snap_reg_wr);
+}
+
+//ROM upload timer
+//TMR0 16-bit, Fosc/4 1:64 = 4us per count
+#define UPLOAD_TIMER_US 4
+
+unsigned int upload_timer(void) {
+	unsigned char l = TMR0L;		// Latches TMR0H
+	return ((unsigned int)TMR0H << 8) | l;
+}
+
+//Expand an LZ stream (see tools/lz.h) into Z80 RAM
+//Match bytes are read back from the RAM already written, so no buffer
+//is needed on the PIC side. Returns the number of bytes written.
+unsigned int upload_lz(const unsigned char *src, unsigned int addr) {
+	unsigned int start = addr, dist;
+	unsigned char t, n;
+
+	while(1) {
+		t = *src++;
+		if(t < 0x80) {			// Literal run
+			n = t + 1;
+			do {
+				bus_write(addr++, *src++);
+			} while(--n);
+			continue;
+		}
+		dist = src[0] | ((unsigned int)src[1] << 8);
+		src += 2;
+		if(dist == 0)			// End of stream
+			break;
+		n = (t & 0x7f) + 4;		// Match
+		do {
+			bus_write(addr, bus_read(addr - dist));
+			addr++;
+		} while(--n);
+	}
+	return addr - start;
+}
+
+#ifndef ROM_UPLOAD_DMA
+// Upload by CPU, one byte at a time
+void upload_pio(const unsigned char *src, unsigned int addr, unsigned int len) {
+	BUS_DATA_DIR = 0x00;	// Set as output
+	while(len--) {
+		ab.w = addr++;
+		BUS_ADDR_OUT_H = ab.h;
+		BUS_ADDR_OUT_A14 = (ab.h >> 6) & 1;
+		BUS_ADDR_OUT_L = ab.l;
+		BUS_WE = 0;		// /WE=0
+		BUS_DATA_OUT = *src++;
+		BUS_WE = 1;		// /WE=1
+	}
+}
+#else
+//Upload by DMA
+//On every TMR2 period DMA1 moves the next image byte to D7-D0 (LATC) and
+//DMA2 the matching A7-A0 value (LATB) from ramp[]. CCP1 PWM on the same
+//timer drives /WE high for the first 8Tcy and low for the last 4Tcy, so
+//the SRAM latches the byte on the rising edge just before the next DMA
+//transfer moves the bus. The CPU only steps A15-A8 once per 256 bytes.
+#define DMA_TRIG_TMR2	0x1b	// DMAnSIRQ source: TMR2
+#ifndef DMA_ADDR
+#define DMA_ADDR(p)		((unsigned long)(p))	// DMAnSSA/DMAnDSA value of a pointer
+#endif
+#define PPS_CCP1		0x15	// RxyPPS: CCP1
+#define UPLOAD_PR		11		// TMR2 period 12Tcy (750ns) per byte
+#define UPLOAD_WE		32		// CCP1 duty: /WE high 32Tosc (8Tcy)
+
+const unsigned char ramp[256] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f,
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f,
+	0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+	0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x7f,
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+	0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf,
+	0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xbb, 0xbc, 0xbd, 0xbe, 0xbf,
+	0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf,
+	0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xdb, 0xdc, 0xdd, 0xde, 0xdf,
+	0xe0, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xeb, 0xec, 0xed, 0xee, 0xef,
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+void upload_dma_init(void) {
+	// Bus arbitration: DMA1, DMA2 over the CPU
+	DMA1PR = 0;
+	DMA2PR = 1;
+	MAINPR = 2;
+	ISRPR = 3;
+	PRLOCK = 0x55;
+	PRLOCK = 0xAA;
+	PRLOCKbits.PRLOCKED = 1;
+
+	// TMR2: byte clock
+	T2CLKCON = 0x01;	// Fosc/4
+	T2HLT = 0x00;		// Free running
+	T2PR = UPLOAD_PR;
+	T2CON = 0x00;		// 1:1, stopped
+
+	// CCP1 PWM: /WE
+	CCPTMRS0bits.C1TSEL = 1;	// TMR2
+	CCPR1 = UPLOAD_WE;
+	CCP1CON = 0x8c;		// PWM mode, right aligned
+
+	// DMA1: image -> LATC
+	DMASELECT = 0;
+	DMAnCON1 = 0x0b;	// Dest fixed, source flash increment, stop at end
+	DMAnDSA = DMA_ADDR(&LATC);
+	DMAnDSZ = 1;
+	DMAnSIRQ = DMA_TRIG_TMR2;
+
+	// DMA2: ramp[] -> LATB
+	DMASELECT = 1;
+	DMAnCON1 = 0x0b;	// Dest fixed, source flash increment, stop at end
+	DMAnDSA = DMA_ADDR(&LATB);
+	DMAnDSZ = 1;
+	DMAnSIRQ = DMA_TRIG_TMR2;
+}
+
+void upload_dma(const unsigned char *src, unsigned int addr, unsigned int len) {
+	unsigned int n;
+
+	BUS_DATA_DIR = 0x00;	// Set as output
+	RA2PPS = PPS_CCP1;		// CCP1 -> RA2 -> /WE
+	while(len) {
+		ab.w = addr;
+		n = 0x100 - ab.l;	// Up to the page end
+		if(n > len)
+			n = len;
+		BUS_ADDR_OUT_H = ab.h;
+		BUS_ADDR_OUT_A14 = (ab.h >> 6) & 1;
+		BUS_ADDR_OUT_L = ab.l;	// First /WE pulse rewrites byte 0
+		BUS_DATA_OUT = *src;
+
+		DMASELECT = 0;
+		DMAnSSA = DMA_ADDR(src);
+		DMAnSSZ = n;
+		DMAnCON0 = 0xc0;	// Enable, start on trigger
+		DMASELECT = 1;
+		DMAnSSA = DMA_ADDR(&ramp[ab.l]);
+		DMAnSSZ = n;
+		DMAnCON0 = 0xc0;	// Enable, start on trigger
+
+		DMA1SCNTIF = 0;
+		TMR2 = 0;
+		T2CONbits.ON = 1;
+		while(!DMA1SCNTIF);	// Last byte on the bus
+		TMR2IF = 0;
+		while(!TMR2IF);		// Its /WE pulse is over
+		T2CONbits.ON = 0;	// Stops with /WE high
+
+		DMASELECT = 0;
+		DMAnCON0 = 0x00;
+		DMASELECT = 1;
+		DMAnCON0 = 0x00;
+
+		src += n;
+		addr += n;
+		len -= n;
+	}
+	RA2PPS = 0x00;			// LATA2 -> RA2
+}
+#endif
+
+#ifdef RAM_TEST
+//Z80 RAM test at boot
+//March C- over the RAM the PIC can address. A15 is not wired to the PIC,
+//so that is 0x0000-0x7FFF. RAM_TEST_FAST uses the 0x00/0xff data
+//background only, otherwise 0x55/0xaa and 0x0f/0xf0 follow to catch
+//coupling between bits of a byte.
+#define RAM_TEST_PAGES	0x80	// 0x0000-0x7FFF
+#define MARCH_R			0x01	// Read and check
+#define MARCH_W			0x02	// Write
+#define MARCH_DOWN		0x04	// Descending addresses
+
+unsigned int ram_fail;			// Failing address
+unsigned char ram_fail_data;	// Data read there
+
+// One March element, 1 on a mismatch
+unsigned char ram_march(unsigned char op, unsigned char r, unsigned char w) {
+	unsigned char i, h, l, start, step, d;
+
+	start = op & MARCH_DOWN ? 0xff : 0x00;
+	step = op & MARCH_DOWN ? 0xff : 0x01;
+	for(i = 0; i < RAM_TEST_PAGES; i++) {
+		h = op & MARCH_DOWN ? RAM_TEST_PAGES - 1 - i : i;
+		bus_addr((unsigned int)h << 8);
+		l = start;
+		do {
+			BUS_ADDR_OUT_L = l;
+			if(op & MARCH_R) {
+				BUS_DATA_DIR = 0xff;	// Set as input
+				BUS_OE = 0;		// /OE=0
+				NOP();			// SRAM access time
+				NOP();
+				d = BUS_DATA_IN;
+				BUS_OE = 1;		// /OE=1
+				if(d != r) {
+					ram_fail = ((unsigned int)h << 8) | l;
+					ram_fail_data = d;
+					return 1;
+				}
+			}
+			if(op & MARCH_W) {
+				BUS_DATA_DIR = 0x00;	// Set as output
+				BUS_WE = 0;		// /WE=0
+				BUS_DATA_OUT = w;
+				BUS_WE = 1;		// /WE=1
+			}
+			l += step;
+		} while(l != start);
+	}
+	return 0;
+}
+
+// March C-: up(w0) up(r0,w1) up(r1,w0) down(r0,w1) down(r1,w0) down(r0)
+const unsigned char march_c[6] = {
+	MARCH_W, MARCH_R | MARCH_W, MARCH_R | MARCH_W,
+	MARCH_DOWN | MARCH_R | MARCH_W, MARCH_DOWN | MARCH_R | MARCH_W, MARCH_DOWN | MARCH_R
+};
+#ifdef RAM_TEST_FAST
+const unsigned char march_bg[] = { 0x00 };
+#else
+const unsigned char march_bg[] = { 0x00, 0x55, 0x0f };
+#endif
+
+// Called while the PIC owns the bus, before upload. Halts on a failure.
+void ram_test(void) {
+	static unsigned char buf[128];
+	unsigned long us = 0;
+	unsigned int t, i;
+	unsigned char b, e, w;
+
+	for(b = 0; b < sizeof(march_bg); b++) {
+		for(e = 0; e < sizeof(march_c); e++) {
+			w = march_bg[b] ^ (e & 1 ? 0xff : 0x00);	// Written, ~w is read
+			t = upload_timer();
+			if(ram_march(march_c[e], (unsigned char)~w, w)) {
+				printf("RAM NG %04X read %02X expect %02X\r\n",
+					ram_fail, ram_fail_data, (unsigned char)~w);
+				while(1);
+			}
+			us += (unsigned long)(unsigned int)(upload_timer() - t) * UPLOAD_TIMER_US;
+		}
+	}
+	printf("RAM OK 32KB March C- %lums\r\n", us / 1000);
+
+	// Bandwidth over the whole 32KB
+	t = upload_timer();
+	for(i = 0; i < RAM_TEST_PAGES * 2; i++)
+		bus_write_block(i * sizeof(buf), buf, sizeof(buf));
+	t = upload_timer() - t;
+	printf("RAM write %luKB/s", 8000000UL / t);
+	t = upload_timer();
+	for(i = 0; i < RAM_TEST_PAGES * 2; i++)
+		bus_read_block(i * sizeof(buf), buf, sizeof(buf));
+	t = upload_timer() - t;
+	printf(" read %luKB/s\r\n", 8000000UL / t);
+}
+
+#endif
+
+// Read the uploaded segments back against their CRC, halts on a failure
+void ram_verify(const struct image *img) {
+	const struct image_seg *seg = &image_segs[img->seg];
+	unsigned char buf[64];
+	unsigned int crc, a, n, k, j;
+	unsigned char i;
+
+	for(i = 0; i < img->nseg; i++, seg++) {
+		crc = 0;
+		for(a = seg->addr, n = seg->len; n; a += k, n -= k) {
+			k = n < sizeof(buf) ? n : sizeof(buf);
+			bus_read_block(a, buf, k);
+			for(j = 0; j < k; j++)
+				crc = crc16(crc, buf[j]);
+		}
+		if(crc != seg->crc) {
+			printf("%s CRC NG %04X-%04X %04X expect %04X\r\n", img->name,
+				seg->addr, seg->addr + seg->len - 1, crc, seg->crc);
+			while(1);
+		}
+	}
+}
+
+// Upload every segment of an image, returns the bytes written
+unsigned int upload_image(const struct image *img) {
+	const struct image_seg *seg = &image_segs[img->seg];
+	unsigned int n = 0;
+	unsigned char i;
+
+#ifdef ROM_UPLOAD_DMA
+	upload_dma_init();
+#endif
+	for(i = 0; i < img->nseg; i++, seg++) {
+		if(seg->lz)
+			upload_lz(seg->data, seg->addr);
+#ifdef ROM_UPLOAD_DMA
+		else
+			upload_dma(seg->data, seg->addr, seg->len);
+#else
+		else
+			upload_pio(seg->data, seg->addr, seg->len);
+#endif
+		n += seg->len;
+	}
+	ram_verify(img);			// Before the entry stub covers 0x0000
+	if(img->entry) {			// Z80 starts at 0x0000: JP entry
+		bus_write(0x0000, 0xc3);
+		bus_write(0x0001, img->entry & 0xff);
+		bus_write(0x0002, img->entry >> 8);
+	}
+	return n;
+}
+
+// Pick the image to boot: BOOT_IMAGE, or the one chosen in the menu that
+// ESC opens within BOOT_SELECT_MS. Any other key ends the wait and is kept
+// in rx_buf for the Z80, so typing ahead into the image loses nothing.
+#define BOOT_MENU_KEY 0x1b
+
+unsigned char boot_select(void) {
+	unsigned char c;
+	unsigned int ms;
+
+	if(image_count < 2)
+		return BOOT_IMAGE;
+	printf("%s, ESC for the image menu\r\n", images[BOOT_IMAGE].name);
+	for(ms = 0; ms < BOOT_SELECT_MS; ms++) {
+		if(U3RXIF) {
+			c = U3RXB;
+			if(c == CONSOLE_KEY) {
+				console_req = 1;	// Console before the Z80 starts
+				continue;
+			}
+			if(c != BOOT_MENU_KEY) {
+				uart_rx_put(c);		// Input for the Z80
+				return BOOT_IMAGE;
+			}
+			break;
+		}
+		__delay_ms(1);
+	}
+	if(ms == BOOT_SELECT_MS)
+		return BOOT_IMAGE;
+	for(c = 0; c < image_count; c++)
+		printf("%u:%s\r\n", c, images[c].name);
+	while(1) {						// A number, or ESC / CR for BOOT_IMAGE
+		while(!U3RXIF);
+		c = U3RXB;
+		if(c == CONSOLE_KEY)
+			console_req = 1;
+		else if(c == BOOT_MENU_KEY || c == '\r')
+			return BOOT_IMAGE;
+		else if((unsigned char)(c - '0') < image_count)
+			return c - '0';
+	}
+}
+
+//Data EEPROM (DFM) byte access
+#define EE_BASE 0x380000UL
+
+unsigned char ee_read(unsigned char a) {
+	NVMADR = EE_BASE + a;
+	NVMCON1bits.CMD = 0x00;	// Read byte
+	NVMCON0bits.GO = 1;
+	while(NVMCON0bits.GO);
+	return NVMDATL;
+}
+
+void ee_write(unsigned char a, unsigned char data) {
+	unsigned char gie = GIE;
+
+	if(ee_read(a) == data)
+		return;				// Save a write cycle
+	NVMADR = EE_BASE + a;
+	NVMDATL = data;
+	NVMCON1bits.CMD = 0x03;	// Write byte
+	while(1) {
+		GIE = 0;			// Unlock sequence must not be interrupted,
+		if(!IOCIE)			// but IORQ_ISR must first take the data
+			break;			// bus off after an IN
+		GIE = gie;
+	}
+	NVMLOCK = 0x55;
+	NVMLOCK = 0xAA;
+	NVMCON0bits.GO = 1;
+	GIE = gie;
+	while(NVMCON0bits.GO);	// DFM write does not stall the CPU
+	NVMCON1bits.CMD = 0x00;
+}
+
+//Z80 clock
+//NCO1 FDC mode: Fout = Fosc * NCO1INC / 2^21, so NCO1INC = kHz * 4096 / 125.
+//The boot clock comes from the data EEPROM, Z80_CLK until one is stored.
+//CLK_REG write: bit3-0 index into clk_table[], applied at once
+//               bit7 also store it as the boot clock
+//               0x40 calibrate at the next boot (the PIC resets)
+//CLK_REG read:  bit7-4 calibrated maximum, bit3-0 active index (0xf: none)
+const unsigned int clk_table[] = {	// kHz
+	2500, 4000, 5000, 6000, 8000, 10000, 12000, 14000, 16000, 18000, 20000
+};
+#define CLK_TABLE_SIZE (sizeof(clk_table) / sizeof(clk_table[0]))
+#define CLK_NONE 0x0f
+
+#define EE_CLK_MAGIC	0		// 0x5a when the entries below are valid
+#define EE_CLK_BOOT		1		// Boot clock index
+#define EE_CLK_MAX		2		// Highest index that passed calibration
+#define EE_CLK_CAL		3		// 1: calibrate at next boot
+
+unsigned char clk_idx = CLK_NONE;		// Active index
+unsigned char clk_max = CLK_NONE;		// Calibrated maximum
+volatile unsigned char clk_save;		// Store clk_idx from TASK_CLK
+volatile unsigned char clk_cal_req;		// Calibrate at next boot
+
+void clk_set(unsigned char n) {
+	clk_idx = n;
+	NCO1INC = (unsigned long)clk_table[n] * 4096 / 125;
+}
+
+// Boot clock from the EEPROM, 1 when calibration was requested
+unsigned char clk_load(void) {
+	unsigned char n;
+
+	if(ee_read(EE_CLK_MAGIC) != 0x5a) {
+		NCO1INC = (unsigned long)(Z80_CLK / 30.5175781);
+		return 0;
+	}
+	n = ee_read(EE_CLK_BOOT);
+	if(n < CLK_TABLE_SIZE)
+		clk_set(n);
+	else
+		NCO1INC = (unsigned long)(Z80_CLK / 30.5175781);
+	n = ee_read(EE_CLK_MAX);
+	clk_max = n < CLK_TABLE_SIZE ? n : CLK_NONE;
+	return ee_read(EE_CLK_CAL) == 1;
+}
 
-#define ROM_SIZE 0x2000		//8K bytes
-#define UART_DREG 0x00		//Data REG
-#define UART_CREG 0x01		//Control REG
+void clk_store(unsigned char boot, unsigned char max, unsigned char cal) {
+	ee_write(EE_CLK_BOOT, boot);
+	ee_write(EE_CLK_MAX, max);
+	ee_write(EE_CLK_CAL, cal);
+	ee_write(EE_CLK_MAGIC, 0x5a);
+}
 
-#define _XTAL_FREQ 64000000UL
+// TASK_CLK: store a setting requested at CLK_REG (EEPROM writes take milliseconds)
+void clk_task(void) {
+	if(clk_cal_req) {
+		clk_store(clk_idx, clk_max, 1);
+		printf("\r\nZ80 clock calibration, reset\r\n");
+		while(tx_wp != tx_rp || !U3TXMTIF);
+		RESET();
+	}
+	if(clk_save) {
+		clk_save = 0;
+		clk_store(clk_idx, clk_max, 0);
+	}
+}
+
+unsigned char clk_reg_rd(unsigned char port) {
+	(void)port;
+	return (unsigned char)(clk_max << 4 | clk_idx);
+}
+
+void clk_reg_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	if(data == 0x40) {
+		clk_cal_req = 1;
+		TASK_POST(TASK_CLK);
+		return;
+	}
+	if((data & 0x0f) >= CLK_TABLE_SIZE)
+		return;
+	clk_set(data & 0x0f);
+	if(data & 0x80) {
+		clk_save = 1;
+		TASK_POST(TASK_CLK);
+	}
+}
+
+void clk_io_init(void) {
+	io_register(CLK_REG, clk_reg_rd, clk_reg_wr);
+}
 
-//Z80 ROM equivalent, see end of this file
-extern const unsigned char rom[];
+//Z80 clock calibration
+//Steps up clk_table[] running a stress program from Z80 RAM: fill and
+//check 0x0100-0x10FF with a pattern that changes every pass, then 256
+//OUT/IN round trips through CLK_CAL_ECHO, then report the pass number at
+//CLK_CAL_PASS. A step is stable when CLK_CAL_PASSES passes come in order
+//within CLK_CAL_MS. The highest stable step becomes the boot clock.
+#define CLK_CAL_ECHO	0x04	// Read returns the last byte written
+#define CLK_CAL_PASS	0x05	// Pass number
+#define CLK_CAL_PASSES	8
+#define CLK_CAL_MS		3000
 
-//Address Bus
+const unsigned char clk_cal_prog[] = {
+	0x1e, 0x00,			// 0000       LD   E,0
+	0x21, 0x00, 0x01,	// 0002 loop: LD   HL,0100h
+	0x7d,				// 0005 fill: LD   A,L
+	0xac,				// 0006       XOR  H
+	0xab,				// 0007       XOR  E
+	0x77,				// 0008       LD   (HL),A
+	0x23,				// 0009       INC  HL
+	0x7c,				// 000A       LD   A,H
+	0xfe, 0x11,			// 000B       CP   11h
+	0x20, 0xf6,			// 000D       JR   NZ,fill
+	0x21, 0x00, 0x01,	// 000F       LD   HL,0100h
+	0x7d,				// 0012 chk:  LD   A,L
+	0xac,				// 0013       XOR  H
+	0xab,				// 0014       XOR  E
+	0xbe,				// 0015       CP   (HL)
+	0x20, 0x18,			// 0016       JR   NZ,fail
+	0x23,				// 0018       INC  HL
+	0x7c,				// 0019       LD   A,H
+	0xfe, 0x11,			// 001A       CP   11h
+	0x20, 0xf4,			// 001C       JR   NZ,chk
+	0x06, 0x00,			// 001E       LD   B,0
+	0x78,				// 0020 io:   LD   A,B
+	0xd3, CLK_CAL_ECHO,	// 0021       OUT  (ECHO),A
+	0xdb, CLK_CAL_ECHO,	// 0023       IN   A,(ECHO)
+	0xb8,				// 0025       CP   B
+	0x20, 0x08,			// 0026       JR   NZ,fail
+	0x10, 0xf6,			// 0028       DJNZ io
+	0x7b,				// 002A       LD   A,E
+	0xd3, CLK_CAL_PASS,	// 002B       OUT  (PASS),A
+	0x1c,				// 002D       INC  E
+	0x18, 0xd2,			// 002E       JR   loop
+	0x76,				// 0030 fail: HALT
+};
+
+unsigned char cal_echo;
+volatile unsigned char cal_pass, cal_bad;
+
+unsigned char cal_echo_rd(unsigned char port) {
+	(void)port;
+	return cal_echo;
+}
+
+void cal_echo_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	cal_echo = data;
+}
+
+void cal_pass_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	if(data == cal_pass)
+		cal_pass++;
+	else
+		cal_bad = 1;
+}
+
+// Run one step, 0 when it is stable
+unsigned char clk_cal_step(unsigned char n) {
+	unsigned int ms;
+
+	LATE1 = 0;				// Reset
+	__delay_us(10);
+	BUS_BUSREQ = 0;			// /BUSREQ=0
+	bus_master();
+	bus_write_block(0x0000, clk_cal_prog, sizeof(clk_cal_prog));
+	z80_bus_release();
+	clk_set(n);
+	cal_pass = cal_bad = 0;
+	LATE1 = 1;				// Release reset
+	for(ms = 0; ms < CLK_CAL_MS && !cal_bad && cal_pass < CLK_CAL_PASSES; ms++)
+		__delay_ms(1);
+	LATE1 = 0;				// Reset
+	return cal_pass < CLK_CAL_PASSES;
+}
+
+// Called with the Z80 in reset and interrupts running, does not return
+void clk_calibrate(void) {
+	unsigned char n, max = CLK_NONE;
+
+	io_init();				// Nothing but the calibration ports
+	io_register(CLK_CAL_ECHO, cal_echo_rd, cal_echo_wr);
+	io_register_sync(CLK_CAL_PASS, NULL, cal_pass_wr);	// Timed by clk_cal_step()
+	printf("Z80 clock calibration\r\n");
+	for(n = 0; n < CLK_TABLE_SIZE; n++) {
+		printf("%2u.%03uMHz ", clk_table[n] / 1000, clk_table[n] % 1000);
+		if(clk_cal_step(n)) {
+			printf("NG\r\n");
+			break;
+		}
+		printf("OK\r\n");
+		max = n;
+	}
+	if(max == CLK_NONE) {
+		printf("No stable clock\r\n");
+		clk_store(clk_idx, CLK_NONE, 0);
+	} else {
+		printf("Max %2u.%03uMHz\r\n", clk_table[max] / 1000, clk_table[max] % 1000);
+		clk_store(max, max, 0);
+	}
+	while(tx_wp != tx_rp || !U3TXMTIF);
+	RESET();
+}
+
+#ifdef IO_STATS
+//IO statistics ports
+//STAT_CMD write latches a value into STAT_DATA (4 reads, LSB first):
+//  0 IN count of port STAT_PORT    1 OUT count of port STAT_PORT
+//  2 histogram bucket STAT_PORT    0xff clear everything
+#define STAT_CMD_IN		0
+#define STAT_CMD_OUT	1
+#define STAT_CMD_HIST	2
+#define STAT_CMD_CLEAR	0xff
+
+unsigned char stat_port, stat_idx;
 union {
-	unsigned int w;			//16 bits Address
-	struct {
-		unsigned char l;	//Address low
-		unsigned char h;	//Address high
-	};
-} ab;
+	unsigned long l;
+	unsigned char b[4];
+} stat_latch;
 
+void stat_clear(void) {
+	memset(stat_in, 0, sizeof(stat_in));
+	memset(stat_out, 0, sizeof(stat_out));
+	memset(stat_hist, 0, sizeof(stat_hist));
+}
 
-// UART3 Transmit
-void putch(char c) {
-	while(!U3TXIF); // Wait or Tx interrupt flag set
-	U3TXB = c; // Write data
+unsigned char stat_reg_rd(unsigned char port) {
+	if(port == STAT_PORT)
+		return stat_port;
+	if(port == STAT_DATA)
+		return stat_latch.b[stat_idx++ & 3];
+	return 0xff;
 }
-/*
-// UART3 Recive
-char getch(void) {
-	while(!U3RXIF); // Wait for Rx interrupt flag set
-	return U3RXB; // Read data
+
+void stat_reg_wr(unsigned char port, unsigned char data) {
+	if(port == STAT_PORT) {
+		stat_port = data;
+		return;
+	}
+	stat_idx = 0;
+	if(data == STAT_CMD_IN)
+		stat_latch.l = stat_in[stat_port];
+	else if(data == STAT_CMD_OUT)
+		stat_latch.l = stat_out[stat_port];
+	else if(data == STAT_CMD_HIST && stat_port < STAT_BUCKETS)
+		stat_latch.l = stat_hist[stat_port];
+	else if(data == STAT_CMD_CLEAR)
+		stat_clear();
+	else
+		stat_latch.l = 0;
 }
-*/
 
-// Never called, logically
-void __interrupt(irq(default),base(8)) Default_ISR(){}
+// n in percent of total, both scaled down so n * 100 fits in 32 bits
+unsigned char stat_pct(unsigned long n, unsigned long total) {
+	while(total > 0x00ffffffUL) {
+		n >>= 1;
+		total >>= 1;
+	}
+	return total ? (unsigned char)(n * 100 / total) : 0;
+}
+
+void stat_dump(void) {
+	unsigned int p;
+	unsigned long total = 0;
+	unsigned char i;
+
+	printf("PORT        IN       OUT\r\n");
+	for(p = 0; p < 256; p++)
+		if(stat_in[p] || stat_out[p])
+			printf(" %02X  %9lu %9lu\r\n", p, stat_in[p], stat_out[p]);
+	for(i = 0; i < STAT_BUCKETS; i++)
+		total = total + stat_hist[i] < total ? 0xffffffffUL : total + stat_hist[i];
+	printf("ISR us     count\r\n");
+	for(i = 0; i < STAT_BUCKETS; i++)
+		if(stat_hist[i])
+			printf(" %2u%c %9lu %3u%%\r\n", i, i == STAT_BUCKETS - 1 ? '+' : ' ',
+				stat_hist[i], stat_pct(stat_hist[i], total));
+}
+
+void stat_init(void) {
+	T1CLK = 0x01;			// Fosc/4
+	T1CON = 0x03;			// 16-bit read, on
+	io_register(STAT_PORT, stat_reg_rd, stat_reg_wr);
+	io_register(STAT_CMD, NULL, stat_reg_wr);
+	io_register(STAT_DATA, stat_reg_rd, NULL);
+}
+#endif
+
+#ifdef IO_TRACE
+//IO trace dump
+//"Z80TRACE", the record count (16-bit) and TIM_US at the dump (32-bit),
+//the records oldest first: port, data, flags, TMR0 (16-bit), then the
+//CRC-16/XMODEM of everything after the magic. All little endian.
+const char trace_magic[8] = "Z80TRACE";
+
+void trace_clear(void) {
+	trace_wp = 0;
+	trace_wrap = 0;
+}
+
+void trace_dump(void) {
+	unsigned int n, k;
+	unsigned char i;
+
+	n = trace_wrap ? 256 : trace_wp;
+	tim_reg_rd(TIM_US);		// Latch the time of the dump
+	for(i = 0; i < sizeof(trace_magic); i++)
+		putch(trace_magic[i]);
+	dump_crc = 0;
+	dump_put(n & 0xff);
+	dump_put(n >> 8);
+	for(i = 0; i < 4; i++)
+		dump_put(tim_latch.b[i]);
+	i = trace_wrap ? trace_wp : 0;	// Oldest
+	for(k = 0; k < n; k++, i++) {
+		dump_put(trace_port[i]);
+		dump_put(trace_data[i]);
+		dump_put(trace_flag[i]);
+		dump_put(trace_tl[i]);
+		dump_put(trace_th[i]);
+	}
+	putch((char)(dump_crc & 0xff));
+	putch((char)(dump_crc >> 8));
+}
+
+// Any write to TRACE_DUMP: the Z80 asks for the dump itself
+void trace_reg_wr(unsigned char port, unsigned char data) {
+	(void)port;
+	(void)data;
+	TASK_POST(TASK_TRACE);
+}
+
+// TASK_TRACE, the Z80 is stopped so no record comes in meanwhile
+void trace_task(void) {
+	if(!z80_stop()) {
+		TASK_POST(TASK_TRACE);
+		return;
+	}
+	trace_dump();
+	BUS_BUSREQ = 1;			// /BUSREQ=1
+}
+
+void trace_init(void) {
+	io_register(TRACE_DUMP, NULL, trace_reg_wr);
+}
+#endif
+
+//UART loader
+//Console l command: Intel HEX, raw binary or XMODEM (128 byte and 1K
+//blocks, CRC) straight into Z80 RAM with the Z80 held in reset. Every
+//byte is read back after the write, then the CRC-16/XMODEM of the loaded
+//range is printed to compare with mkimage or the sender. The PIC only
+//reaches 0x0000-0x7FFF. g starts the Z80 at an entry address, b changes
+//the baud rate for a faster transfer.
+#define LD_TOP		0x8000
+#define LD_TRIES	30		// XMODEM: seconds to wait for the sender
+#define XM_SOH		0x01
+#define XM_STX		0x02
+#define XM_EOT		0x04
+#define XM_ACK		0x06
+#define XM_NAK		0x15
+#define XM_CAN		0x18
+
+unsigned int ld_lo, ld_hi;			// Loaded range
+unsigned int ld_bad;				// Bytes that did not read back
+unsigned int ld_entry;				// HEX start address
+
+// UART byte, -1 after BLK_UART_TIMEOUT_MS of silence
+int ld_getc(void) {
+	if(blk_uart_wait())
+		return -1;
+	return uart_rx_get();
+}
+
+// Drop input until the line goes quiet
+void ld_flush(void) {
+	while(ld_getc() >= 0);
+}
+
+unsigned char ld_put(unsigned int addr, unsigned char c) {
+	if(addr >= LD_TOP)
+		return 1;
+	bus_write(addr, c);
+	if(bus_read(addr) != c)
+		ld_bad++;
+	if(addr < ld_lo)
+		ld_lo = addr;
+	if(addr >= ld_hi)
+		ld_hi = addr + 1;
+	return 0;
+}
+
+// Two hex digits of a HEX record, -1 on error
+int ld_hex_byte(void) {
+	unsigned char i, v = 0;
+	int c;
+
+	for(i = 0; i < 2; i++) {
+		if((c = ld_getc()) < 0)
+			return -1;
+		if(c >= '0' && c <= '9')
+			c -= '0';
+		else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+			c = (c | 0x20) - 'a' + 10;
+		else
+			return -1;
+		v = (unsigned char)(v << 4 | c);
+	}
+	return v;
+}
+
+// Intel HEX up to the end record, 0 or the failing line
+unsigned int ld_hex(void) {
+	unsigned char rec[4 + 256], sum;
+	unsigned int line = 0, addr, i;
+	int c;
+
+	while(1) {
+		do {
+			if((c = ld_getc()) < 0)
+				return line + 1;
+		} while(c != ':');
+		line++;
+		sum = 0;
+		for(i = 0; i < 4; i++) {		// Count, address, type
+			if((c = ld_hex_byte()) < 0)
+				return line;
+			rec[i] = (unsigned char)c;
+			sum += rec[i];
+		}
+		for(i = 0; i <= rec[0]; i++) {	// Data and checksum
+			if((c = ld_hex_byte()) < 0)
+				return line;
+			rec[4 + i] = (unsigned char)c;
+			sum += rec[4 + i];
+		}
+		if(sum)
+			return line;
+		addr = (unsigned int)rec[1] << 8 | rec[2];
+		switch(rec[3]) {
+		case 0x00:					// Data
+			for(i = 0; i < rec[0]; i++)
+				if(ld_put(addr + i, rec[4 + i]))
+					return line;
+			break;
+		case 0x01:					// End of file
+			return 0;
+		case 0x02:					// Extended address must stay 0
+		case 0x04:
+			if(rec[4] || rec[5])
+				return line;
+			break;
+		case 0x03:					// Start address
+		case 0x05:
+			ld_entry = (unsigned int)rec[6] << 8 | rec[7];
+			break;
+		default:
+			return line;
+		}
+	}
+}
+
+// len raw bytes, 0 or the bytes missing
+unsigned int ld_raw(unsigned int addr, unsigned int len) {
+	int c;
+
+	for(; len; len--, addr++) {
+		if((c = ld_getc()) < 0 || ld_put(addr, (unsigned char)c))
+			break;
+	}
+	return len;
+}
+
+// XMODEM receive, 0 when the sender finished with EOT
+unsigned char ld_xmodem(unsigned int addr) {
+	unsigned char blk = 1, tries = 0, reply = 'C', n, bad, over = 0;
+	unsigned int len, i, crc;
+	int c, d;
+
+	while(1) {
+		putch((char)reply);
+		if((c = ld_getc()) < 0) {
+			if(++tries >= LD_TRIES)
+				return 1;
+			if(blk != 1)
+				reply = XM_NAK;
+			continue;
+		}
+		tries = 0;
+		if(c == XM_EOT) {
+			putch(XM_ACK);
+			return 0;
+		}
+		if(c == XM_CAN)
+			return 1;
+		if(c != XM_SOH && c != XM_STX) {
+			ld_flush();
+			reply = XM_NAK;
+			continue;
+		}
+		len = c == XM_STX ? 1024 : 128;
+		if((c = ld_getc()) < 0 || (d = ld_getc()) < 0) {
+			reply = XM_NAK;
+			continue;
+		}
+		n = (unsigned char)c;
+		bad = (unsigned char)(n ^ d) != 0xff;
+		crc = 0;
+		for(i = 0; i < len; i++) {	// Data goes to RAM as it comes
+			if((c = ld_getc()) < 0)
+				break;
+			crc = crc16(crc, (unsigned char)c);
+			if(n == blk && ld_put(addr + i, (unsigned char)c))
+				over = 1;
+		}
+		if(i < len || (c = ld_getc()) < 0 || (d = ld_getc()) < 0
+			|| crc != ((unsigned int)c << 8 | (unsigned int)d) || bad) {
+			ld_flush();
+			reply = XM_NAK;
+			continue;
+		}
+		if(over) {					// Past the top of reachable RAM
+			putch(XM_CAN);
+			putch(XM_CAN);
+			return 1;
+		}
+		if(n == blk) {
+			addr += len;
+			blk++;
+		} else if(n != (unsigned char)(blk - 1)) {	// Out of sync
+			putch(XM_CAN);
+			putch(XM_CAN);
+			return 1;
+		}
+		reply = XM_ACK;				// New block or a repeat of the last
+	}
+}
+
+// Next hex number of a console line
+unsigned int console_hex(char **p) {
+	unsigned int v = 0;
+	char c;
+
+	while(**p == ' ')
+		(*p)++;
+	while(1) {
+		c = **p;
+		if(c >= '0' && c <= '9')
+			c -= '0';
+		else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+			c = (char)((c | 0x20) - 'a' + 10);
+		else
+			break;
+		v = v << 4 | (unsigned char)c;
+		(*p)++;
+	}
+	return v;
+}
+
+// l h | l b ADDR LEN | l x ADDR, the Z80 stays in reset until g or x
+void ld_cmd(char *p) {
+	unsigned int a, len = 0, err;
+	unsigned int crc = 0;
+	char fmt;
+
+	while(*p == ' ')
+		p++;
+	fmt = *p ? *p++ : 0;
+	a = console_hex(&p);
+	if(fmt == 'b')
+		len = console_hex(&p);
+	if((fmt != 'h' && fmt != 'b' && fmt != 'x') || (fmt == 'b' && !len) || a >= LD_TOP) {
+		printf("l h | l b ADDR LEN | l x ADDR\r\n");
+		return;
+	}
+	if(fmt == 'h')
+		printf("Send Intel HEX\r\n");
+	else if(fmt == 'b')
+		printf("Send %u bytes\r\n", len);
+	else
+		printf("Start XMODEM\r\n");
+	ld_lo = 0xffff;
+	ld_hi = 0;
+	ld_bad = 0;
+	ld_entry = 0;
+	snap_ram_bad = 0;		// Whatever is loaded is what x runs
+	LATE1 = 0;				// Reset
+	bus_master();
+	if(fmt == 'h')
+		err = ld_hex();
+	else if(fmt == 'b')
+		err = ld_raw(a, len);
+	else
+		err = ld_xmodem(a);
+	for(a = ld_lo; a < ld_hi; a++)
+		crc = crc16(crc, bus_read(a));
+	bus_slave();			// Held until g or x
+	if(fmt == 'h' && err)
+		printf("HEX error at record %u\r\n", err);
+	else if(fmt == 'b' && err)
+		printf("%u bytes missing\r\n", err);
+	else if(err)
+		printf("XMODEM failed\r\n");
+	if(ld_hi)
+		printf("%04X-%04X crc %04X entry %04X\r\n", ld_lo, ld_hi - 1, crc, ld_entry);
+	if(ld_bad)
+		printf("%u bytes did not read back\r\n", ld_bad);
+}
+
+// g ADDR: start at ADDR through JP ADDR at 0x0000 (0x0000 itself needs none)
+void ld_go(char *p) {
+	unsigned int a = console_hex(&p);
+
+	snap_ram_bad = 0;
+	if(a) {
+		bus_master();
+		bus_write(0x0000, 0xc3);
+		bus_write(0x0001, a & 0xff);
+		bus_write(0x0002, a >> 8);
+		z80_bus_release();
+	} else
+		BUS_BUSREQ = 1;		// /BUSREQ=1
+	LATE1 = 1;				// Release reset
+}
+
+// b N: baud_table[N], once everything queued has gone out
+void ld_baud(char *p) {
+	unsigned int n = console_hex(&p);
+
+	if(n >= BAUD_TABLE_SIZE) {
+		printf("b 0-%u\r\n", (unsigned int)(BAUD_TABLE_SIZE - 1));
+		return;
+	}
+	printf("%lubps\r\n", baud_table[n]);
+	while(tx_wp != tx_rp || !U3TXMTIF);
+	uart_set_baud((unsigned char)n);
+}
+
+//PIC monitor
+//Console commands on Z80 RAM while /BUSREQ holds the Z80, numbers in hex:
+//  d [ADDR [LEN]] dump            e ADDR BYTE... enter
+//  f ADDR LEN BYTE fill           c ADDR1 ADDR2 LEN compare
+//  m SRC DST LEN move             h ADDR LEN BYTE... hunt
+//The PIC drives the bus as in the upload and works through the blitter
+//buffers, so only the output waits for the UART. Fill and move are the
+//blitter's. A key stops a dump. The PIC reaches 0x0000-0x7FFF only.
+#define MON_TOP		0x8000UL
+#define MON_ARGS	16
+#define MON_LIST	32		// Compare and hunt list this many addresses
+
+unsigned int mon_arg[MON_ARGS];
+unsigned int mon_next;		// d without arguments continues here
+
+// Hex arguments of a console line into mon_arg[], returns how many
+unsigned char mon_args(char *p) {
+	unsigned char n = 0;
+	char *q;
+
+	while(n < MON_ARGS) {
+		while(*p == ' ')
+			p++;
+		q = p;
+		mon_arg[n] = console_hex(&p);
+		if(p == q)
+			break;
+		n++;
+	}
+	return n;
+}
+
+// 1 when ADDR+LEN runs past what the PIC can address
+unsigned char mon_range(unsigned int a, unsigned int len) {
+	if((unsigned long)a + len <= MON_TOP)
+		return 0;
+	printf("0000-7FFF only\r\n");
+	return 1;
+}
+
+void mon_dump(unsigned int a, unsigned int len) {
+	unsigned char i, n;
+
+	while(len && !RX_READY()) {
+		n = len < 16 ? (unsigned char)len : 16;
+		bus_read_block(a, blt_buf, n);
+		printf("%04X ", a);
+		for(i = 0; i < 16; i++) {
+			if(i < n)
+				printf(" %02X", blt_buf[i]);
+			else
+				printf("   ");
+		}
+		printf("  ");
+		for(i = 0; i < n; i++)
+			putch(blt_buf[i] >= ' ' && blt_buf[i] < 0x7f ? (char)blt_buf[i] : '.');
+		printf("\r\n");
+		a += n;
+		len -= n;
+	}
+	if(RX_READY())
+		uart_rx_get();			// The key that stopped it
+	mon_next = a;
+}
+
+void mon_compare(unsigned int a, unsigned int b, unsigned int len) {
+	unsigned int n, i, diff = 0;
+
+	for(; len; a += n, b += n, len -= n) {
+		n = blt_chunk(len);
+		bus_read_block(a, blt_buf, n);
+		bus_read_block(b, blt_buf2, n);
+		for(i = 0; i < n; i++)
+			if(blt_buf[i] != blt_buf2[i] && diff++ < MON_LIST)
+				printf("%04X %02X  %04X %02X\r\n", a + i, blt_buf[i], b + i, blt_buf2[i]);
+	}
+	printf("%u differ\r\n", diff);
+}
+
+// Pattern in blt_buf2, chunks overlap by plen-1 so no match is split
+void mon_hunt(unsigned int a, unsigned int len, unsigned char plen) {
+	unsigned int n, i, found = 0;
+	unsigned char j;
+
+	while(len >= plen) {
+		n = blt_chunk(len);
+		bus_read_block(a, blt_buf, n);
+		for(i = 0; i + plen <= n; i++) {
+			for(j = 0; j < plen && blt_buf[i + j] == blt_buf2[j]; j++);
+			if(j == plen && found++ < MON_LIST)
+				printf("%04X\r\n", a + i);
+		}
+		if(n == len)
+			break;
+		n -= plen - 1;
+		a += n;
+		len -= n;
+	}
+	printf("%u found\r\n", found);
+}
+
+void mon_cmd(char cmd, char *p) {
+	unsigned char n = mon_args(p), i;
+	unsigned int a = mon_arg[0], len = mon_arg[1];
+
+	switch(cmd) {
+	case 'd':
+		if(!n)
+			a = mon_next;
+		if(n < 2)
+			len = 0x100;
+		if(a >= MON_TOP)
+			a = 0;
+		if((unsigned long)a + len > MON_TOP)
+			len = (unsigned int)(MON_TOP - a);
+		bus_master();
+		mon_dump(a, len);
+		break;
+	case 'e':
+		if(n < 2) {
+			printf("e ADDR BYTE...\r\n");
+			return;
+		}
+		if(mon_range(a, n - 1))
+			return;
+		for(i = 1; i < n; i++)
+			blt_buf2[i - 1] = (unsigned char)mon_arg[i];
+		bus_master();
+		bus_write_block(a, blt_buf2, n - 1);
+		mon_dump(a, n - 1);		// Read back
+		break;
+	case 'f':
+		if(n != 3) {
+			printf("f ADDR LEN BYTE\r\n");
+			return;
+		}
+		if(mon_range(a, len))
+			return;
+		bus_master();
+		blt_fill(a, len, (unsigned char)mon_arg[2]);
+		break;
+	case 'c':
+	case 'm':
+		if(n != 3) {
+			if(cmd == 'c')
+				printf("c ADDR1 ADDR2 LEN\r\n");
+			else
+				printf("m SRC DST LEN\r\n");
+			return;
+		}
+		if(mon_range(a, mon_arg[2]) || mon_range(len, mon_arg[2]))
+			return;
+		bus_master();
+		if(cmd == 'c')
+			mon_compare(a, len, mon_arg[2]);
+		else
+			blt_move(a, len, mon_arg[2]);
+		break;
+	default:
+		if(n < 3) {
+			printf("h ADDR LEN BYTE...\r\n");
+			return;
+		}
+		if(mon_range(a, len))
+			return;
+		for(i = 2; i < n; i++)
+			blt_buf2[i - 2] = (unsigned char)mon_arg[i];
+		bus_master();
+		mon_hunt(a, len, n - 2);
+		break;
+	}
+	bus_slave();
+}
+
+#ifdef Z80_PROF
+//Z80 profiler
+//TMR6 interrupts every PROF_PERIOD_US and samples the address bus while
+//the Z80 runs on its own. A sample counts when /MREQ and /RD are low
+//before and after reading the address and /RFSH is high, with
+//USE_Z80_INT only opcode fetches (/M1 low). Other samples are missed.
+//PROF_BUCKETS counters cover 256 << shift bytes from base, set by the
+//console "p s". A15 is not on the PIC, so 0x8000-0xFFFF folds onto
+//0x0000-0x7FFF. The period is prime so loops in step with it are rare.
+//  p s [BASE [SHIFT]] start   p t stop   p list   p o binary dump
+//Dump: "Z80PROF\0", base (16-bit), shift, buckets (16-bit), samples,
+//missed, outside the buckets (32-bit each), the 16-bit counters, then
+//CRC-16/XMODEM of everything after the magic. All little endian.
+#define PROF_BUCKETS	256
+#define PROF_PERIOD_US	97
+#define PROF_MREQ_RD	0x22	// PORTA: /MREQ RA1, /RD RA5
+#define PROF_RFSH		0x40	// PORTD: /RFSH RD6
+#define PROF_A14		0x04	// PORTE: A14 RE2
+#define PROF_TOP		16		// Buckets listed by "p"
+
+const char prof_magic[8] = "Z80PROF";
+unsigned int prof_cnt[PROF_BUCKETS];
+unsigned long prof_samples, prof_missed, prof_out;
+unsigned int prof_base;
+unsigned char prof_shift;
+
+void prof_stop(void) {
+	TMR6IE = 0;
+	T6CON = 0x00;			// Stopped
+}
+
+void prof_start(unsigned int base, unsigned char shift) {
+	prof_stop();
+	memset(prof_cnt, 0, sizeof(prof_cnt));
+	prof_samples = prof_missed = prof_out = 0;
+	prof_base = base;
+	prof_shift = shift;
+	T6CLKCON = 0x01;		// Fosc/4
+	T6HLT = 0x00;			// Free running
+	T6PR = PROF_PERIOD_US - 1;
+	TMR6 = 0;
+	TMR6IF = 0;
+	TMR6IE = 1;
+	T6CON = 0xc0;			// On, 1:16 = 1us
+}
+
+// Buckets by count, PROF_TOP of them
+void prof_list(void) {
+	unsigned int last = 0xffff, c, best, i, j, k = 0;
+	unsigned char n;
+
+	printf("%lu samples, %lu missed, %lu outside %04X-%04X\r\n",
+		prof_samples, prof_missed, prof_out, prof_base,
+		prof_base + ((unsigned int)PROF_BUCKETS << prof_shift) - 1);
+	for(n = 0; n < PROF_TOP; n++) {
+		best = PROF_BUCKETS;
+		for(i = 0; i < PROF_BUCKETS; i++) {	// Next below the last one listed
+			c = prof_cnt[i];
+			if(!c || c > last || (c == last && i <= k))
+				continue;
+			if(best == PROF_BUCKETS || c > prof_cnt[best])
+				best = i;
+		}
+		if(best == PROF_BUCKETS)
+			break;
+		last = prof_cnt[best];
+		k = best;
+		j = prof_base + (best << prof_shift);
+		printf(" %04X-%04X %6u %3lu%%\r\n", j, j + (1 << prof_shift) - 1, last,
+			prof_samples ? (unsigned long)last * 100 / prof_samples : 0);
+	}
+}
+
+void prof_dump(void) {
+	unsigned char i;
+	unsigned int k;
+
+	for(i = 0; i < sizeof(prof_magic); i++)
+		putch(prof_magic[i]);
+	dump_crc = 0;
+	dump_put(prof_base & 0xff);
+	dump_put(prof_base >> 8);
+	dump_put(prof_shift);
+	dump_put(PROF_BUCKETS & 0xff);
+	dump_put(PROF_BUCKETS >> 8);
+	for(i = 0; i < 4; i++)
+		dump_put((unsigned char)(prof_samples >> (i * 8)));
+	for(i = 0; i < 4; i++)
+		dump_put((unsigned char)(prof_missed >> (i * 8)));
+	for(i = 0; i < 4; i++)
+		dump_put((unsigned char)(prof_out >> (i * 8)));
+	for(k = 0; k < PROF_BUCKETS; k++) {
+		dump_put(prof_cnt[k] & 0xff);
+		dump_put(prof_cnt[k] >> 8);
+	}
+	putch((char)(dump_crc & 0xff));
+	putch((char)(dump_crc >> 8));
+}
+
+void prof_cmd(char *p) {
+	unsigned char n;
+
+	while(*p == ' ')
+		p++;
+	switch(*p) {
+	case 's':
+		n = mon_args(p + 1);
+		if(n > 1 && mon_arg[1] > 7)
+			mon_arg[1] = 7;		// 256 << 7 is all of 0x0000-0x7FFF
+		prof_start(n ? mon_arg[0] & 0x7fff : 0, n > 1 ? (unsigned char)mon_arg[1] : 7);
+		printf("Profiling %04X-%04X, %u bytes per bucket\r\n", prof_base,
+			prof_base + ((unsigned int)PROF_BUCKETS << prof_shift) - 1, 1 << prof_shift);
+		break;
+	case 't':
+		prof_stop();
+		break;
+	case 'o':
+		prof_dump();
+		printf("\r\n");
+		break;
+	default:
+		prof_list();
+	}
+}
+
+void prof_init(void) {
+	TMR6IP = 0;				// Low priority, never in the way of CLC_ISR
+}
+#endif
+
+//PIC console
+//CONSOLE_KEY on the UART posts TASK_CONSOLE, which stops the Z80 with
+//the /BUSREQ line and gives the terminal to the PIC until the "x"
+//command. Nothing typed there reaches the Z80. Typed while the boot
+//images are listed, the console opens before the Z80 leaves reset.
+#define CONSOLE_LINE 40
+
+// Read a line with echo and backspace
+void console_gets(char *buf, unsigned char len) {
+	unsigned char n = 0;
+	char c;
+
+	while(1) {
+		c = getch();
+		if(c == '\r' || c == '\n')
+			break;
+		if(c == 0x08 || c == 0x7f) {
+			if(n) {
+				n--;
+				printf("\b \b");
+			}
+			continue;
+		}
+		if(n < len - 1 && c >= ' ') {
+			buf[n++] = c;
+			putch(c);
+		}
+	}
+	buf[n] = 0;
+	printf("\r\n");
+}
+
+// Z80 stopped or in reset
+void console(void) {
+	char line[CONSOLE_LINE];
+	unsigned int n;
+
+	printf("\r\nPIC console, x to resume\r\n");
+	while(1) {
+		printf("* ");
+		console_gets(line, sizeof(line));
+		switch(line[0]) {
+		case 0:
+			break;
+#ifdef IO_STATS
+		case 's':
+			stat_dump();
+			break;
+#endif
+#ifdef IO_TRACE
+		case 't':
+			trace_dump();
+			printf("\r\n");
+			break;
+#endif
+#if defined(IO_STATS) || defined(IO_TRACE)
+		case 'z':
+#ifdef IO_STATS
+			stat_clear();
+#endif
+#ifdef IO_TRACE
+			trace_clear();
+#endif
+			break;
+#endif
+		case 'r':
+			printf("Send the snapshot stream, 0x0000-0x7FFF only\r\n");
+			LATE1 = 0;		// Reset
+			bus_master();
+			n = snap_load_uart();
+			z80_bus_release();
+			if(!n) {
+				BUS_BUSREQ = 0;
+				printf("Snapshot NG, Z80 held in reset\r\n");
+				break;
+			}
+			printf("Resume SP=%04X\r\n", n);
+			console_req = 0;
+			LATE1 = 1;		// Release reset
+			return;
+		case 'd':
+		case 'e':
+		case 'f':
+		case 'c':
+		case 'm':
+		case 'h':
+			mon_cmd(line[0], line + 1);
+			break;
+#ifdef Z80_PROF
+		case 'p':
+			prof_cmd(line + 1);
+			break;
+#endif
+		case 'l':
+			ld_cmd(line + 1);
+			break;
+		case 'g':
+			ld_go(line + 1);
+			console_req = 0;
+			return;
+		case 'b':
+			ld_baud(line + 1);
+			break;
+		case 'x':
+			if(snap_ram_bad) {
+				printf("RAM holds a failed snapshot, r or l first\r\n");
+				break;
+			}
+			console_req = 0;
+			BUS_BUSREQ = 1;	// /BUSREQ=1
+			LATE1 = 1;		// Release reset (after a failed r, or l)
+			return;
+		default:
+#ifdef IO_STATS
+			printf("s: IO statistics  ");
+#endif
+#ifdef IO_TRACE
+			printf("t: IO trace (binary)  ");
+#endif
+#if defined(IO_STATS) || defined(IO_TRACE)
+			printf("z: clear  ");
+#endif
+#ifdef Z80_PROF
+			printf("p: profiler  ");
+#endif
+			printf("r: load 32KB snapshot  l: load program  g: go  b: baud rate  x: resume\r\n");
+			printf("d: dump  e: enter  f: fill  c: compare  m: move  h: hunt\r\n");
+		}
+	}
+}
+
+// TASK_CONSOLE
+void console_task(void) {
+	if(!z80_stop()) {
+		TASK_POST(TASK_CONSOLE);
+		return;
+	}
+	console();
+}
+
+// Run the first pending task, see Background tasks
+void task_run(void) {
+	unsigned char p = task_pend;
+
+	if(p & TASK_JOB) {
+		TASK_CLEAR(TASK_JOB);
+		io_job_run();
+	} else if(p & TASK_IOWQ) {
+		TASK_CLEAR(TASK_IOWQ);
+		io_wq_run();
+	} else if(p & TASK_UART) {
+		TASK_CLEAR(TASK_UART);
+		uart_baud_task();
+	} else if(p & TASK_CLK) {
+		TASK_CLEAR(TASK_CLK);
+		clk_task();
+#ifdef USE_SD
+	} else if(p & TASK_DISK) {
+		TASK_CLEAR(TASK_DISK);
+		disk_wb_task();
+#endif
+#ifdef IO_TRACE
+	} else if(p & TASK_TRACE) {
+		TASK_CLEAR(TASK_TRACE);
+		trace_task();
+#endif
+	} else if(p & TASK_CONSOLE) {
+		TASK_CLEAR(TASK_CONSOLE);
+		console_task();
+	}
+}
+
+// TMR0 overflow: microsecond counter bits 31-16
+void __interrupt(irq(TMR0),base(8),low_priority) TIM_ISR(){
+	TMR0IF = 0;
+	tim_hi++;
+}
+
+// TMR4 1ms: periodic tick, disk write-back countdown
+void __interrupt(irq(TMR4),base(8),low_priority) TICK_ISR(){
+	TMR4IF = 0;
+#ifdef USE_SD
+	if(disk_wb_req) {
+		disk_wb_req = 0;
+		disk_wb_ms = DISK_FLUSH_MS;
+	} else if(disk_wb_ms && !--disk_wb_ms)
+		TASK_POST(TASK_DISK);
+#endif
+	if(!tim_period || ++tim_ms < tim_period)
+		return;
+	tim_ms = 0;
+	if(tim_ticks != 0xff)
+		tim_ticks++;
+	INT_UPDATE_LOW();
+}
+
+#ifdef Z80_PROF
+// TMR6: one address bus sample for the profiler
+void __interrupt(irq(TMR6),base(8),low_priority) PROF_ISR(){
+	unsigned char c1, c2, l, h, e;
+	unsigned int a;
+
+	TMR6IF = 0;
+	if(!BUS_BUSREQ)				// PIC owns the bus (console, bus job)
+		return;
+	c1 = PORTA;
+	l = BUS_ADDR_L;
+	h = PORTD;
+	e = PORTE;
+	c2 = PORTA;
+	if((c1 | c2) & PROF_MREQ_RD || !(h & PROF_RFSH)
+#ifdef USE_Z80_INT
+		|| Z80_M1				// Operand or data read
+#endif
+		) {
+		prof_missed++;
+		return;
+	}
+	prof_samples++;
+	a = ((unsigned int)(h & 0x3f) << 8 | l | (e & PROF_A14 ? 0x4000 : 0)) - prof_base;
+	if(a >= ((unsigned int)PROF_BUCKETS << prof_shift)) {
+		prof_out++;
+		return;
+	}
+	a >>= prof_shift;
+	if(prof_cnt[a] != 0xffff)
+		prof_cnt[a]++;
+}
+#endif
+
+// UART3 RX: move the hardware FIFO into rx_buf
+void __interrupt(irq(U3RX),base(8),low_priority) UART_RX_ISR(){
+	unsigned char c;
+
+	while(U3RXIF) {
+		c = U3RXB;
+		if(c == CONSOLE_KEY && !console_req) {	// Handled by TASK_CONSOLE
+			console_req = 1;
+			TASK_POST(TASK_CONSOLE);
+			continue;
+		}
+		uart_rx_put(c);
+	}
+	INT_UPDATE_LOW();
+}
+
+// UART3 TX: feed the hardware FIFO from tx_buf
+void __interrupt(irq(U3TX),base(8),low_priority) UART_TX_ISR(){
+	while(U3TXIF && tx_wp != tx_rp) {
+		U3TXB = tx_buf[tx_rp];
+		tx_rp = (tx_rp + 1) & (UART_TXBUF_SIZE - 1);
+	}
+	if(tx_wp == tx_rp) {
+		U3TXIE = 0;				// Nothing left, stop TX interrupt
+		if(uart_baud_req != uart_baud)
+			U3ERRIEbits.TXMTIE = 1;	// Baud change once the last byte is out
+	}
+	INT_UPDATE_LOW();
+}
+
+// UART3 TX shift register empty: time for a pending baud rate change
+void __interrupt(irq(U3),base(8),low_priority) UART_TXMT_ISR(){
+	U3ERRIEbits.TXMTIE = 0;		// Stays set while TX is idle
+	TASK_POST(TASK_UART);
+}
 
 // Called at WAIT falling edge(Immediately after Z80 MREQ falling)
 void __interrupt(irq(CLC3),base(8)) CLC_ISR(){
-	ab.l = PORTB; // Read address low
+	unsigned char d;
+
+	STAT_START();
+	ab.l = BUS_ADDR_L; // Read address low
+
+#ifdef USE_Z80_INT
+	//Z80 interrupt acknowledge (IORQ with M1, neither RD nor WR)
+	if(!Z80_M1) {
+		io_drain();				// INT_CTRL writes first
+		BUS_DATA_DIR = 0x00;	// Set as output
+		BUS_DATA_OUT = d = int_vector();
+		BUS_READ_END_ARM();		// IORQ_ISR takes the data bus off
+		BUS_WAIT_RELEASE();
+		BUS_WAIT_DONE();		// Clear interrupt flag
+		int_update();			// Drop a stale /INT
+		TRACE(TRACE_INTA, d);
+		return;
+	}
+#endif
 
 	//Z80 IO write cycle
-	if(RA5) {
-		if(ab.l == UART_DREG)	// U3TXB
-		U3TXB = PORTC;			// Write into	U3TXB
+	if(BUS_IO_WRITE) {
+		d = BUS_DATA_IN;
+		if(!IO_SYNC(ab.l) && IO_WQ_ROOM()) {	// Device write later
+			io_wq_port[io_wq_wp] = ab.l;
+			io_wq_data[io_wq_wp] = d;
+			io_wq_wp = (io_wq_wp + 1) & (IO_WQ_SIZE - 1);
+			BUS_WAIT_RELEASE();
+			STAT_END();
+			BUS_WAIT_DONE();
+			TASK_POST(TASK_IOWQ);
+			STAT_OUT(ab.l);
+			TRACE(TRACE_OUT | TRACE_QUEUED, d);
+			return;
+		}
+		io_drain();				// Earlier writes first
+		io_wr[ab.l](ab.l, d);	// Device write
+		if(io_job) {			// Held for a bus job, see io_hold()
+			BUS_WAIT_DONE();
+			STAT_OUT(ab.l);
+			TRACE(TRACE_OUT | TRACE_HELD, d);
+			return;
+		}
 	//Release wait (D-FF reset)
-	G3POL = 1;
-	G3POL = 0;
-	CLC3IF = 0;					// Clear interrupt flag
+	BUS_WAIT_RELEASE();
+	STAT_END();
+	BUS_WAIT_DONE();			// Clear interrupt flag
+	STAT_OUT(ab.l);
+	TRACE(TRACE_OUT, d);
 	return;
 	}
 
 	//Z80 IO read cycle
-	TRISC = 0x00; 				// Set as output
-	if(ab.l == UART_CREG)		// PIR9
-		LATC = PIR9;			// Out PIR9
-	else if(ab.l == UART_DREG)	// U3RXB
-		LATC = U3RXB;			// Out U3RXB
-	else						// Empty
-		LATC = 0xff;			// Invalid data
+	if(IO_OBS(ab.l))
+		io_drain();				// Queued writes first
+	BUS_DATA_DIR = 0x00;		// Set as output
+	if(ab.l == UART_CREG)		// Polled in a loop: direct, not through io_rd[]
+		d = uart_creg_rd(ab.l);
+	else if(ab.l == UART_DREG)
+		d = uart_dreg_rd(ab.l);
+	else
+		d = io_rd[ab.l](ab.l);	// Device read
+	BUS_DATA_OUT = d;
+	BUS_READ_END_ARM();			// IORQ_ISR takes the data bus off
 
 	//Release wait (D-FF reset)
-	G3POL = 1;
-	G3POL = 0;
+	BUS_WAIT_RELEASE();
+	STAT_END();
+	BUS_WAIT_DONE();			// Clear interrupt flag
+	STAT_IN(ab.l);
+	TRACE(0, d);
+}
 
-//Post processing
-//	while(!RA0);				// /IORQ <5.6MHz
-	while(!RD7);				// /WAIT >=5.6MHz
-	TRISC = 0xff;				// Set as input
-	CLC3IF = 0;					// Clear interrupt flag
+// Called at /IORQ rising edge after an IO read (Z80 has latched the data)
+// Runs right after CLC_ISR if the edge came first, so no clock dependent spin
+void __interrupt(irq(IOC),base(8)) IORQ_ISR(){
+	BUS_DATA_DIR = 0xff;		// Set as input
+	BUS_READ_END_DONE();
 }
 
 // main routine
 void main(void) {
 
-	unsigned int i;
+	unsigned int t, n;
+	unsigned char img, cal;
 
 	// System initialize
 	OSCFRQ = 0x08; // 64MHz internal OSC
@@ -196,8 +4252,7 @@ void main(void) {
 	RA3PPS = 0x3f;	// RA3 asign NCO1
 	ANSELA3 = 0;	// Disable analog function
 	TRISA3 = 0;		// NCO output pin
-//	NCO1INC = Z80_CLK * 2 / 61;
-	NCO1INC = (unsigned int)(Z80_CLK / 30.5175781);
+	cal = clk_load();		// NCO1INC from the stored setting
 	NCO1CLK = 0x00;	// Clock source Fosc
 	NCO1PFM = 0; 	// FDC mode
 	NCO1OUT = 1; 	// NCO output enable
@@ -214,7 +4269,7 @@ void main(void) {
 	TRISA4 = 0;		// Set as output
 
 	// UART3 initialize
-	U3BRG = 416;	// 9600bps @ 64MHz
+	uart_set_baud(UART_BAUD);	// Reset baud rate
 	U3RXEN = 1;		// Receiver enable
 	U3TXEN = 1;		// Transmitter enable
 
@@ -231,16 +4286,20 @@ void main(void) {
 
 	U3ON = 1;		// Serial port enable
 
+    printf("\r\nMEZ80RAM %2.3fMHz %lubps\r\n",NCO1INC * 30.5175781 / 1000000, baud_table[uart_baud]);
+	img = boot_select();
+
 	RA2PPS = 0x00;		// LATA2 -> RA2
 
-	for(i = 0; i < ROM_SIZE; i++) {
-		ab.w = i;
-		LATD = ab.h;
-		LATB = ab.l;
-		LATA2 = 0;		// /WE=0
-		LATC = rom[i];
-		LATA2 = 1;		// /WE=1
-	}
+	// Upload timer
+	T0CON1 = 0x46;	// Fosc/4, 1:64
+	T0CON0 = 0x90;	// Enable, 16-bit
+#ifdef RAM_TEST
+	ram_test();
+#endif
+	t = upload_timer();
+	n = upload_image(&images[img]);
+	t = upload_timer() - t;
 
 	// Address bus A15-A8 pin (A14:/RFSH, A15:/WAIT)
 	ANSELD = 0x00;	// Disable analog function
@@ -282,12 +4341,46 @@ void main(void) {
 	WPUD6 = 1;		// Week pull up
 	TRISD6 = 1;		// Set as input
 
+#ifdef USE_Z80_INT
+	// Z80 /INT output pin, /M1 input pin
+	Z80_INT = 1;
+	Z80_INT_TRIS = 0;	// Set as output
+	Z80_M1_ANSEL = 0;	// Disable analog function
+	Z80_M1_TRIS = 1;	// Set as input
+#endif
+
 	// /WAIT (RD7) output pin
 	ANSELD7 = 0;	// Disable analog function
 	LATD7 = 1;		// WAIT
 	TRISD7 = 0;		// Set as output
 
-    printf("\r\nMEZ80RAM %2.3fMHz\r\n",NCO1INC * 30.5175781 / 1000000);
+#ifdef ROM_UPLOAD_DMA
+	printf("%s %ubytes %luus DMA\r\n", images[img].name, n, (unsigned long)t * UPLOAD_TIMER_US);
+#else
+	printf("%s %ubytes %luus CPU\r\n", images[img].name, n, (unsigned long)t * UPLOAD_TIMER_US);
+#endif
+
+	// Z80 IO devices
+	io_init();
+	uart_io_init();
+	clk_io_init();
+	tim_init();
+	blk_init();
+	blt_init();
+	cp_init();
+	snap_init();
+#ifdef IO_STATS
+	stat_init();
+#endif
+#ifdef IO_TRACE
+	trace_init();
+#endif
+#ifdef Z80_PROF
+	prof_init();
+#endif
+#ifdef USE_SD
+	disk_init();
+#endif
 
 	//========== CLC pin assign ===========
 	// 0,1,4,5 = Port A, C
@@ -353,6 +4446,11 @@ void main(void) {
 
 	CLCDATA = 0x0;		// Clear all CLC outs
 
+	// /IORQ (RA0) rising edge ends an IO read, armed per cycle by CLC_ISR
+	IOCAP0 = 1;			// Positive edge
+	IOCAN0 = 0;
+	IOCAF0 = 0;
+
 	// Unlock IVT
 	IVTLOCK = 0x55;
 	IVTLOCK = 0xAA;
@@ -366,24 +4464,58 @@ void main(void) {
 	IVTLOCK = 0xAA;
 	IVTLOCKbits.IVTLOCKED = 0x01;
 
+	// Interrupt priority: CLC3 and IOC (Z80 bus) high, UART and timers low
+	INTCON0bits.IPEN = 1;
+	CLC3IP = 1;
+	IOCIP = 1;
+	U3RXIP = 0;
+	U3TXIP = 0;
+	U3IP = 0;
+	TMR0IP = 0;
+	TMR4IP = 0;
+
 	// CLC VI enable
 	CLC3IF = 0;			// Clear the CLC3 interrupt flag
 	CLC3IE = 1;			// Enabling CLC3 interrupt
 
+	// UART3 VI enable
+	U3RXIE = 1;			// RX interrupt, TX is enabled on demand
+	U3ERRIE = 0;		// TXMTIE too, set for a baud rate change
+	U3IE = 1;
+
+	// Timer VI enable
+	TMR0IE = 1;
+	TMR4IE = 1;
+
 	// Z80 start
+	INTCON0bits.GIEL = 1;	// Low priority interrupt enable
 	GIE = 1;			// Global interrupt enable
+	if(cal)
+		clk_calibrate();
+#ifdef USE_SD
+	snap_boot();		// RAM from SNAPSHOT.BIN if it is valid
+#endif
+	if(console_req) {	// CONSOLE_KEY at boot
+		TASK_CLEAR(TASK_CONSOLE);
+		console();
+	}
 	LATE0 = 1;			// /BUSREQ=1
 	LATE1 = 1;			// Release reset
 
 
-	while(1); // All things come to those who wait
+	while(1) // All things come to those who wait
+		task_run();
 }
 
-const unsigned char rom[ROM_SIZE] = {
 // EMUBASIC based on GRANT's BASIC
 // IO port
 // ROM Image 0x0000-0x1fff
 // RAM Top 0x2000
+// EMUBASIC-FP: tools/fppatch.hex over it, arithmetic on the coprocessor
+//Z80 image table generated by tools/mkimage
+// 0:EMUBASIC emubasic.bin
+// 1:EMUBASIC-FP emubasic.bin fppatch.hex
+const unsigned char rom0[] = {
 // 0x0000
 	0xf3, 0x31, 0xf0, 0x20, 0xc3, 0x3c, 0x00, 0xff, 0xc3, 0x31, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff,
 	0xc3, 0x1b, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xc3, 0x2c, 0x00, 0xdb, 0x01, 0xcb, 0x47, 0x28,
@@ -929,3 +5061,504 @@ const unsigned char rom[ROM_SIZE] = {
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
+
+const unsigned char rom1[] = {
+// +0x0000
+	0x0b, 0xf3, 0x31, 0xf0, 0x20, 0xc3, 0x3c, 0x00, 0xff, 0xc3, 0x31, 0x00, 0xff, 0x80, 0x01, 0x00,
+	0x01, 0xc3, 0x1b, 0x83, 0x08, 0x00, 0x12, 0x2c, 0x00, 0xdb, 0x01, 0xcb, 0x47, 0x28, 0xfa, 0xdb,
+	0x00, 0xfe, 0x61, 0xd8, 0xfe, 0x7b, 0xd0, 0xe6, 0xdf, 0xc9, 0x80, 0x11, 0x00, 0x7f, 0xc9, 0xf5,
+	0xdb, 0x01, 0xcb, 0x4f, 0x28, 0xfa, 0xf1, 0xd3, 0x00, 0xc9, 0xc3, 0x3f, 0x00, 0xc3, 0x45, 0x00,
+	0xc3, 0xba, 0x00, 0xc3, 0x4c, 0x00, 0xfd, 0x08, 0x73, 0x10, 0x21, 0x45, 0x20, 0xf9, 0xc3, 0x8e,
+	0x1c, 0x11, 0x24, 0x03, 0x06, 0x63, 0x21, 0x45, 0x20, 0x1a, 0x77, 0x23, 0x13, 0x05, 0xc2, 0x5b,
+	0x00, 0xf9, 0xcd, 0x25, 0x05, 0xcd, 0xf3, 0x0a, 0x32, 0xef, 0x20, 0x32, 0x3e, 0x21, 0x21, 0xa2,
+	0x21, 0x23, 0x7c, 0xb5, 0xca, 0x82, 0x00, 0x7e, 0x47, 0x2f, 0x77, 0xbe, 0x70, 0xca, 0x73, 0x00,
+	0x2b, 0x11, 0xa1, 0x21, 0xcd, 0xbb, 0x06, 0xda, 0xc3, 0x00, 0x11, 0xce, 0xff, 0x22, 0xf4, 0x20,
+	0x19, 0x22, 0x9f, 0x20, 0xcd, 0x00, 0x05, 0x2a, 0x9f, 0x20, 0x11, 0xef, 0xff, 0x19, 0x11, 0x3e,
+	0x21, 0x7d, 0x93, 0x6f, 0x7c, 0x9a, 0x67, 0xe5, 0x21, 0xdb, 0x00, 0xcd, 0x91, 0x11, 0x05, 0xe1,
+	0xcd, 0x34, 0x18, 0x21, 0xcc, 0x80, 0x0a, 0x00, 0x53, 0x31, 0xab, 0x20, 0xcd, 0x25, 0x05, 0xc3,
+	0x3e, 0x04, 0x21, 0x12, 0x01, 0xcd, 0x91, 0x11, 0xc3, 0xc9, 0x00, 0x20, 0x42, 0x79, 0x74, 0x65,
+	0x73, 0x20, 0x66, 0x72, 0x65, 0x65, 0x0d, 0x0a, 0x00, 0x00, 0x5a, 0x38, 0x30, 0x20, 0x42, 0x41,
+	0x53, 0x49, 0x43, 0x20, 0x56, 0x65, 0x72, 0x20, 0x34, 0x2e, 0x37, 0x62, 0x0d, 0x0a, 0x43, 0x6f,
+	0x70, 0x79, 0x72, 0x69, 0x67, 0x68, 0x74, 0x20, 0x28, 0x43, 0x29, 0x20, 0x31, 0x39, 0x37, 0x38,
+// +0x0100
+	0x20, 0x62, 0x79, 0x20, 0x4d, 0x69, 0x63, 0x72, 0x6f, 0x73, 0x6f, 0x66, 0x74, 0x80, 0x37, 0x00,
+	0x2d, 0x4d, 0x65, 0x6d, 0x6f, 0x72, 0x79, 0x20, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6e, 0x6f, 0x74,
+	0x20, 0x65, 0x6e, 0x6f, 0x75, 0x67, 0x68, 0x0d, 0x0a, 0x54, 0x68, 0x65, 0x20, 0x73, 0x79, 0x73,
+	0x74, 0x65, 0x6d, 0x20, 0x69, 0x73, 0x20, 0x73, 0x74, 0x6f, 0x70, 0x70, 0x65, 0x64, 0x2e, 0x80,
+	0x32, 0x00, 0x7f, 0xa9, 0x16, 0x6d, 0x17, 0xbf, 0x16, 0x48, 0x20, 0x51, 0x10, 0xd6, 0x13, 0x7f,
+	0x10, 0x33, 0x19, 0x12, 0x1a, 0x4e, 0x15, 0x81, 0x19, 0x87, 0x1a, 0x8d, 0x1a, 0xee, 0x1a, 0x03,
+	0x1b, 0x2a, 0x14, 0x6e, 0x1b, 0x96, 0x20, 0x03, 0x13, 0x1b, 0x11, 0x9d, 0x13, 0x12, 0x13, 0x23,
+	0x13, 0x90, 0x1b, 0x23, 0x1c, 0x33, 0x13, 0x63, 0x13, 0x6d, 0x13, 0xc5, 0x4e, 0x44, 0xc6, 0x4f,
+	0x52, 0xce, 0x45, 0x58, 0x54, 0xc4, 0x41, 0x54, 0x41, 0xc9, 0x4e, 0x50, 0x55, 0x54, 0xc4, 0x49,
+	0x4d, 0xd2, 0x45, 0x41, 0x44, 0xcc, 0x45, 0x54, 0xc7, 0x4f, 0x54, 0x4f, 0xd2, 0x55, 0x4e, 0xc9,
+	0x46, 0xd2, 0x45, 0x53, 0x54, 0x4f, 0x52, 0x45, 0xc7, 0x4f, 0x53, 0x55, 0x42, 0xd2, 0x45, 0x54,
+	0x55, 0x52, 0x4e, 0xd2, 0x45, 0x4d, 0xd3, 0x54, 0x4f, 0x50, 0xcf, 0x55, 0x54, 0xcf, 0x4e, 0xce,
+	0x55, 0x4c, 0x4c, 0x7f, 0xd7, 0x41, 0x49, 0x54, 0xc4, 0x45, 0x46, 0xd0, 0x4f, 0x4b, 0x45, 0xc4,
+	0x4f, 0x4b, 0x45, 0xd3, 0x43, 0x52, 0x45, 0x45, 0x4e, 0xcc, 0x49, 0x4e, 0x45, 0x53, 0xc3, 0x4c,
+	0x53, 0xd7, 0x49, 0x44, 0x54, 0x48, 0xcd, 0x4f, 0x4e, 0x49, 0x54, 0x4f, 0x52, 0xd3, 0x45, 0x54,
+	0xd2, 0x45, 0x53, 0x45, 0x54, 0xd0, 0x52, 0x49, 0x4e, 0x54, 0xc3, 0x4f, 0x4e, 0x54, 0xcc, 0x49,
+// +0x0200
+	0x53, 0x54, 0xc3, 0x4c, 0x45, 0x41, 0x52, 0xc3, 0x4c, 0x4f, 0x41, 0x44, 0xc3, 0x53, 0x41, 0x56,
+	0x45, 0xce, 0x45, 0x57, 0xd4, 0x41, 0x42, 0x28, 0xd4, 0x4f, 0xc6, 0x4e, 0xd3, 0x50, 0x43, 0x28,
+	0xd4, 0x48, 0x45, 0x4e, 0xce, 0x4f, 0x54, 0xd3, 0x54, 0x45, 0x50, 0xab, 0xad, 0xaa, 0xaf, 0xde,
+	0xc1, 0x4e, 0x44, 0xcf, 0x52, 0xbe, 0xbd, 0xbc, 0xd3, 0x47, 0x4e, 0xc9, 0x4e, 0x54, 0xc1, 0x42,
+	0x53, 0xd5, 0x53, 0x52, 0x7f, 0xc6, 0x52, 0x45, 0xc9, 0x4e, 0x50, 0xd0, 0x4f, 0x53, 0xd3, 0x51,
+	0x52, 0xd2, 0x4e, 0x44, 0xcc, 0x4f, 0x47, 0xc5, 0x58, 0x50, 0xc3, 0x4f, 0x53, 0xd3, 0x49, 0x4e,
+	0xd4, 0x41, 0x4e, 0xc1, 0x54, 0x4e, 0xd0, 0x45, 0x45, 0x4b, 0xc4, 0x45, 0x45, 0x4b, 0xd0, 0x4f,
+	0x49, 0x4e, 0x54, 0xcc, 0x45, 0x4e, 0xd3, 0x54, 0x52, 0x24, 0xd6, 0x41, 0x4c, 0xc1, 0x53, 0x43,
+	0xc3, 0x48, 0x52, 0x24, 0xc8, 0x45, 0x58, 0x24, 0xc2, 0x49, 0x4e, 0x24, 0xcc, 0x45, 0x46, 0x54,
+	0x24, 0xd2, 0x49, 0x47, 0x48, 0x54, 0x24, 0xcd, 0x49, 0x44, 0x24, 0x80, 0x95, 0x08, 0x92, 0x07,
+	0x6d, 0x0c, 0xe2, 0x09, 0x74, 0x0b, 0xa9, 0x0e, 0xa3, 0x0b, 0xf9, 0x09, 0x9f, 0x09, 0x82, 0x09,
+	0x71, 0x0a, 0x5b, 0x08, 0x8e, 0x09, 0xbd, 0x09, 0xe4, 0x09, 0x93, 0x08, 0xe2, 0x13, 0x53, 0x0a,
+	0xd4, 0x08, 0xe8, 0x13, 0x87, 0x5f, 0x10, 0x31, 0x14, 0x79, 0x1b, 0xe4, 0x09, 0x5f, 0x1b, 0x52,
+	0x1b, 0x57, 0x1b, 0x8b, 0x1c, 0x99, 0x20, 0x9c, 0x20, 0x95, 0x0a, 0xc1, 0x08, 0x07, 0x07, 0x3c,
+	0x09, 0xe4, 0x09, 0xe4, 0x09, 0xff, 0x04, 0x79, 0x1b, 0x18, 0x79, 0x4f, 0x14, 0x7c, 0x8d, 0x15,
+	0x7c, 0xee, 0x15, 0x7f, 0x3c, 0x19, 0x50, 0x02, 0x0e, 0x46, 0x01, 0x0e, 0x4e, 0x46, 0x53, 0x4e,
+// +0x0300
+	0x52, 0x47, 0x4f, 0x44, 0x46, 0x43, 0x4f, 0x56, 0x4f, 0x4d, 0x55, 0x4c, 0x42, 0x53, 0x44, 0x44,
+	0x2f, 0x30, 0x49, 0x44, 0x54, 0x4d, 0x4f, 0x53, 0x4c, 0x53, 0x53, 0x54, 0x43, 0x4e, 0x55, 0x46,
+	0x4d, 0x4f, 0x48, 0x58, 0x42, 0x4e, 0x80, 0xe2, 0x02, 0x45, 0x12, 0x09, 0xd3, 0x00, 0xc9, 0xd6,
+	0x00, 0x6f, 0x7c, 0xde, 0x00, 0x67, 0x78, 0xde, 0x00, 0x47, 0x3e, 0x00, 0xc9, 0x00, 0x00, 0x00,
+	0x35, 0x4a, 0xca, 0x99, 0x39, 0x1c, 0x76, 0x98, 0x22, 0x95, 0xb3, 0x98, 0x0a, 0xdd, 0x47, 0x98,
+	0x53, 0xd1, 0x99, 0x99, 0x0a, 0x1a, 0x9f, 0x98, 0x65, 0xbc, 0xcd, 0x98, 0xd6, 0x77, 0x3e, 0x98,
+	0x52, 0xc7, 0x4f, 0x80, 0xdb, 0x00, 0xc9, 0x01, 0xff, 0x1c, 0x00, 0x00, 0x14, 0x00, 0x14, 0x00,
+	0x80, 0x01, 0x00, 0x05, 0xc3, 0x38, 0x06, 0xc3, 0x00, 0x00, 0x82, 0x03, 0x00, 0x13, 0xa2, 0x21,
+	0xfe, 0xff, 0x3f, 0x21, 0x20, 0x45, 0x72, 0x72, 0x6f, 0x72, 0x00, 0x20, 0x69, 0x6e, 0x20, 0x00,
+	0x4f, 0x6b, 0x80, 0x52, 0x02, 0x7f, 0x42, 0x72, 0x65, 0x61, 0x6b, 0x00, 0x21, 0x04, 0x00, 0x39,
+	0x7e, 0x23, 0xfe, 0x81, 0xc0, 0x4e, 0x23, 0x46, 0x23, 0xe5, 0x69, 0x60, 0x7a, 0xb3, 0xeb, 0xca,
+	0xb6, 0x03, 0xeb, 0xcd, 0xbb, 0x06, 0x01, 0x0d, 0x00, 0xe1, 0xc8, 0x09, 0xc3, 0xa0, 0x03, 0xcd,
+	0xd9, 0x03, 0xc5, 0xe3, 0xc1, 0xcd, 0xbb, 0x06, 0x7e, 0x02, 0xc8, 0x0b, 0x2b, 0xc3, 0xc5, 0x03,
+	0xe5, 0x2a, 0x1f, 0x21, 0x06, 0x00, 0x09, 0x09, 0x3e, 0xe5, 0x3e, 0xd0, 0x95, 0x6f, 0x3e, 0xff,
+	0x9c, 0xda, 0xe8, 0x03, 0x67, 0x39, 0xe1, 0xd8, 0x1e, 0x0c, 0xc3, 0x07, 0x04, 0x2a, 0x0e, 0x21,
+	0x22, 0xa1, 0x20, 0x1e, 0x02, 0x01, 0x1e, 0x14, 0x01, 0x1e, 0x00, 0x01, 0x1e, 0x12, 0x01, 0x1e,
+// +0x0400
+	0x22, 0x01, 0x1e, 0x0a, 0x01, 0x1e, 0x18, 0xcd, 0x25, 0x05, 0x32, 0x8a, 0x20, 0xcd, 0xe6, 0x0a,
+	0x21, 0xfa, 0x02, 0x57, 0x3e, 0x3f, 0x28, 0xcd, 0xcc, 0x06, 0x19, 0x7e, 0xcd, 0xcc, 0x06, 0xcd,
+	0x4b, 0x08, 0xcd, 0xcc, 0x06, 0x21, 0x84, 0x03, 0xcd, 0x91, 0x11, 0x2a, 0xa1, 0x20, 0x11, 0xfe,
+	0xff, 0xcd, 0xbb, 0x06, 0xca, 0x4c, 0x00, 0x7c, 0xa5, 0x3c, 0xc4, 0x2c, 0x18, 0x3e, 0xc1, 0xaf,
+	0x83, 0x35, 0x00, 0x00, 0x90, 0x80, 0x21, 0x00, 0x6d, 0x21, 0xff, 0xff, 0x22, 0xa1, 0x20, 0xcd,
+	0x38, 0x06, 0xda, 0x4b, 0x04, 0xcd, 0x4b, 0x08, 0x3c, 0x3d, 0xca, 0x4b, 0x04, 0xf5, 0xcd, 0x17,
+	0x09, 0xd5, 0xcd, 0x4f, 0x05, 0x47, 0xd1, 0xf1, 0xd2, 0x2b, 0x08, 0xd5, 0xc5, 0xaf, 0x32, 0x11,
+	0x21, 0xcd, 0x4b, 0x08, 0xb7, 0xf5, 0xcd, 0xdf, 0x04, 0xda, 0x84, 0x04, 0xf1, 0xf5, 0xca, 0xb8,
+	0x09, 0xb7, 0xc5, 0xd2, 0x9b, 0x04, 0xeb, 0x2a, 0x1b, 0x21, 0x1a, 0x02, 0x03, 0x13, 0xcd, 0xbb,
+	0x06, 0xc2, 0x8c, 0x04, 0x60, 0x69, 0x22, 0x1b, 0x21, 0xd1, 0xf1, 0xca, 0xc2, 0x04, 0x2a, 0x1b,
+	0x21, 0xe3, 0xc1, 0x09, 0xe5, 0xcd, 0xbf, 0x03, 0xe1, 0x22, 0x1b, 0x21, 0xeb, 0x74, 0xd1, 0x23,
+	0x23, 0x73, 0x23, 0x72, 0x23, 0x11, 0xa6, 0x81, 0x5f, 0x04, 0x35, 0xb7, 0xc2, 0xba, 0x04, 0xcd,
+	0x0b, 0x05, 0x23, 0xeb, 0x62, 0x6b, 0x7e, 0x23, 0xb6, 0xca, 0x4b, 0x04, 0x23, 0x23, 0x23, 0xaf,
+	0xbe, 0x23, 0xc2, 0xd3, 0x04, 0xeb, 0x73, 0x23, 0x72, 0xc3, 0xc7, 0x04, 0x2a, 0xa3, 0x20, 0x44,
+	0x4d, 0x7e, 0x23, 0xb6, 0x2b, 0xc8, 0x23, 0x23, 0x7e, 0x23, 0x66, 0x6f, 0xcd, 0xbb, 0x06, 0x60,
+	0x69, 0x80, 0x09, 0x00, 0x49, 0x3f, 0xc8, 0x3f, 0xd0, 0xc3, 0xe2, 0x04, 0xc0, 0x2a, 0xa3, 0x20,
+// +0x0500
+	0xaf, 0x77, 0x23, 0x77, 0x23, 0x22, 0x1b, 0x21, 0x2a, 0xa3, 0x20, 0x2b, 0x22, 0x13, 0x21, 0x2a,
+	0xf4, 0x20, 0x22, 0x08, 0x21, 0xaf, 0xcd, 0x5b, 0x08, 0x2a, 0x1b, 0x21, 0x22, 0x1d, 0x21, 0x22,
+	0x1f, 0x21, 0xc1, 0x2a, 0x9f, 0x20, 0xf9, 0x21, 0xf8, 0x20, 0x22, 0xf6, 0x20, 0xaf, 0x6f, 0x67,
+	0x22, 0x19, 0x21, 0x32, 0x10, 0x21, 0x22, 0x23, 0x21, 0xe5, 0xc5, 0x2a, 0x13, 0x21, 0xc9, 0x81,
+	0x2e, 0x01, 0x77, 0x3e, 0x20, 0xcd, 0xcc, 0x06, 0xc3, 0x93, 0x20, 0xaf, 0x32, 0xf3, 0x20, 0x0e,
+	0x05, 0x11, 0xa6, 0x20, 0x7e, 0xfe, 0x20, 0xca, 0xd7, 0x05, 0x47, 0xfe, 0x22, 0xca, 0xf7, 0x05,
+	0xb7, 0xca, 0xfe, 0x05, 0x3a, 0xf3, 0x20, 0xb7, 0x7e, 0xc2, 0xd7, 0x05, 0xfe, 0x3f, 0x3e, 0x9e,
+	0xca, 0xd7, 0x05, 0x7e, 0xfe, 0x30, 0xda, 0x82, 0x05, 0xfe, 0x3c, 0xda, 0xd7, 0x05, 0xd5, 0x11,
+	0x7b, 0x01, 0xc5, 0x01, 0xd3, 0x05, 0xc5, 0x06, 0x7f, 0x7e, 0xfe, 0x61, 0xda, 0x9b, 0x05, 0xfe,
+	0x7b, 0xd2, 0x9b, 0x05, 0xe6, 0x5f, 0x77, 0x4e, 0xeb, 0x23, 0xb6, 0xf2, 0x9d, 0x05, 0x04, 0x7e,
+	0xe6, 0x7f, 0xc8, 0xb9, 0xc2, 0x9d, 0x05, 0xeb, 0xe5, 0x13, 0x1a, 0xb7, 0xfa, 0xcf, 0x05, 0x4f,
+	0x78, 0xfe, 0x88, 0xc2, 0xbe, 0x05, 0xcd, 0x4b, 0x08, 0x2b, 0x23, 0x80, 0x32, 0x00, 0x2b, 0xc7,
+	0x05, 0xe6, 0x5f, 0xb9, 0xca, 0xad, 0x05, 0xe1, 0xc3, 0x9b, 0x05, 0x48, 0xf1, 0xeb, 0xc9, 0xeb,
+	0x79, 0xc1, 0xd1, 0x23, 0x12, 0x13, 0x0c, 0xd6, 0x3a, 0xca, 0xe5, 0x05, 0xfe, 0x49, 0xc2, 0xe8,
+	0x05, 0x32, 0xf3, 0x20, 0xd6, 0x54, 0xc2, 0x58, 0x05, 0x47, 0x7e, 0x80, 0x8b, 0x00, 0x23, 0xb8,
+	0xca, 0xd7, 0x05, 0x23, 0x12, 0x0c, 0x13, 0xc3, 0xee, 0x05, 0x21, 0xa5, 0x20, 0x12, 0x13, 0x12,
+// +0x0600
+	0x13, 0x12, 0xc9, 0x3a, 0x89, 0x20, 0xb7, 0x3e, 0x00, 0x32, 0x89, 0x20, 0xc2, 0x1b, 0x06, 0x05,
+	0xca, 0x38, 0x06, 0x80, 0xd3, 0x00, 0x04, 0x05, 0x2b, 0xca, 0x2f, 0x06, 0x80, 0x06, 0x02, 0x09,
+	0xc3, 0x41, 0x06, 0x05, 0x2b, 0xcd, 0xcc, 0x06, 0xc2, 0x41, 0x80, 0x18, 0x00, 0x17, 0xcd, 0xf3,
+	0x0a, 0xc3, 0x38, 0x06, 0x21, 0xa6, 0x20, 0x06, 0x01, 0xaf, 0x32, 0x89, 0x20, 0xcd, 0xf6, 0x06,
+	0x4f, 0xfe, 0x7f, 0xca, 0x07, 0x06, 0x80, 0x43, 0x00, 0x07, 0xca, 0x5a, 0x06, 0x3e, 0x00, 0xcd,
+	0xcc, 0x06, 0x80, 0x19, 0x00, 0x22, 0x79, 0xfe, 0x07, 0xca, 0x9e, 0x06, 0xfe, 0x03, 0xcc, 0xf3,
+	0x0a, 0x37, 0xc8, 0xfe, 0x0d, 0xca, 0xee, 0x0a, 0xfe, 0x15, 0xca, 0x32, 0x06, 0xfe, 0x40, 0xca,
+	0x2f, 0x06, 0xfe, 0x5f, 0xca, 0x27, 0x06, 0xfe, 0x08, 0x80, 0x05, 0x00, 0x0e, 0x12, 0xc2, 0x99,
+	0x06, 0xc5, 0xd5, 0xe5, 0x36, 0x00, 0xcd, 0x9d, 0x1c, 0x21, 0xa6, 0x20, 0x80, 0xe3, 0x05, 0x18,
+	0xd1, 0xc1, 0xc3, 0x41, 0x06, 0xfe, 0x20, 0xda, 0x41, 0x06, 0x78, 0xfe, 0x49, 0x3e, 0x07, 0xd2,
+	0xb3, 0x06, 0x79, 0x71, 0x32, 0x11, 0x21, 0x23, 0x04, 0x82, 0x8c, 0x00, 0x80, 0x9c, 0x00, 0x5c,
+	0x08, 0xc3, 0xad, 0x06, 0x7c, 0x92, 0xc0, 0x7d, 0x93, 0xc9, 0x7e, 0xe3, 0xbe, 0x23, 0xe3, 0xca,
+	0x4b, 0x08, 0xc3, 0xf3, 0x03, 0xf5, 0x3a, 0x8a, 0x20, 0xb7, 0xc2, 0xc6, 0x11, 0xf1, 0xc5, 0xf5,
+	0xfe, 0x20, 0xda, 0xf0, 0x06, 0x3a, 0x87, 0x20, 0x47, 0x3a, 0xf0, 0x20, 0x04, 0xca, 0xec, 0x06,
+	0x05, 0xb8, 0xcc, 0xf3, 0x0a, 0x3c, 0x32, 0xf0, 0x20, 0xf1, 0xc1, 0xcd, 0x88, 0x1c, 0xc9, 0xcd,
+	0x50, 0x1b, 0xe6, 0x7f, 0xfe, 0x0f, 0xc0, 0x3a, 0x8a, 0x20, 0x2f, 0x32, 0x8a, 0x20, 0xaf, 0xc9,
+// +0x0700
+	0xcd, 0x17, 0x09, 0xc0, 0xc1, 0xcd, 0xdf, 0x04, 0xc5, 0xcd, 0x5d, 0x07, 0xe1, 0x80, 0x6f, 0x03,
+	0x3b, 0x78, 0xb1, 0xca, 0x3e, 0x04, 0xcd, 0x66, 0x07, 0xcd, 0x76, 0x08, 0xc5, 0xcd, 0xf3, 0x0a,
+	0x5e, 0x23, 0x56, 0x23, 0xe5, 0xeb, 0xcd, 0x34, 0x18, 0x3e, 0x20, 0xe1, 0xcd, 0xcc, 0x06, 0x7e,
+	0xb7, 0x23, 0xca, 0x13, 0x07, 0xf2, 0x33, 0x07, 0xd6, 0x7f, 0x4f, 0x11, 0x7c, 0x01, 0x1a, 0x13,
+	0xb7, 0xf2, 0x45, 0x07, 0x0d, 0xc2, 0x45, 0x07, 0xe6, 0x7f, 0xcd, 0xcc, 0x06, 0x80, 0x0f, 0x00,
+	0x1d, 0x4f, 0x07, 0xc3, 0x36, 0x07, 0xe5, 0x2a, 0x8d, 0x20, 0x22, 0x8b, 0x20, 0xe1, 0xc9, 0xe5,
+	0xd5, 0x2a, 0x8b, 0x20, 0x11, 0xff, 0xff, 0xed, 0x5a, 0x22, 0x8b, 0x20, 0xd1, 0xe1, 0xf0, 0x83,
+	0x19, 0x00, 0x0b, 0xcd, 0x50, 0x1b, 0xfe, 0x03, 0xca, 0x89, 0x07, 0xe1, 0xc3, 0x66, 0x07, 0x82,
+	0x12, 0x00, 0x28, 0xc3, 0xbd, 0x00, 0x3e, 0x64, 0x32, 0x10, 0x21, 0xcd, 0xf9, 0x09, 0xc1, 0xe5,
+	0xcd, 0xe2, 0x09, 0x22, 0x0c, 0x21, 0x21, 0x02, 0x00, 0x39, 0xcd, 0xa0, 0x03, 0xd1, 0xc2, 0xc2,
+	0x07, 0x09, 0xd5, 0x2b, 0x56, 0x2b, 0x5e, 0x23, 0x23, 0xe5, 0x2a, 0x0c, 0x80, 0x33, 0x07, 0x0b,
+	0xe1, 0xc2, 0xa6, 0x07, 0xd1, 0xf9, 0xeb, 0x0e, 0x08, 0xcd, 0xd0, 0x03, 0x80, 0x13, 0x00, 0x23,
+	0xe3, 0xe5, 0x2a, 0xa1, 0x20, 0xe3, 0xcd, 0xbb, 0x0c, 0xcd, 0xc1, 0x06, 0xa6, 0xcd, 0xb8, 0x0c,
+	0xe5, 0xcd, 0xe6, 0x16, 0xe1, 0xc5, 0xd5, 0x01, 0x00, 0x81, 0x51, 0x5a, 0x7e, 0xfe, 0xab, 0x3e,
+	0x01, 0xc2, 0xfe, 0x07, 0x80, 0xd2, 0x03, 0x82, 0x1a, 0x00, 0x01, 0xcd, 0x9a, 0x80, 0x1d, 0x00,
+	0x1b, 0xf5, 0x33, 0xe5, 0x2a, 0x13, 0x21, 0xe3, 0x06, 0x81, 0xc5, 0x33, 0xcd, 0x76, 0x08, 0x22,
+// +0x0800
+	0x13, 0x21, 0x7e, 0xfe, 0x3a, 0xca, 0x2b, 0x08, 0xb7, 0xc2, 0xf3, 0x03, 0x23, 0x80, 0x53, 0x03,
+	0x7f, 0x9d, 0x08, 0x23, 0x5e, 0x23, 0x56, 0xeb, 0x22, 0xa1, 0x20, 0xeb, 0xcd, 0x4b, 0x08, 0x11,
+	0x0b, 0x08, 0xd5, 0xc8, 0xd6, 0x80, 0xda, 0xf9, 0x09, 0xfe, 0x25, 0xd2, 0xf3, 0x03, 0x07, 0x4f,
+	0x06, 0x00, 0xeb, 0x21, 0x9b, 0x02, 0x09, 0x4e, 0x23, 0x46, 0xc5, 0xeb, 0x23, 0x7e, 0xfe, 0x3a,
+	0xd0, 0xfe, 0x20, 0xca, 0x4b, 0x08, 0xfe, 0x30, 0x3f, 0x3c, 0x3d, 0xc9, 0xeb, 0x2a, 0xa3, 0x20,
+	0xca, 0x70, 0x08, 0xeb, 0xcd, 0x17, 0x09, 0xe5, 0xcd, 0xdf, 0x04, 0x60, 0x69, 0xd1, 0xd2, 0xb8,
+	0x09, 0x2b, 0x22, 0x21, 0x21, 0xeb, 0xc9, 0xdf, 0xc8, 0xd7, 0xfe, 0x1b, 0x28, 0x11, 0xfe, 0x03,
+	0x28, 0x0d, 0xfe, 0x13, 0xc0, 0xd7, 0xfe, 0x11, 0xc8, 0xfe, 0x03, 0x28, 0x07, 0x18, 0xf6, 0x3e,
+	0xff, 0x32, 0x92, 0x20, 0xc0, 0xf6, 0xc0, 0x22, 0x13, 0x21, 0x21, 0xf6, 0xff, 0xc1, 0x2a, 0xa1,
+	0x20, 0x0f, 0xf5, 0x7d, 0xa4, 0x3c, 0xca, 0xb0, 0x08, 0x22, 0x17, 0x21, 0x2a, 0x13, 0x21, 0x22,
+	0x19, 0x21, 0x83, 0x72, 0x04, 0x16, 0xf1, 0x21, 0x96, 0x03, 0xc2, 0x27, 0x04, 0xc3, 0x3e, 0x04,
+	0x2a, 0x19, 0x21, 0x7c, 0xb5, 0x1e, 0x20, 0xca, 0x07, 0x04, 0xeb, 0x2a, 0x17, 0x80, 0xdf, 0x04,
+	0x1e, 0xeb, 0xc9, 0xcd, 0x19, 0x14, 0xc0, 0x32, 0x86, 0x20, 0xc9, 0xe5, 0x2a, 0x8f, 0x20, 0x06,
+	0x00, 0x4f, 0x09, 0x22, 0x8f, 0x20, 0xe1, 0xc9, 0x7e, 0xfe, 0x41, 0xd8, 0xfe, 0x5b, 0x3f, 0xc9,
+	0x82, 0x01, 0x01, 0x2c, 0xcd, 0x9a, 0x16, 0xfa, 0x12, 0x09, 0x3a, 0x2c, 0x21, 0xfe, 0x90, 0xda,
+	0x42, 0x17, 0x01, 0x80, 0x90, 0x11, 0x00, 0x00, 0xe5, 0xcd, 0x15, 0x17, 0xe1, 0x51, 0xc8, 0x1e,
+// +0x0900
+	0x08, 0xc3, 0x07, 0x04, 0x2b, 0x11, 0x00, 0x00, 0xcd, 0x4b, 0x08, 0xd0, 0xe5, 0xf5, 0x21, 0x98,
+	0x19, 0x80, 0x9e, 0x08, 0x2a, 0xf3, 0x03, 0x62, 0x6b, 0x19, 0x29, 0x19, 0x29, 0xf1, 0xd6, 0x30,
+	0x5f, 0x16, 0x00, 0x19, 0xeb, 0xe1, 0xc3, 0x1b, 0x09, 0xca, 0x0f, 0x05, 0xcd, 0xf4, 0x08, 0x2b,
+	0xcd, 0x4b, 0x08, 0xe5, 0x2a, 0xf4, 0x20, 0xca, 0x5f, 0x09, 0xe1, 0xcd, 0xc1, 0x06, 0x2c, 0xd5,
+	0x83, 0x14, 0x00, 0x3a, 0xc2, 0xf3, 0x03, 0xe3, 0xeb, 0x7d, 0x93, 0x5f, 0x7c, 0x9a, 0x57, 0xda,
+	0xe8, 0x03, 0xe5, 0x2a, 0x1b, 0x21, 0x01, 0x28, 0x00, 0x09, 0xcd, 0xbb, 0x06, 0xd2, 0xe8, 0x03,
+	0xeb, 0x22, 0x9f, 0x20, 0xe1, 0x22, 0xf4, 0x20, 0xe1, 0xc3, 0x0f, 0x05, 0xca, 0x0b, 0x05, 0xcd,
+	0x0f, 0x05, 0x01, 0x0b, 0x08, 0xc3, 0x9e, 0x09, 0x0e, 0x03, 0xcd, 0xd0, 0x03, 0xc1, 0xe5, 0x81,
+	0xc8, 0x01, 0x0a, 0x3e, 0x8c, 0xf5, 0x33, 0xc5, 0xcd, 0x17, 0x09, 0xcd, 0xe4, 0x09, 0x80, 0x10,
+	0x00, 0x80, 0xf0, 0x01, 0x04, 0x23, 0xdc, 0xe2, 0x04, 0xd4, 0x80, 0x4a, 0x01, 0x63, 0x2b, 0xd8,
+	0x1e, 0x0e, 0xc3, 0x07, 0x04, 0xc0, 0x16, 0xff, 0xcd, 0x9c, 0x03, 0xf9, 0xfe, 0x8c, 0x1e, 0x04,
+	0xc2, 0x07, 0x04, 0xe1, 0x22, 0xa1, 0x20, 0x23, 0x7c, 0xb5, 0xc2, 0xdc, 0x09, 0x3a, 0x11, 0x21,
+	0xb7, 0xc2, 0x3d, 0x04, 0x21, 0x0b, 0x08, 0xe3, 0x3e, 0xe1, 0x01, 0x3a, 0x0e, 0x00, 0x06, 0x00,
+	0x79, 0x48, 0x47, 0x7e, 0xb7, 0xc8, 0xb8, 0xc8, 0x23, 0xfe, 0x22, 0xca, 0xe8, 0x09, 0xc3, 0xeb,
+	0x09, 0xcd, 0xae, 0x0e, 0xcd, 0xc1, 0x06, 0xb4, 0xd5, 0x3a, 0xf2, 0x20, 0xf5, 0xcd, 0xca, 0x0c,
+	0xf1, 0xe3, 0x22, 0x13, 0x21, 0x1f, 0xcd, 0xbd, 0x0c, 0xca, 0x4c, 0x0a, 0xe5, 0x2a, 0x29, 0x21,
+// +0x0a00
+	0xe5, 0x23, 0x80, 0xf8, 0x01, 0x01, 0x2a, 0xa3, 0x80, 0x78, 0x00, 0x04, 0xd2, 0x3b, 0x0a, 0x2a,
+	0x9f, 0x80, 0x09, 0x00, 0x05, 0xd1, 0xd2, 0x43, 0x0a, 0x21, 0x04, 0x80, 0x7b, 0x02, 0x1a, 0xd2,
+	0x43, 0x0a, 0x3e, 0xd1, 0xcd, 0xf2, 0x12, 0xeb, 0xcd, 0x2b, 0x11, 0xcd, 0xf2, 0x12, 0xe1, 0xcd,
+	0xf5, 0x16, 0xe1, 0xc9, 0xe5, 0xcd, 0xf2, 0x16, 0xd1, 0xe1, 0x80, 0x7f, 0x01, 0x22, 0x7e, 0x47,
+	0xfe, 0x8c, 0xca, 0x62, 0x0a, 0xcd, 0xc1, 0x06, 0x88, 0x2b, 0x4b, 0x0d, 0x78, 0xca, 0x33, 0x08,
+	0xcd, 0x18, 0x09, 0xfe, 0x2c, 0xc0, 0xc3, 0x63, 0x0a, 0xcd, 0xca, 0x0c, 0x7e, 0xfe, 0x88, 0xca,
+	0x7f, 0x80, 0x1d, 0x00, 0x01, 0xa9, 0x2b, 0x80, 0xad, 0x02, 0x0c, 0x9a, 0x16, 0xca, 0xe4, 0x09,
+	0xcd, 0x4b, 0x08, 0xda, 0x9f, 0x09, 0xc3, 0x32, 0x81, 0x3b, 0x01, 0x33, 0xca, 0xf3, 0x0a, 0xc8,
+	0xfe, 0xa5, 0xca, 0x26, 0x0b, 0xfe, 0xa8, 0xca, 0x26, 0x0b, 0xe5, 0xfe, 0x2c, 0xca, 0x0f, 0x0b,
+	0xfe, 0x3b, 0xca, 0x49, 0x0b, 0xc1, 0xcd, 0xca, 0x0c, 0xe5, 0x3a, 0xf2, 0x20, 0xb7, 0xc2, 0xdf,
+	0x0a, 0xcd, 0x3f, 0x18, 0xcd, 0x4f, 0x11, 0x36, 0x20, 0x2a, 0x29, 0x21, 0x34, 0x2a, 0x29, 0x21,
+	0x80, 0xed, 0x03, 0x27, 0x04, 0xca, 0xdb, 0x0a, 0x04, 0x3a, 0xf0, 0x20, 0x86, 0x3d, 0xb8, 0xd4,
+	0xf3, 0x0a, 0xcd, 0x94, 0x11, 0xaf, 0xc4, 0x94, 0x11, 0xe1, 0xc3, 0x91, 0x0a, 0x3a, 0xf0, 0x20,
+	0xb7, 0xc8, 0xc3, 0xf3, 0x0a, 0x36, 0x00, 0x21, 0xa5, 0x20, 0x3e, 0x0d, 0x80, 0x42, 0x04, 0x00,
+	0x0a, 0x81, 0xa7, 0x04, 0x11, 0xf0, 0x20, 0x3a, 0x86, 0x20, 0x3d, 0xc8, 0xf5, 0xaf, 0xcd, 0xcc,
+	0x06, 0xf1, 0xc3, 0x04, 0x0b, 0x3a, 0x88, 0x81, 0x33, 0x04, 0x80, 0x3f, 0x00, 0x25, 0xd2, 0x49,
+// +0x0b00
+	0x0b, 0xd6, 0x0e, 0xd2, 0x1d, 0x0b, 0x2f, 0xc3, 0x3e, 0x0b, 0xf5, 0xcd, 0x16, 0x14, 0xcd, 0xc1,
+	0x06, 0x29, 0x2b, 0xf1, 0xd6, 0xa8, 0xe5, 0xca, 0x39, 0x0b, 0x3a, 0xf0, 0x20, 0x2f, 0x83, 0xd2,
+	0x49, 0x0b, 0x3c, 0x47, 0x81, 0xf9, 0x05, 0x19, 0x05, 0xc2, 0x42, 0x0b, 0xe1, 0xcd, 0x4b, 0x08,
+	0xc3, 0x98, 0x0a, 0x3f, 0x52, 0x65, 0x64, 0x6f, 0x20, 0x66, 0x72, 0x6f, 0x6d, 0x20, 0x73, 0x74,
+	0x61, 0x72, 0x80, 0x52, 0x0a, 0x0a, 0x3a, 0x12, 0x21, 0xb7, 0xc2, 0xed, 0x03, 0xc1, 0x21, 0x50,
+	0x0b, 0x80, 0xa8, 0x0a, 0x3d, 0x3e, 0x05, 0xcd, 0xfc, 0x10, 0x7e, 0xfe, 0x22, 0x3e, 0x00, 0x32,
+	0x8a, 0x20, 0xc2, 0x8e, 0x0b, 0xcd, 0x50, 0x11, 0xcd, 0xc1, 0x06, 0x3b, 0xe5, 0xcd, 0x94, 0x11,
+	0x3e, 0xe5, 0xcd, 0x42, 0x05, 0xc1, 0xda, 0x9a, 0x08, 0x23, 0x7e, 0xb7, 0x2b, 0xc5, 0xca, 0xe1,
+	0x09, 0x36, 0x2c, 0xc3, 0xa8, 0x0b, 0xe5, 0x2a, 0x21, 0x21, 0xf6, 0xaf, 0x32, 0x12, 0x21, 0xe3,
+	0xc3, 0xb4, 0x0b, 0x80, 0x62, 0x02, 0x0a, 0xcd, 0xae, 0x0e, 0xe3, 0xd5, 0x7e, 0xfe, 0x2c, 0xca,
+	0xdc, 0x0b, 0x81, 0x5c, 0x00, 0x01, 0x49, 0x0c, 0x81, 0x84, 0x06, 0x03, 0xcd, 0x42, 0x05, 0xd1,
+	0x88, 0x3d, 0x00, 0x80, 0xdb, 0x01, 0x07, 0xb7, 0xca, 0x06, 0x0c, 0xcd, 0x4b, 0x08, 0x57, 0x80,
+	0x89, 0x06, 0x00, 0xfa, 0x81, 0x2e, 0x00, 0x14, 0x57, 0xca, 0xf7, 0x0b, 0x16, 0x3a, 0x06, 0x2c,
+	0x2b, 0xcd, 0x53, 0x11, 0xeb, 0x21, 0x11, 0x0c, 0xe3, 0xd5, 0xc3, 0x14, 0x0a, 0x80, 0x15, 0x03,
+	0x06, 0xa1, 0x17, 0xe3, 0xcd, 0xf2, 0x16, 0xe1, 0x81, 0x80, 0x01, 0x07, 0x1d, 0x0c, 0xfe, 0x2c,
+	0xc2, 0x63, 0x0b, 0xe3, 0x81, 0xc8, 0x02, 0x02, 0xb0, 0x0b, 0xd1, 0x80, 0x39, 0x00, 0x25, 0xeb,
+// +0x0c00
+	0xc2, 0x71, 0x08, 0xd5, 0xb6, 0x21, 0x38, 0x0c, 0xc4, 0x91, 0x11, 0xe1, 0xc9, 0x3f, 0x45, 0x78,
+	0x74, 0x72, 0x61, 0x20, 0x69, 0x67, 0x6e, 0x6f, 0x72, 0x65, 0x64, 0x0d, 0x0a, 0x00, 0xcd, 0xe2,
+	0x09, 0xb7, 0xc2, 0x62, 0x0c, 0x80, 0x35, 0x04, 0x04, 0x1e, 0x06, 0xca, 0x07, 0x04, 0x82, 0x37,
+	0x04, 0x01, 0x0e, 0x21, 0x80, 0x37, 0x04, 0x25, 0xfe, 0x83, 0xc2, 0x49, 0x0c, 0xc3, 0xdc, 0x0b,
+	0x11, 0x00, 0x00, 0xc4, 0xae, 0x0e, 0x22, 0x13, 0x21, 0xcd, 0x9c, 0x03, 0xc2, 0xf9, 0x03, 0xf9,
+	0xd5, 0x7e, 0x23, 0xf5, 0xd5, 0xcd, 0xd8, 0x16, 0xe3, 0xe5, 0xcd, 0x45, 0x14, 0xe1, 0x80, 0x7e,
+	0x00, 0x02, 0xcd, 0xe9, 0x16, 0x81, 0x87, 0x03, 0x07, 0xc1, 0x90, 0xcd, 0xe9, 0x16, 0xca, 0xa8,
+	0x0c, 0x80, 0x79, 0x04, 0x06, 0x69, 0x60, 0xc3, 0x07, 0x08, 0xf9, 0x2a, 0x80, 0x9b, 0x04, 0x03,
+	0x2c, 0xc2, 0x0b, 0x08, 0x80, 0xac, 0x00, 0x44, 0x70, 0x0c, 0xcd, 0xca, 0x0c, 0xf6, 0x37, 0x3a,
+	0xf2, 0x20, 0x8f, 0xb7, 0xe8, 0xc3, 0x05, 0x04, 0xcd, 0xc1, 0x06, 0x28, 0x2b, 0x16, 0x00, 0xd5,
+	0x0e, 0x01, 0xcd, 0xd0, 0x03, 0xcd, 0x41, 0x0d, 0x22, 0x15, 0x21, 0x2a, 0x15, 0x21, 0xc1, 0x78,
+	0xfe, 0x78, 0xd4, 0xbb, 0x0c, 0x7e, 0x16, 0x00, 0xd6, 0xb3, 0xda, 0x02, 0x0d, 0xfe, 0x03, 0xd2,
+	0x02, 0x0d, 0xfe, 0x01, 0x17, 0xaa, 0xba, 0x57, 0xda, 0xf3, 0x03, 0x22, 0x0a, 0x80, 0x89, 0x08,
+	0x36, 0xc3, 0xe6, 0x0c, 0x7a, 0xb7, 0xc2, 0x29, 0x0e, 0x7e, 0x22, 0x0a, 0x21, 0xd6, 0xac, 0xd8,
+	0xfe, 0x07, 0xd0, 0x5f, 0x3a, 0xf2, 0x20, 0x3d, 0xb3, 0x7b, 0xca, 0x87, 0x12, 0x07, 0x83, 0x5f,
+	0x21, 0xe5, 0x02, 0x19, 0x78, 0x56, 0xba, 0xd0, 0x23, 0xcd, 0xbb, 0x0c, 0xc5, 0x01, 0xd9, 0x0c,
+// +0x0d00
+	0xc5, 0x43, 0x4a, 0xcd, 0xcb, 0x16, 0x58, 0x51, 0x80, 0x22, 0x06, 0x1f, 0xc5, 0x2a, 0x0a, 0x21,
+	0xc3, 0xcd, 0x0c, 0xaf, 0x32, 0xf2, 0x20, 0xcd, 0x4b, 0x08, 0x1e, 0x24, 0xca, 0x07, 0x04, 0xda,
+	0xa1, 0x17, 0xcd, 0xe9, 0x08, 0xd2, 0xa8, 0x0d, 0xfe, 0x26, 0x20, 0x12, 0x80, 0xf8, 0x00, 0x32,
+	0x48, 0xca, 0xe5, 0x1b, 0xfe, 0x42, 0xca, 0x55, 0x1c, 0x1e, 0x02, 0xca, 0x07, 0x04, 0xfe, 0xac,
+	0xca, 0x41, 0x0d, 0xfe, 0x2e, 0xca, 0xa1, 0x17, 0xfe, 0xad, 0xca, 0x97, 0x0d, 0xfe, 0x22, 0xca,
+	0x50, 0x11, 0xfe, 0xaa, 0xca, 0x89, 0x0e, 0xfe, 0xa7, 0xca, 0xb4, 0x10, 0xd6, 0xb6, 0xd2, 0xb9,
+	0x0d, 0xcd, 0xc6, 0x80, 0xbd, 0x05, 0x1a, 0x29, 0xc9, 0x16, 0x7d, 0xcd, 0xcd, 0x0c, 0x2a, 0x15,
+	0x21, 0xe5, 0xcd, 0xc3, 0x16, 0xcd, 0xbb, 0x0c, 0xe1, 0xc9, 0xcd, 0xae, 0x0e, 0xe5, 0xeb, 0x22,
+	0x29, 0x21, 0x80, 0xd4, 0x01, 0x11, 0xcc, 0xd8, 0x16, 0xe1, 0xc9, 0x06, 0x00, 0x07, 0x4f, 0xc5,
+	0xcd, 0x4b, 0x08, 0x79, 0xfe, 0x31, 0xda, 0xe0, 0x83, 0x38, 0x00, 0x36, 0x2c, 0xcd, 0xbc, 0x0c,
+	0xeb, 0x2a, 0x29, 0x21, 0xe3, 0xe5, 0xeb, 0xcd, 0x19, 0x14, 0xeb, 0xe3, 0xc3, 0xe8, 0x0d, 0xcd,
+	0x8f, 0x0d, 0xe3, 0x11, 0xa3, 0x0d, 0xd5, 0x01, 0x44, 0x01, 0x09, 0x4e, 0x23, 0x66, 0x69, 0xe9,
+	0x15, 0xfe, 0xad, 0xc8, 0xfe, 0x2d, 0xc8, 0x14, 0xfe, 0x2b, 0xc8, 0xfe, 0xac, 0xc8, 0x2b, 0xc9,
+	0xf6, 0xaf, 0xf5, 0x80, 0x85, 0x03, 0x0a, 0xfd, 0x08, 0xf1, 0xeb, 0xc1, 0xe3, 0xeb, 0xcd, 0xdb,
+	0x16, 0xf5, 0x80, 0x0c, 0x00, 0x35, 0xc1, 0x79, 0x21, 0x72, 0x10, 0xc2, 0x24, 0x0e, 0xa3, 0x4f,
+	0x78, 0xa2, 0xe9, 0xb3, 0x4f, 0x78, 0xb2, 0xe9, 0x21, 0x3b, 0x0e, 0x3a, 0xf2, 0x20, 0x1f, 0x7a,
+// +0x0e00
+	0x17, 0x5f, 0x16, 0x64, 0x78, 0xba, 0xd0, 0xc3, 0x2a, 0x0d, 0x3d, 0x0e, 0x79, 0xb7, 0x1f, 0xc1,
+	0xd1, 0xf5, 0xcd, 0xbd, 0x0c, 0x21, 0x7f, 0x0e, 0xe5, 0xca, 0x15, 0x17, 0x80, 0x0c, 0x01, 0x3c,
+	0xd5, 0xcd, 0xd4, 0x12, 0x7e, 0x23, 0x23, 0x4e, 0x23, 0x46, 0xd1, 0xc5, 0xf5, 0xcd, 0xd8, 0x12,
+	0xcd, 0xe9, 0x16, 0xf1, 0x57, 0xe1, 0x7b, 0xb2, 0xc8, 0x7a, 0xd6, 0x01, 0xd8, 0xaf, 0xbb, 0x3c,
+	0xd0, 0x15, 0x1d, 0x0a, 0xbe, 0x23, 0x03, 0xca, 0x67, 0x0e, 0x3f, 0xc3, 0xa5, 0x16, 0x3c, 0x8f,
+	0xc1, 0xa0, 0xc6, 0xff, 0x9f, 0xc3, 0xac, 0x16, 0x16, 0x5a, 0xcd, 0xcd, 0x0c, 0x82, 0x8a, 0x00,
+	0x0b, 0x7b, 0x2f, 0x4f, 0x7a, 0x2f, 0xcd, 0x72, 0x10, 0xc1, 0xc3, 0xd9, 0x0c, 0x80, 0x82, 0x02,
+	0x00, 0xc8, 0x80, 0xdb, 0x00, 0x11, 0x01, 0xa0, 0x0e, 0xc5, 0xf6, 0xaf, 0x32, 0xf1, 0x20, 0x46,
+	0xcd, 0xe9, 0x08, 0xda, 0xf3, 0x03, 0xaf, 0x4f, 0x82, 0x79, 0x01, 0x02, 0xda, 0xca, 0x0e, 0x80,
+	0x11, 0x00, 0x02, 0xd7, 0x0e, 0x4f, 0x80, 0x0d, 0x00, 0x00, 0xcb, 0x80, 0x0d, 0x00, 0x0d, 0xd2,
+	0xcb, 0x0e, 0xd6, 0x24, 0xc2, 0xe6, 0x0e, 0x3c, 0x32, 0xf2, 0x20, 0x0f, 0x81, 0x80, 0x18, 0x00,
+	0x18, 0x3a, 0x10, 0x21, 0x3d, 0xca, 0x93, 0x0f, 0xf2, 0xf6, 0x0e, 0x7e, 0xd6, 0x28, 0xca, 0x6b,
+	0x0f, 0xaf, 0x32, 0x10, 0x21, 0xe5, 0x50, 0x59, 0x2a, 0x23, 0x80, 0xcc, 0x04, 0x08, 0x11, 0x25,
+	0x21, 0xca, 0xdb, 0x15, 0x2a, 0x1d, 0x21, 0x80, 0x84, 0x0a, 0x80, 0xe0, 0x0a, 0x1a, 0x29, 0x0f,
+	0x79, 0x96, 0x23, 0xc2, 0x1e, 0x0f, 0x78, 0x96, 0x23, 0xca, 0x5d, 0x0f, 0x23, 0x23, 0x23, 0x23,
+	0xc3, 0x10, 0x0f, 0xe1, 0xe3, 0xd5, 0x11, 0xab, 0x0d, 0x80, 0x05, 0x05, 0x0c, 0xca, 0x60, 0x0f,
+// +0x0f00
+	0xe3, 0xe5, 0xc5, 0x01, 0x06, 0x00, 0x2a, 0x1f, 0x21, 0xe5, 0x80, 0xa7, 0x07, 0x80, 0x9c, 0x0a,
+	0x09, 0x1f, 0x21, 0x60, 0x69, 0x22, 0x1d, 0x21, 0x2b, 0x36, 0x00, 0x80, 0xc2, 0x0a, 0x02, 0x4f,
+	0x0f, 0xd1, 0x80, 0xa6, 0x0a, 0x20, 0xeb, 0xe1, 0xc9, 0x32, 0x2c, 0x21, 0x21, 0x8f, 0x03, 0x22,
+	0x29, 0x21, 0xe1, 0xc9, 0xe5, 0x2a, 0xf1, 0x20, 0xe3, 0x57, 0xd5, 0xc5, 0xcd, 0xf1, 0x08, 0xc1,
+	0xf1, 0xeb, 0xe3, 0xe5, 0xeb, 0x3c, 0x57, 0x80, 0xc5, 0x03, 0x01, 0x71, 0x0f, 0x80, 0xf2, 0x01,
+	0x15, 0x22, 0x15, 0x21, 0xe1, 0x22, 0xf1, 0x20, 0x1e, 0x00, 0xd5, 0x11, 0xe5, 0xf5, 0x2a, 0x1d,
+	0x21, 0x3e, 0x19, 0xeb, 0x2a, 0x1f, 0x21, 0x80, 0xec, 0x0b, 0x0a, 0xca, 0xcb, 0x0f, 0x7e, 0xb9,
+	0x23, 0xc2, 0xad, 0x0f, 0x7e, 0xb8, 0x80, 0x54, 0x03, 0x3c, 0x23, 0xc2, 0x99, 0x0f, 0x3a, 0xf1,
+	0x20, 0xb7, 0xc2, 0xfc, 0x03, 0xf1, 0x44, 0x4d, 0xca, 0xdb, 0x15, 0x96, 0xca, 0x29, 0x10, 0x1e,
+	0x10, 0xc3, 0x07, 0x04, 0x11, 0x04, 0x00, 0xf1, 0xca, 0x12, 0x09, 0x71, 0x23, 0x70, 0x23, 0x4f,
+	0xcd, 0xd0, 0x03, 0x23, 0x23, 0x22, 0x0a, 0x21, 0x71, 0x23, 0x3a, 0xf1, 0x20, 0x17, 0x79, 0x01,
+	0x0b, 0x00, 0xd2, 0xee, 0x0f, 0xc1, 0x03, 0x80, 0x1c, 0x00, 0x12, 0xf5, 0xe5, 0xcd, 0x86, 0x17,
+	0xeb, 0xe1, 0xf1, 0x3d, 0xc2, 0xe6, 0x0f, 0xf5, 0x42, 0x4b, 0xeb, 0x19, 0xda, 0xe8, 0x80, 0x47,
+	0x0c, 0x01, 0x22, 0x1f, 0x84, 0xbd, 0x00, 0x0d, 0x0c, 0x10, 0x03, 0x57, 0x2a, 0x0a, 0x21, 0x5e,
+	0xeb, 0x29, 0x09, 0xeb, 0x2b, 0x2b, 0x80, 0xc8, 0x00, 0x09, 0xf1, 0xda, 0x4d, 0x10, 0x47, 0x4f,
+	0x7e, 0x23, 0x16, 0xe1, 0x80, 0x81, 0x00, 0x01, 0xe3, 0xf5, 0x80, 0x01, 0x06, 0x01, 0xc6, 0x0f,
+// +0x1000
+	0x80, 0x48, 0x00, 0x11, 0xd1, 0x19, 0xf1, 0x3d, 0x44, 0x4d, 0xc2, 0x2e, 0x10, 0x29, 0x29, 0xc1,
+	0x09, 0xeb, 0x2a, 0x15, 0x21, 0xc9, 0x80, 0xb6, 0x00, 0x03, 0x21, 0x00, 0x00, 0x39, 0x81, 0x7d,
+	0x04, 0x33, 0x6d, 0x10, 0xcd, 0xd4, 0x12, 0xcd, 0xd4, 0x11, 0x2a, 0x9f, 0x20, 0xeb, 0x2a, 0x08,
+	0x21, 0x7d, 0x93, 0x4f, 0x7c, 0x9a, 0x41, 0x50, 0x1e, 0x00, 0x21, 0xf2, 0x20, 0x73, 0x06, 0x90,
+	0xc3, 0xb1, 0x16, 0x3a, 0xf0, 0x20, 0x47, 0xaf, 0xc3, 0x73, 0x10, 0xcd, 0x0a, 0x11, 0xcd, 0xfc,
+	0x10, 0x01, 0xe2, 0x09, 0xc5, 0xd5, 0x80, 0xcc, 0x03, 0x81, 0xee, 0x02, 0x80, 0xec, 0x08, 0x00,
+	0xe1, 0x82, 0xce, 0x08, 0x00, 0x29, 0x80, 0xab, 0x06, 0x13, 0x44, 0x4d, 0xe3, 0x71, 0x23, 0x70,
+	0xc3, 0x49, 0x11, 0xcd, 0x0a, 0x11, 0xd5, 0xcd, 0x8f, 0x0d, 0xcd, 0xbb, 0x0c, 0xe3, 0x80, 0x90,
+	0x00, 0x04, 0x7a, 0xb3, 0xca, 0xff, 0x03, 0x80, 0xd4, 0x0b, 0x13, 0xe5, 0x2a, 0x23, 0x21, 0xe3,
+	0x22, 0x23, 0x21, 0x2a, 0x27, 0x21, 0xe5, 0x2a, 0x25, 0x21, 0xe5, 0x21, 0x25, 0x21, 0xd5, 0x81,
+	0x55, 0x04, 0x00, 0xb8, 0x81, 0x47, 0x02, 0x0d, 0xc2, 0xf3, 0x03, 0xe1, 0x22, 0x25, 0x21, 0xe1,
+	0x22, 0x27, 0x21, 0xe1, 0x22, 0x23, 0x81, 0x91, 0x01, 0x81, 0x31, 0x07, 0x05, 0xe1, 0xc0, 0x1e,
+	0x16, 0xc3, 0x07, 0x80, 0x44, 0x04, 0x0c, 0xa7, 0x3e, 0x80, 0x32, 0x10, 0x21, 0xb6, 0x47, 0xcd,
+	0xb3, 0x0e, 0xc3, 0xbb, 0x81, 0x8d, 0x02, 0x81, 0x64, 0x06, 0x0d, 0xcd, 0xd4, 0x12, 0x01, 0x2f,
+	0x13, 0xc5, 0x7e, 0x23, 0x23, 0xe5, 0xcd, 0xaa, 0x11, 0x80, 0x1f, 0x0a, 0x11, 0xcd, 0x43, 0x11,
+	0xe5, 0x6f, 0xcd, 0xc7, 0x12, 0xd1, 0xc9, 0xcd, 0xaa, 0x11, 0x21, 0x04, 0x21, 0xe5, 0x77, 0x81,
+// +0x1100
+	0x97, 0x0c, 0x2e, 0xe1, 0xc9, 0x2b, 0x06, 0x22, 0x50, 0xe5, 0x0e, 0xff, 0x23, 0x7e, 0x0c, 0xb7,
+	0xca, 0x65, 0x11, 0xba, 0xca, 0x65, 0x11, 0xb8, 0xc2, 0x56, 0x11, 0xfe, 0x22, 0xcc, 0x4b, 0x08,
+	0xe3, 0x23, 0xeb, 0x79, 0xcd, 0x43, 0x11, 0x11, 0x04, 0x21, 0x2a, 0xf6, 0x20, 0x22, 0x29, 0x21,
+	0x3e, 0x01, 0x80, 0xc1, 0x02, 0x10, 0xf5, 0x16, 0xcd, 0xbb, 0x06, 0x22, 0xf6, 0x20, 0xe1, 0x7e,
+	0xc0, 0x1e, 0x1e, 0xc3, 0x07, 0x04, 0x23, 0x82, 0x70, 0x00, 0x05, 0xcd, 0xe9, 0x16, 0x1c, 0x1d,
+	0xc8, 0x80, 0xa4, 0x06, 0x0c, 0xfe, 0x0d, 0xcc, 0xfd, 0x0a, 0x03, 0xc3, 0x9b, 0x11, 0xb7, 0x0e,
+	0xf1, 0xf5, 0x83, 0x48, 0x01, 0x05, 0x2f, 0x4f, 0x06, 0xff, 0x09, 0x23, 0x80, 0x97, 0x08, 0x14,
+	0xc8, 0x11, 0x22, 0x08, 0x21, 0x23, 0xeb, 0xf1, 0xc9, 0xf1, 0x1e, 0x1a, 0xca, 0x07, 0x04, 0xbf,
+	0xf5, 0x01, 0xac, 0x11, 0xc5, 0x82, 0xc2, 0x0c, 0x0e, 0x21, 0x00, 0x00, 0xe5, 0x2a, 0x9f, 0x20,
+	0xe5, 0x21, 0xf8, 0x20, 0xeb, 0x2a, 0xf6, 0x20, 0x81, 0x37, 0x0e, 0x08, 0xe5, 0x11, 0xc2, 0x39,
+	0x12, 0x2a, 0x1b, 0x21, 0xeb, 0x80, 0xee, 0x02, 0x80, 0x5c, 0x02, 0x00, 0x0c, 0x80, 0xac, 0x03,
+	0x07, 0xb7, 0xcd, 0x3c, 0x12, 0xc3, 0xf6, 0x11, 0xc1, 0x85, 0x72, 0x02, 0x00, 0x62, 0x80, 0x80,
+	0x00, 0x0b, 0x7b, 0xe5, 0x09, 0xb7, 0xf2, 0x0b, 0x12, 0x22, 0x0a, 0x21, 0xe1, 0x4e, 0x80, 0x52,
+	0x0e, 0x03, 0x23, 0xeb, 0x2a, 0x0a, 0x84, 0x35, 0x00, 0x06, 0x01, 0x2b, 0x12, 0xc5, 0xf6, 0x80,
+	0x7e, 0x81, 0x24, 0x08, 0x07, 0x23, 0xf0, 0xb7, 0xc8, 0x44, 0x4d, 0x2a, 0x08, 0x80, 0x3b, 0x03,
+	0x26, 0x60, 0x69, 0xd8, 0xe1, 0xe3, 0xcd, 0xbb, 0x06, 0xe3, 0xe5, 0x60, 0x69, 0xd0, 0xc1, 0xf1,
+// +0x1200
+	0xf1, 0xe5, 0xd5, 0xc5, 0xc9, 0xd1, 0xe1, 0x7d, 0xb4, 0xc8, 0x2b, 0x46, 0x2b, 0x4e, 0xe5, 0x2b,
+	0x2b, 0x6e, 0x26, 0x00, 0x09, 0x50, 0x59, 0x2b, 0x82, 0x2f, 0x00, 0x0c, 0xc2, 0x03, 0xe1, 0x71,
+	0x23, 0x70, 0x69, 0x60, 0x2b, 0xc3, 0xd7, 0x11, 0xc5, 0x80, 0x74, 0x08, 0x08, 0xe3, 0xcd, 0x41,
+	0x0d, 0xe3, 0xcd, 0xbc, 0x0c, 0x7e, 0x81, 0x81, 0x08, 0x25, 0x86, 0x1e, 0x1c, 0xda, 0x07, 0x04,
+	0xcd, 0x40, 0x11, 0xd1, 0xcd, 0xd8, 0x12, 0xe3, 0xcd, 0xd7, 0x12, 0xe5, 0x2a, 0x06, 0x21, 0xeb,
+	0xcd, 0xbe, 0x12, 0xcd, 0xbe, 0x12, 0x21, 0xd6, 0x0c, 0xe3, 0xe5, 0xc3, 0x71, 0x11, 0xe1, 0xe3,
+	0x82, 0x6b, 0x04, 0x11, 0x6f, 0x2c, 0x2d, 0xc8, 0x0a, 0x12, 0x03, 0x13, 0xc3, 0xc8, 0x12, 0xcd,
+	0xbc, 0x0c, 0x2a, 0x29, 0x21, 0xeb, 0x80, 0x9c, 0x08, 0x05, 0xc0, 0xd5, 0x50, 0x59, 0x1b, 0x4e,
+	0x82, 0x9a, 0x00, 0x0c, 0xc2, 0xf0, 0x12, 0x47, 0x09, 0x22, 0x08, 0x21, 0xe1, 0xc9, 0x2a, 0xf6,
+	0x20, 0x80, 0x8e, 0x00, 0x17, 0x2b, 0x2b, 0xcd, 0xbb, 0x06, 0xc0, 0x22, 0xf6, 0x20, 0xc9, 0x01,
+	0x82, 0x10, 0xc5, 0xcd, 0xd1, 0x12, 0xaf, 0x57, 0x32, 0xf2, 0x20, 0x7e, 0xb7, 0x82, 0x0f, 0x00,
+	0x04, 0x07, 0x13, 0xca, 0x12, 0x09, 0x81, 0xdf, 0x00, 0x36, 0x1a, 0xc9, 0x3e, 0x01, 0xcd, 0x40,
+	0x11, 0xcd, 0x1c, 0x14, 0x2a, 0x06, 0x21, 0x73, 0xc1, 0xc3, 0x71, 0x11, 0xcd, 0xcc, 0x13, 0xaf,
+	0xe3, 0x4f, 0xe5, 0x7e, 0xb8, 0xda, 0x41, 0x13, 0x78, 0x11, 0x0e, 0x00, 0xc5, 0xcd, 0xaa, 0x11,
+	0xc1, 0xe1, 0xe5, 0x23, 0x23, 0x46, 0x23, 0x66, 0x68, 0x06, 0x00, 0x09, 0x44, 0x4d, 0xcd, 0x43,
+	0x11, 0x81, 0x1e, 0x02, 0x02, 0xcd, 0xd8, 0x12, 0x82, 0x30, 0x00, 0x18, 0xd1, 0xd5, 0x1a, 0x90,
+// +0x1300
+	0xc3, 0x37, 0x13, 0xeb, 0x7e, 0xcd, 0xd1, 0x13, 0x04, 0x05, 0xca, 0x12, 0x09, 0xc5, 0x1e, 0xff,
+	0xfe, 0x29, 0xca, 0x86, 0x13, 0x81, 0xb5, 0x05, 0x00, 0x19, 0x81, 0x5c, 0x08, 0x12, 0xf1, 0xe3,
+	0x01, 0x39, 0x13, 0xc5, 0x3d, 0xbe, 0x06, 0x00, 0xd0, 0x4f, 0x7e, 0x91, 0xbb, 0x47, 0xd8, 0x43,
+	0xc9, 0x80, 0x87, 0x00, 0x02, 0xba, 0x14, 0x5f, 0x82, 0xbb, 0x0e, 0x22, 0xe5, 0x19, 0x46, 0x72,
+	0xe3, 0xc5, 0x7e, 0xfe, 0x24, 0xc2, 0xbb, 0x13, 0xcd, 0xe5, 0x1b, 0x18, 0x0d, 0xfe, 0x25, 0xc2,
+	0xc5, 0x13, 0xcd, 0x55, 0x1c, 0x18, 0x03, 0xcd, 0xa1, 0x17, 0xc1, 0xe1, 0x70, 0xc9, 0xeb, 0x80,
+	0x47, 0x00, 0x1c, 0xc1, 0xd1, 0xc5, 0x43, 0xc9, 0xcd, 0x1c, 0x14, 0x32, 0x84, 0x20, 0xcd, 0x83,
+	0x20, 0xc3, 0x82, 0x10, 0xcd, 0x06, 0x14, 0xc3, 0x4b, 0x20, 0xcd, 0x06, 0x14, 0xf5, 0x1e, 0x00,
+	0x81, 0xdd, 0x07, 0x00, 0xfc, 0x84, 0x76, 0x00, 0x08, 0xc1, 0xcd, 0x83, 0x20, 0xab, 0xa0, 0xca,
+	0xfd, 0x13, 0x80, 0xb3, 0x09, 0x05, 0x32, 0x84, 0x20, 0x32, 0x4c, 0x20, 0x80, 0x1a, 0x00, 0x02,
+	0xc3, 0x19, 0x14, 0x83, 0x25, 0x0b, 0x06, 0xf7, 0x08, 0x7a, 0xb7, 0xc2, 0x12, 0x09, 0x80, 0x36,
+	0x00, 0x05, 0x7b, 0xc9, 0xcd, 0xfd, 0x08, 0x1a, 0x80, 0x4f, 0x00, 0x00, 0xb8, 0x80, 0xa3, 0x05,
+	0x80, 0xa6, 0x03, 0x80, 0x43, 0x00, 0x28, 0xd1, 0x12, 0xc9, 0x21, 0x18, 0x19, 0xcd, 0xe9, 0x16,
+	0xc3, 0x54, 0x14, 0xcd, 0xe9, 0x16, 0x21, 0xc1, 0xd1, 0xcd, 0xc3, 0x16, 0xc3, 0x00, 0x1d, 0x3a,
+	0x2c, 0x21, 0xb7, 0xca, 0xdb, 0x16, 0x90, 0xd2, 0x6e, 0x14, 0x2f, 0x3c, 0xeb, 0xcd, 0xcb, 0x16,
+	0x80, 0x5a, 0x06, 0x7f, 0xc1, 0xd1, 0xfe, 0x19, 0xd0, 0xf5, 0xcd, 0x00, 0x17, 0x67, 0xf1, 0xcd,
+// +0x1400
+	0x19, 0x15, 0xb4, 0x21, 0x29, 0x21, 0xf2, 0x94, 0x14, 0xcd, 0xf9, 0x14, 0xd2, 0xda, 0x14, 0x23,
+	0x34, 0xca, 0x02, 0x04, 0x2e, 0x01, 0xcd, 0x2f, 0x15, 0xc3, 0xda, 0x14, 0xaf, 0x90, 0x47, 0x7e,
+	0x9b, 0x5f, 0x23, 0x7e, 0x9a, 0x57, 0x23, 0x7e, 0x99, 0x4f, 0xdc, 0x05, 0x15, 0x68, 0x63, 0xaf,
+	0x47, 0x79, 0xb7, 0xc2, 0xc7, 0x14, 0x4a, 0x54, 0x65, 0x6f, 0x78, 0xd6, 0x08, 0xfe, 0xe0, 0xc2,
+	0xa8, 0x14, 0xaf, 0x32, 0x2c, 0x21, 0xc9, 0x05, 0x29, 0x7a, 0x17, 0x57, 0x79, 0x8f, 0x4f, 0xf2,
+	0xbf, 0x14, 0x78, 0x5c, 0x45, 0xb7, 0xca, 0xda, 0x14, 0x21, 0x2c, 0x21, 0x86, 0x77, 0xd2, 0xba,
+	0x14, 0xc8, 0x78, 0x21, 0x2c, 0x21, 0xb7, 0xfc, 0xec, 0x14, 0x46, 0x23, 0x7e, 0xe6, 0x80, 0xa9,
+	0x4f, 0xc3, 0xdb, 0x16, 0x7f, 0x1c, 0xc0, 0x14, 0xc0, 0x0c, 0xc0, 0x0e, 0x80, 0x34, 0xc0, 0xc3,
+	0x02, 0x04, 0x7e, 0x83, 0x5f, 0x23, 0x7e, 0x8a, 0x57, 0x23, 0x7e, 0x89, 0x4f, 0xc9, 0x21, 0x2d,
+	0x21, 0x7e, 0x2f, 0x77, 0xaf, 0x6f, 0x90, 0x47, 0x7d, 0x9b, 0x5f, 0x7d, 0x9a, 0x57, 0x7d, 0x99,
+	0x4f, 0xc9, 0x06, 0x00, 0xd6, 0x08, 0xda, 0x28, 0x15, 0x43, 0x5a, 0x51, 0x0e, 0x00, 0xc3, 0x1b,
+	0x15, 0xc6, 0x09, 0x6f, 0xaf, 0x2d, 0xc8, 0x79, 0x1f, 0x4f, 0x7a, 0x1f, 0x57, 0x7b, 0x1f, 0x5f,
+	0x78, 0x1f, 0x47, 0xc3, 0x2b, 0x15, 0x00, 0x00, 0x00, 0x81, 0x03, 0xaa, 0x56, 0x19, 0x80, 0xf1,
+	0x22, 0x76, 0x80, 0x45, 0xaa, 0x38, 0x82, 0xcd, 0x9a, 0x16, 0xb7, 0xea, 0x12, 0x09, 0x21, 0x2c,
+	0x21, 0x7e, 0x01, 0x35, 0x80, 0x11, 0xf3, 0x04, 0x90, 0xf5, 0x70, 0xd5, 0xc5, 0xcd, 0x54, 0x14,
+	0xc1, 0xd1, 0x04, 0xcd, 0xf0, 0x0f, 0x15, 0x21, 0x3d, 0x15, 0xcd, 0x4b, 0x14, 0x21, 0x41, 0x15,
+// +0x1500
+	0xcd, 0xe2, 0x19, 0x01, 0x80, 0x80, 0x80, 0x64, 0x0c, 0x4a, 0x54, 0x14, 0xf1, 0xcd, 0x15, 0x18,
+	0x01, 0x31, 0x80, 0x11, 0x18, 0x72, 0x21, 0xc1, 0xd1, 0xc3, 0x07, 0x1d, 0xc8, 0x2e, 0x00, 0xcd,
+	0x58, 0x16, 0x79, 0x32, 0x3b, 0x21, 0xeb, 0x22, 0x3c, 0x21, 0x01, 0x00, 0x00, 0x50, 0x58, 0x21,
+	0xa5, 0x14, 0xe5, 0x21, 0xb1, 0x15, 0xe5, 0xe5, 0x21, 0x29, 0x21, 0x7e, 0x23, 0xb7, 0xca, 0xdd,
+	0x15, 0xe5, 0x2e, 0x08, 0x1f, 0x67, 0x79, 0xd2, 0xcb, 0x15, 0xe5, 0x2a, 0x3c, 0x21, 0x19, 0xeb,
+	0xe1, 0x3a, 0x3b, 0x21, 0x89, 0x87, 0x9c, 0x00, 0x11, 0x2d, 0x7c, 0xc2, 0xba, 0x15, 0xe1, 0xc9,
+	0x43, 0x5a, 0x51, 0x4f, 0xc9, 0xcd, 0xcb, 0x16, 0x01, 0x20, 0x84, 0x80, 0x6c, 0x00, 0x80, 0x82,
+	0x01, 0x15, 0xc3, 0x10, 0x1d, 0xca, 0xf6, 0x03, 0x2e, 0xff, 0xcd, 0x58, 0x16, 0x34, 0x34, 0x2b,
+	0x7e, 0x32, 0x57, 0x20, 0x2b, 0x7e, 0x32, 0x53, 0x80, 0x05, 0x00, 0x2a, 0x4f, 0x20, 0x41, 0xeb,
+	0xaf, 0x4f, 0x57, 0x5f, 0x32, 0x5a, 0x20, 0xe5, 0xc5, 0x7d, 0xcd, 0x4e, 0x20, 0xde, 0x00, 0x3f,
+	0xd2, 0x28, 0x16, 0x32, 0x5a, 0x20, 0xf1, 0xf1, 0x37, 0xd2, 0xc1, 0xe1, 0x79, 0x3c, 0x3d, 0x1f,
+	0xfa, 0xdb, 0x14, 0x17, 0x7b, 0x17, 0x5f, 0x80, 0x74, 0x01, 0x57, 0x17, 0x4f, 0x29, 0x78, 0x17,
+	0x47, 0x3a, 0x5a, 0x20, 0x17, 0x32, 0x5a, 0x20, 0x79, 0xb2, 0xb3, 0xc2, 0x15, 0x16, 0xe5, 0x21,
+	0x2c, 0x21, 0x35, 0xe1, 0xc2, 0x15, 0x16, 0xc3, 0x02, 0x04, 0x78, 0xb7, 0xca, 0x7c, 0x16, 0x7d,
+	0x21, 0x2c, 0x21, 0xae, 0x80, 0x47, 0x1f, 0xa8, 0x78, 0xf2, 0x7b, 0x16, 0xc6, 0x80, 0x77, 0xca,
+	0xdb, 0x15, 0xcd, 0x00, 0x17, 0x77, 0x2b, 0xc9, 0xcd, 0x9a, 0x16, 0x2f, 0xe1, 0xb7, 0xe1, 0xf2,
+// +0x1600
+	0xba, 0x14, 0xc3, 0x02, 0x04, 0xcd, 0xe6, 0x16, 0x78, 0xb7, 0xc8, 0xc6, 0x02, 0xda, 0x02, 0x04,
+	0x47, 0xcd, 0x54, 0x80, 0xc1, 0x01, 0x81, 0xa1, 0x01, 0x80, 0x43, 0x02, 0x09, 0xc8, 0x3a, 0x2b,
+	0x21, 0xfe, 0x2f, 0x17, 0x9f, 0xc0, 0x3c, 0x80, 0x33, 0x00, 0x1e, 0x06, 0x88, 0x11, 0x00, 0x00,
+	0x21, 0x2c, 0x21, 0x4f, 0x70, 0x06, 0x00, 0x23, 0x36, 0x80, 0x17, 0xc3, 0xa2, 0x14, 0xcd, 0x9a,
+	0x16, 0xf0, 0x21, 0x2b, 0x21, 0x7e, 0xee, 0x80, 0x77, 0xc9, 0x82, 0xfa, 0x08, 0x01, 0x2a, 0x2b,
+	0x80, 0xff, 0x08, 0x03, 0xc9, 0xcd, 0xe9, 0x16, 0x80, 0x2f, 0x09, 0x09, 0x60, 0x69, 0x22, 0x2b,
+	0x21, 0xeb, 0xc9, 0x21, 0x29, 0x21, 0x80, 0xaa, 0x04, 0x80, 0xb7, 0x09, 0x0e, 0xc9, 0x11, 0x29,
+	0x21, 0x06, 0x04, 0x1a, 0x77, 0x13, 0x23, 0x05, 0xc2, 0xf7, 0x16, 0xc9, 0x80, 0x3d, 0x00, 0x43,
+	0x07, 0x37, 0x1f, 0x77, 0x3f, 0x1f, 0x23, 0x23, 0x77, 0x79, 0x07, 0x37, 0x1f, 0x4f, 0x1f, 0xae,
+	0xc9, 0x78, 0xb7, 0xca, 0x9a, 0x16, 0x21, 0xa3, 0x16, 0xe5, 0xcd, 0x9a, 0x16, 0x79, 0xc8, 0x21,
+	0x2b, 0x21, 0xae, 0x79, 0xf8, 0xcd, 0x2f, 0x17, 0x1f, 0xa9, 0xc9, 0x23, 0x78, 0xbe, 0xc0, 0x2b,
+	0x79, 0xbe, 0xc0, 0x2b, 0x7a, 0xbe, 0xc0, 0x2b, 0x7b, 0x96, 0xc0, 0xe1, 0xe1, 0xc9, 0x47, 0x4f,
+	0x57, 0x5f, 0xb7, 0xc8, 0x81, 0x52, 0x0f, 0x1f, 0x00, 0x17, 0xae, 0x67, 0xfc, 0x66, 0x17, 0x3e,
+	0x98, 0x90, 0xcd, 0x19, 0x15, 0x7c, 0x17, 0xdc, 0xec, 0x14, 0x06, 0x00, 0xdc, 0x05, 0x15, 0xe1,
+	0xc9, 0x1b, 0x7a, 0xa3, 0x3c, 0xc0, 0x0b, 0xc9, 0x80, 0x18, 0x02, 0x42, 0xfe, 0x98, 0x3a, 0x29,
+	0x21, 0xd0, 0x7e, 0xcd, 0x42, 0x17, 0x36, 0x98, 0x7b, 0xf5, 0x79, 0x17, 0xcd, 0xa2, 0x14, 0xf1,
+// +0x1700
+	0xc9, 0xc3, 0x53, 0x1d, 0x78, 0xb1, 0xc8, 0x3e, 0x10, 0x29, 0xda, 0xc6, 0x0f, 0xeb, 0x29, 0xeb,
+	0xd2, 0x9c, 0x17, 0x09, 0xda, 0xc6, 0x0f, 0x3d, 0xc2, 0x8e, 0x17, 0xc9, 0xfe, 0x2d, 0xf5, 0xca,
+	0xad, 0x17, 0xfe, 0x2b, 0xca, 0xad, 0x17, 0x2b, 0xcd, 0xba, 0x14, 0x47, 0x57, 0x5f, 0x2f, 0x81,
+	0xea, 0x08, 0x0b, 0xfe, 0x17, 0xfe, 0x2e, 0xca, 0xd9, 0x17, 0xfe, 0x45, 0xc2, 0xdd, 0x17, 0x80,
+	0xaf, 0x03, 0x01, 0xf1, 0x0d, 0x80, 0x16, 0x00, 0x36, 0x20, 0x18, 0x14, 0xc2, 0xdd, 0x17, 0xaf,
+	0x93, 0x5f, 0x0c, 0x0c, 0xca, 0xb5, 0x17, 0xe5, 0x7b, 0x90, 0xf4, 0xf6, 0x17, 0xf2, 0xec, 0x17,
+	0xf5, 0xcd, 0xe2, 0x15, 0xf1, 0x3c, 0xc2, 0xe0, 0x17, 0xd1, 0xf1, 0xcc, 0xc3, 0x16, 0xeb, 0xc9,
+	0xc8, 0xf5, 0xcd, 0x83, 0x16, 0xf1, 0x3d, 0xc9, 0xd5, 0x57, 0x78, 0x89, 0x47, 0xc5, 0xe5, 0xd5,
+	0x80, 0x0e, 0x00, 0x0f, 0xd6, 0x30, 0xcd, 0x15, 0x18, 0xe1, 0xc1, 0xd1, 0xc3, 0xb5, 0x17, 0xcd,
+	0xcb, 0x16, 0xcd, 0xac, 0x80, 0x2d, 0x02, 0x10, 0x54, 0x14, 0x7b, 0x07, 0x07, 0x83, 0x07, 0x86,
+	0xd6, 0x30, 0x5f, 0xc3, 0xcb, 0x17, 0xe5, 0x21, 0x8b, 0x80, 0xe8, 0x13, 0x0e, 0xe1, 0xeb, 0xaf,
+	0x06, 0x98, 0xcd, 0xb1, 0x16, 0x21, 0x90, 0x11, 0xe5, 0x21, 0x2e, 0x21, 0x80, 0x25, 0x01, 0x2a,
+	0x36, 0x20, 0xf2, 0x4d, 0x18, 0x36, 0x2d, 0x23, 0x36, 0x30, 0xca, 0x03, 0x19, 0xe5, 0xfc, 0xc3,
+	0x16, 0xaf, 0xf5, 0xcd, 0x09, 0x19, 0x01, 0x43, 0x91, 0x11, 0xf8, 0x4f, 0xcd, 0x15, 0x17, 0xb7,
+	0xe2, 0x7a, 0x18, 0xf1, 0xcd, 0xf7, 0x17, 0xf5, 0xc3, 0x5c, 0x18, 0x81, 0x8a, 0x00, 0x80, 0x1e,
+	0x00, 0x32, 0xcd, 0x42, 0x14, 0x3c, 0xcd, 0x42, 0x17, 0xcd, 0xdb, 0x16, 0x01, 0x06, 0x03, 0xf1,
+// +0x1800
+	0x81, 0x3c, 0xfa, 0x96, 0x18, 0xfe, 0x08, 0xd2, 0x96, 0x18, 0x3c, 0x47, 0x3e, 0x02, 0x3d, 0x3d,
+	0xe1, 0xf5, 0x11, 0x1c, 0x19, 0x05, 0xc2, 0xa7, 0x18, 0x36, 0x2e, 0x23, 0x36, 0x30, 0x23, 0x05,
+	0x36, 0x2e, 0xcc, 0xf0, 0x16, 0x80, 0xaa, 0x00, 0x5d, 0xe6, 0x16, 0xe1, 0x06, 0x2f, 0x04, 0x7b,
+	0x96, 0x5f, 0x23, 0x7a, 0x9e, 0x57, 0x23, 0x79, 0x9e, 0x4f, 0x2b, 0x2b, 0xd2, 0xb6, 0x18, 0xcd,
+	0xf9, 0x14, 0x23, 0xcd, 0xdb, 0x16, 0xeb, 0xe1, 0x70, 0x23, 0xc1, 0x0d, 0xc2, 0xa7, 0x18, 0x05,
+	0xca, 0xe7, 0x18, 0x2b, 0x7e, 0xfe, 0x30, 0xca, 0xdb, 0x18, 0xfe, 0x2e, 0xc4, 0xf0, 0x16, 0xf1,
+	0xca, 0x06, 0x19, 0x36, 0x45, 0x23, 0x36, 0x2b, 0xf2, 0xf7, 0x18, 0x36, 0x2d, 0x2f, 0x3c, 0x06,
+	0x2f, 0x04, 0xd6, 0x0a, 0xd2, 0xf9, 0x18, 0xc6, 0x3a, 0x23, 0x70, 0x23, 0x77, 0x23, 0x71, 0xe1,
+	0xc9, 0x01, 0x74, 0x94, 0x11, 0xf7, 0x23, 0x80, 0xad, 0x00, 0x22, 0xe1, 0xe2, 0x71, 0x18, 0xe9,
+	0x00, 0x00, 0x00, 0x80, 0xa0, 0x86, 0x01, 0x10, 0x27, 0x00, 0xe8, 0x03, 0x00, 0x64, 0x00, 0x00,
+	0x0a, 0x00, 0x00, 0x01, 0x00, 0x00, 0x21, 0xc3, 0x16, 0xe3, 0xe9, 0xc3, 0x14, 0x1d, 0x80, 0xf4,
+	0x04, 0x25, 0xd8, 0x16, 0xc1, 0xd1, 0xcd, 0x9a, 0x16, 0x78, 0xca, 0x81, 0x19, 0xf2, 0x4c, 0x19,
+	0xb7, 0xca, 0xf6, 0x03, 0xb7, 0xca, 0xbb, 0x14, 0xd5, 0xc5, 0x79, 0xf6, 0x7f, 0xcd, 0xe6, 0x16,
+	0xf2, 0x69, 0x19, 0xd5, 0xc5, 0xcd, 0x6d, 0x17, 0x80, 0x20, 0x0b, 0x1c, 0x15, 0x17, 0xe1, 0x7c,
+	0x1f, 0xe1, 0x22, 0x2b, 0x21, 0xe1, 0x22, 0x29, 0x21, 0xdc, 0x2e, 0x19, 0xcc, 0xc3, 0x16, 0xd5,
+	0xc5, 0xcd, 0x4e, 0x15, 0xc1, 0xd1, 0xcd, 0x8f, 0x15, 0x80, 0x9f, 0x03, 0x07, 0x38, 0x81, 0x11,
+// +0x1900
+	0x3b, 0xaa, 0xcd, 0x8f, 0x15, 0x80, 0x90, 0x10, 0x0e, 0x88, 0xd2, 0x76, 0x16, 0xcd, 0x6d, 0x17,
+	0xc6, 0x80, 0xc6, 0x02, 0xda, 0x76, 0x16, 0xf5, 0x80, 0x33, 0x04, 0x05, 0x45, 0x14, 0xcd, 0x86,
+	0x15, 0xf1, 0x80, 0x4a, 0x00, 0x2f, 0x51, 0x14, 0xcd, 0xc3, 0x16, 0x21, 0xc1, 0x19, 0xcd, 0xf1,
+	0x19, 0x11, 0x00, 0x00, 0xc1, 0x4a, 0xc3, 0x8f, 0x15, 0x08, 0x40, 0x2e, 0x94, 0x74, 0x70, 0x4f,
+	0x2e, 0x77, 0x6e, 0x02, 0x88, 0x7a, 0xe6, 0xa0, 0x2a, 0x7c, 0x50, 0xaa, 0xaa, 0x7e, 0xff, 0xff,
+	0x7f, 0x7f, 0x00, 0x00, 0x80, 0x81, 0x80, 0xa1, 0x04, 0x06, 0xcd, 0xcb, 0x16, 0x11, 0x8d, 0x15,
+	0xd5, 0x81, 0xa1, 0x02, 0x14, 0x8f, 0x15, 0xe1, 0xcd, 0xcb, 0x16, 0x7e, 0x23, 0xcd, 0xd8, 0x16,
+	0x06, 0xf1, 0xc1, 0xd1, 0x3d, 0xc8, 0xd5, 0xc5, 0xf5, 0xe5, 0x81, 0x16, 0x00, 0x80, 0x78, 0x0d,
+	0x13, 0x54, 0x14, 0xe1, 0xc3, 0xfa, 0x19, 0xcd, 0x9a, 0x16, 0x21, 0x5e, 0x20, 0xfa, 0x73, 0x1a,
+	0x21, 0x7f, 0x20, 0xcd, 0xd8, 0x80, 0x0c, 0x00, 0x0d, 0xc8, 0x86, 0xe6, 0x07, 0x06, 0x00, 0x77,
+	0x23, 0x87, 0x87, 0x4f, 0x09, 0xcd, 0xe9, 0x80, 0x46, 0x00, 0x10, 0x3a, 0x5d, 0x20, 0x3c, 0xe6,
+	0x03, 0x06, 0x00, 0xfe, 0x01, 0x88, 0x32, 0x5d, 0x20, 0x21, 0x77, 0x1a, 0x81, 0x1b, 0x00, 0x3d,
+	0x45, 0x14, 0xcd, 0xe6, 0x16, 0x7b, 0x59, 0xee, 0x4f, 0x4f, 0x36, 0x80, 0x2b, 0x46, 0x36, 0x80,
+	0x21, 0x5c, 0x20, 0x34, 0x7e, 0xd6, 0xab, 0xc2, 0x6a, 0x1a, 0x77, 0x0c, 0x15, 0x1c, 0xcd, 0xa5,
+	0x14, 0x21, 0x7f, 0x20, 0xc3, 0xf2, 0x16, 0x77, 0x2b, 0x77, 0x2b, 0x77, 0xc3, 0x4e, 0x1a, 0x68,
+	0xb1, 0x46, 0x68, 0x99, 0xe9, 0x92, 0x69, 0x10, 0xd1, 0x75, 0x68, 0x21, 0xd1, 0x1a, 0x80, 0x3f,
+// +0x1a00
+	0x00, 0x07, 0xcb, 0x16, 0x01, 0x49, 0x83, 0x11, 0xdb, 0x0f, 0x81, 0xab, 0x04, 0x01, 0xcd, 0xf0,
+	0x80, 0x1d, 0x01, 0x81, 0x44, 0x01, 0x07, 0xcd, 0x51, 0x14, 0x21, 0xd5, 0x1a, 0xcd, 0x4b, 0x80,
+	0xf0, 0x03, 0x05, 0x37, 0xf2, 0xbd, 0x1a, 0xcd, 0x42, 0x80, 0x0a, 0x00, 0x04, 0xb7, 0xf5, 0xf4,
+	0xc3, 0x16, 0x80, 0x18, 0x00, 0x0e, 0x45, 0x14, 0xf1, 0xd4, 0xc3, 0x16, 0x21, 0xd9, 0x1a, 0xc3,
+	0xe2, 0x19, 0xdb, 0x0f, 0x49, 0x80, 0xf7, 0x00, 0x15, 0x7f, 0x05, 0xba, 0xd7, 0x1e, 0x86, 0x64,
+	0x26, 0x99, 0x87, 0x58, 0x34, 0x23, 0x87, 0xe0, 0x5d, 0xa5, 0x86, 0xda, 0x0f, 0x49, 0x83, 0x80,
+	0x50, 0x00, 0x02, 0x8d, 0x1a, 0xc1, 0x80, 0x05, 0x01, 0x80, 0x91, 0x06, 0x0e, 0xcd, 0x87, 0x1a,
+	0xc3, 0xee, 0x15, 0xcd, 0x9a, 0x16, 0xfc, 0x2e, 0x19, 0xfc, 0xc3, 0x16, 0x80, 0x7f, 0x01, 0x03,
+	0x81, 0xda, 0x20, 0x1b, 0x80, 0x31, 0x13, 0x00, 0x59, 0x80, 0xaf, 0x05, 0x2d, 0x4b, 0x14, 0xe5,
+	0x21, 0x2a, 0x1b, 0xcd, 0xe2, 0x19, 0x21, 0xd1, 0x1a, 0xc9, 0x09, 0x4a, 0xd7, 0x3b, 0x78, 0x02,
+	0x6e, 0x84, 0x7b, 0xfe, 0xc1, 0x2f, 0x7c, 0x74, 0x31, 0x9a, 0x7d, 0x84, 0x3d, 0x5a, 0x7d, 0xc8,
+	0x7f, 0x91, 0x7e, 0xe4, 0xbb, 0x4c, 0x7e, 0x6c, 0xaa, 0xaa, 0x7f, 0x80, 0x6d, 0x01, 0x0f, 0xc9,
+	0xd7, 0xc9, 0x3e, 0x0c, 0xc3, 0x88, 0x1c, 0xcd, 0x19, 0x14, 0x7b, 0x32, 0x87, 0x20, 0xc9, 0x82,
+	0x2e, 0x07, 0x07, 0xed, 0x53, 0x8b, 0x20, 0xed, 0x53, 0x8d, 0x20, 0x80, 0x44, 0x07, 0x04, 0xd5,
+	0xe1, 0x46, 0x23, 0x7e, 0x80, 0xf2, 0x0a, 0x87, 0x48, 0x07, 0x81, 0x0b, 0x00, 0x00, 0xe3, 0x81,
+	0x41, 0x0a, 0x82, 0x02, 0x0d, 0x1d, 0xc5, 0x21, 0x2e, 0x21, 0x7a, 0xfe, 0x00, 0x28, 0x0c, 0xcd,
+// +0x1b00
+	0xc8, 0x1b, 0x78, 0xfe, 0x30, 0x28, 0x02, 0x70, 0x23, 0x71, 0x23, 0x7b, 0xcd, 0xc8, 0x1b, 0x7a,
+	0xfe, 0x00, 0x20, 0x05, 0x85, 0x12, 0x00, 0x80, 0xba, 0x16, 0x17, 0xc1, 0x21, 0x2e, 0x21, 0xc3,
+	0x21, 0x11, 0x47, 0xe6, 0x0f, 0xfe, 0x0a, 0x38, 0x02, 0xc6, 0x07, 0xc6, 0x30, 0x4f, 0x78, 0x0f,
+	0x0f, 0x0f, 0x0f, 0x86, 0x10, 0x00, 0x01, 0x47, 0xc9, 0x80, 0x91, 0x0b, 0x36, 0xcd, 0xfe, 0x1b,
+	0xda, 0x1e, 0x1c, 0x18, 0x05, 0xcd, 0xfe, 0x1b, 0x38, 0x1f, 0x29, 0x29, 0x29, 0x29, 0xb5, 0x6f,
+	0x18, 0xf3, 0x13, 0x1a, 0xfe, 0x20, 0xca, 0xfe, 0x1b, 0xd6, 0x30, 0xd8, 0xfe, 0x0a, 0x38, 0x05,
+	0xd6, 0x07, 0xfe, 0x0a, 0xd8, 0xfe, 0x10, 0x3f, 0xc9, 0xeb, 0x7a, 0x4b, 0xe5, 0xcd, 0x72, 0x10,
+	0xe1, 0xc9, 0x1e, 0x26, 0x80, 0x19, 0x0b, 0x85, 0x93, 0x00, 0x0f, 0x06, 0x11, 0x05, 0x78, 0xfe,
+	0x01, 0x28, 0x08, 0xcb, 0x13, 0xcb, 0x12, 0x30, 0xf4, 0x18, 0x04, 0x80, 0x08, 0x00, 0x08, 0x3e,
+	0x30, 0xce, 0x00, 0x77, 0x23, 0x05, 0x20, 0xf3, 0x87, 0x8d, 0x00, 0x81, 0x70, 0x00, 0x0e, 0x72,
+	0x1c, 0xda, 0x80, 0x1c, 0xd6, 0x30, 0x29, 0xb5, 0x6f, 0xcd, 0x72, 0x1c, 0x30, 0xf6, 0x85, 0x54,
+	0x00, 0x81, 0x74, 0x00, 0x12, 0x72, 0x1c, 0xfe, 0x30, 0xd8, 0xfe, 0x32, 0x3f, 0xc9, 0x1e, 0x28,
+	0xc3, 0x07, 0x04, 0xc3, 0x4c, 0x00, 0xc3, 0x08, 0x80, 0x10, 0x19, 0x0e, 0x3e, 0x00, 0x32, 0x92,
+	0x20, 0xc3, 0x53, 0x00, 0xf5, 0xa0, 0xc1, 0xb8, 0x3e, 0x00, 0xc9, 0x80, 0xf0, 0x15, 0x01, 0xf3,
+	0x0a, 0x81, 0x36, 0x19, 0xd4, 0x01, 0x00, 0x06, 0x78, 0xb7, 0xc8, 0x3e, 0x10, 0x18, 0x0f, 0x81,
+	0x6d, 0x06, 0x28, 0x3e, 0x12, 0x18, 0x06, 0x3e, 0x13, 0x18, 0x02, 0x3e, 0x14, 0xf5, 0xc5, 0x21,
+// +0x1c00
+	0x29, 0x21, 0x01, 0x38, 0x05, 0xed, 0xb3, 0xc1, 0x7b, 0xd3, 0x38, 0x7a, 0xd3, 0x38, 0x79, 0xd3,
+	0x38, 0x78, 0xd3, 0x38, 0xf1, 0xd3, 0x39, 0xdb, 0x39, 0xb7, 0x20, 0x13, 0x83, 0x1d, 0x00, 0x1c,
+	0xb2, 0x2b, 0xed, 0x5b, 0x29, 0x21, 0xed, 0x4b, 0x2b, 0x21, 0x79, 0xc9, 0x3d, 0xca, 0x02, 0x04,
+	0x3d, 0xca, 0xf6, 0x03, 0xc3, 0x12, 0x09, 0x21, 0x00, 0x00, 0x78, 0xb1, 0xc8, 0x82, 0x38, 0x00,
+	0x80, 0x02, 0x00, 0x82, 0x3c, 0x00, 0x13, 0xaf, 0xd3, 0x39, 0xdb, 0x38, 0x6f, 0xdb, 0x38, 0x67,
+	0xdb, 0x38, 0x5f, 0xdb, 0x38, 0xb3, 0xc2, 0xc6, 0x0f, 0x57, 0x5f, 0x80, 0x43, 0x1a, 0xff, 0x01,
+	0x00, 0xff, 0x01, 0x00, 0xff, 0x01, 0x00, 0xff, 0x01, 0x00, 0xef, 0x01, 0x00, 0x80, 0x00, 0x00
+};
+
+const struct image_seg image_segs[] = {
+//    addr    len     crc     lz  data
+	{ 0x0000, 0x2000, 0x4cad, 0, rom0 },
+	{ 0x0000, 0x2000, 0xb16d, 1, rom1 },
+};
+
+const struct image images[] = {
+//    name        entry   seg nseg
+	{ "EMUBASIC", 0x0000, 0, 1 },
+	{ "EMUBASIC-FP", 0x0000, 1, 1 },
+};
+const unsigned char image_count = 2;
+const unsigned char image_seg_count = 2;
@@ -0,0 +1,1095 @@
+/*
+ * cosim - run the PIC firmware emuz80_z80ram.c on the host against a
+ * modelled Z80, SRAM, UART3, SD card and data EEPROM
+ *
+ * Build (from the top of the tree):
+ *   sed -f tools/pic/xc8types.sed emuz80_z80ram.c > cosim_fw.c
+ *   cc -O2 -funsigned-char -no-pie -Itools/pic -o cosim tools/cosim.c cosim_fw.c
+ *
+ * Usage: cosim [-b] [-f] [-F] [-r] [-d CARD] [-e EEPROM] [-l BIN] [-n INSNS] [-t SECS]
+ *   -b        batch: stdin is not put in raw mode, and the run ends once
+ *             the Z80 has started, stdin is at EOF and the UART has been
+ *             quiet for 2 seconds
+ *   -f        UART3 without a baud rate, every byte leaves at once
+ *   -F        Z80 flat out instead of at the NCO1 clock in host time
+ *   -r        IN /IORQ edge case: after an IN that leaves writes queued,
+ *             the Z80 stops before the /IORQ rising edge and the edge
+ *             comes while the main loop runs the next queued write, then
+ *             the Z80 fetches its next opcode. A fetch with the PIC still
+ *             driving D7-D0 is counted and cosim exits with status 1
+ *   -d CARD   SD card image, a FAT32 volume (superfloppy or MBR) with
+ *             DRIVEA-D.DSK and SNAPSHOT.BIN, written in place
+ *   -e EEPROM data EEPROM contents, loaded and saved (default all 0xFF)
+ *   -l BIN    binary put at 0x0000 when the Z80 first leaves reset, over
+ *             the image the firmware uploaded (tools/sdbench)
+ *   -n INSNS  stop after INSNS Z80 instructions
+ *   -t SECS   stop after SECS seconds
+ *
+ * The firmware is compiled as it is for the PIC, through tools/pic/xc.h
+ * in place of the XC8 one. main() runs as the PIC main loop; a 100us
+ * interval timer stands in for the interrupts. It runs the Z80 (tools/z80.h)
+ * for the time that passed whenever GIE, CLC3IE, /BUSREQ and RESET let it, and
+ * every IN, OUT and interrupt acknowledge is an IO cycle: /IORQ goes low,
+ * /WAIT is asserted and CLC_ISR() is called with the address on PORTB and
+ * the data on PORTC. The Z80 goes on once the firmware resets the /WAIT
+ * D-FF, in CLC_ISR or later from a bus job, and an IN takes what the
+ * firmware put on LATC, and the /IORQ rising edge calls IORQ_ISR() once
+ * GIE lets it. The low priority ISRs follow from their flags:
+ * UART3 RX, TX and TX shift register empty at the baud rate set in U3BRG,
+ * TMR0 overflow, the TMR4 tick and the TMR6 profiler, which samples the
+ * Z80 PC as a fetch.
+ * RAM accesses with the PIC as bus master go through the LATB/LATD/LATE2
+ * address latches, LATC and /WE, /OE, and the upload DMA moves the bytes
+ * when TMR2 starts. Ctrl-] ends the run (Ctrl-\ is the firmware console).
+ *
+ * At the end stderr gets, per port, the IN and OUT counts, how many OUTs
+ * were queued, how many held for a bus job and how many cycles had to run
+ * queued writes in CLC_ISR first, and the host time from
+ * the CLC_ISR call to the /WAIT release (mean and max, held OUTs apart),
+ * plus the SD card commands and SPI bytes and the opcode fetches that found
+ * the PIC driving D7-D0. Host time is not PIC time:
+ * the firmware runs at host speed, so compare runs with each other, not
+ * with the board. The counts are those of the board, except for ones that
+ * depend on timing such as UART_CREG polls.
+ */
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#define HAL_REG				/* Define the SFRs */
+#include "pic/xc.h"
+#undef printf
+#undef main
+#include "z80.h"
+
+#define RAM_SIZE	0x10000
+#define EE_BASE		0x380000UL
+#define EE_SIZE		1024
+#define DISK_CMD	0x14
+#define PPS_CCP1	0x15
+#define EXIT_KEY	0x1d	/* Ctrl-] */
+#define TICK_US		100
+#define QUIET_NS	2000000000ULL	/* -b: UART quiet this long after EOF */
+
+/* The firmware */
+void pic_main(void);
+void putch(char c);
+void CLC_ISR(void);
+void IORQ_ISR(void);
+void UART_RX_ISR(void);
+void UART_TX_ISR(void);
+void UART_TXMT_ISR(void);
+void TIM_ISR(void);
+void TICK_ISR(void);
+void PROF_ISR(void) __attribute__((weak));	/* Z80_PROF */
+extern volatile unsigned char rx_wp, rx_rp;	/* rx_buf indices */
+extern volatile unsigned char io_wq_wp, io_wq_rp;
+typedef void (*io_wr_t)(unsigned char port, unsigned char data);
+extern io_wr_t io_wr[256];
+
+static unsigned char ram[RAM_SIZE];
+static struct z80 cpu;
+static char **saved_argv;
+
+static struct termios saved_tio;
+static int raw_tty;
+static int batch, fast_uart, flat_out, iorq_case;
+static unsigned long long limit_insns, limit_ns;
+static unsigned char load[RAM_SIZE];
+static long load_len = -1;		/* -l, -1 once loaded */
+
+/* Host time */
+
+static struct timespec t_start;
+
+static unsigned long long ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec - t_start.tv_sec) * 1000000000ULL + t.tv_nsec - t_start.tv_nsec;
+}
+
+void hal_delay_ns(unsigned long long n)
+{
+	unsigned long long t = ns() + n;
+
+	while (ns() < t)
+		;
+}
+
+/* Plain SFRs without a hook, see xc.h */
+volatile unsigned char hal_z80_int = 1, hal_z80_int_tris, hal_z80_m1 = 1;
+volatile unsigned char hal_z80_m1_tris, hal_z80_m1_ansel;
+volatile unsigned char hal_sd_cs = 1, hal_sd_cs_tris;
+
+/* A hook in progress, the timer leaves the firmware state alone */
+static volatile sig_atomic_t hal_busy;
+
+/* Z80 bus */
+
+static volatile unsigned char lat[8], seen[8];	/* HAL_LATx now, at the last sync */
+static volatile unsigned char gie, g3pol, tmr2if, dma1scntif;
+static volatile struct t2con_bits t2con;
+static unsigned char t2_seen, ra2pps_seen;
+static volatile struct dma_regs dma[2];
+
+static struct {
+	int run;				/* Out of reset */
+	int wait;				/* /WAIT asserted */
+	int stall;				/* Held on /WAIT */
+	int io_write;			/* Z80 drives D7-D0 */
+	int in_clc;				/* Inside CLC_ISR */
+	int edge;				/* /IORQ rising edge of an IN still to come (-r) */
+	unsigned long edges;	/* -r: edges that came in a queued write */
+	unsigned long clash;	/* Opcode fetches with the PIC on D7-D0 */
+	unsigned char data;		/* Z80 data on D7-D0 */
+	unsigned char mreq;		/* /MREQ /RD seen by a profiler sample */
+	unsigned long long t_rel;	/* /WAIT release */
+	unsigned long long t_hold;	/* CLC_ISR entry of a held OUT */
+	unsigned char hold_port;
+	unsigned long long budget_t;	/* Host time the Z80 has been run up to */
+	long long budget;		/* T states it may still run */
+} z;
+
+static struct {
+	unsigned long in, out, queued, held;
+	unsigned long drains;			/* Cycles that ran queued writes first */
+	unsigned long long ns, ns_max;	/* CLC_ISR entry to release, not held */
+	unsigned long long hold_ns;		/* Held: entry to release */
+} st[256];
+static unsigned long long disk_t0, disk_t1;	/* First DISK_CMD, last one done */
+
+static unsigned pic_addr(void)
+{
+	return lat[HAL_LATB] | (lat[HAL_LATD] & 0x3f) << 8 | (lat[HAL_LATE2] & 1) << 14;
+}
+
+/* Upload DMA: DMA1 image -> LATC, DMA2 ramp[] -> LATB, CCP1 /WE each byte */
+static void dma_run(void)
+{
+	const unsigned char *s0, *s1;
+	unsigned i;
+
+	if (!(dma[0].con0 & 0x80) || !(dma[1].con0 & 0x80))
+		return;
+	if (dma[0].dsa != (uint16_t)(uintptr_t)&lat[HAL_LATC]
+		|| dma[1].dsa != (uint16_t)(uintptr_t)&lat[HAL_LATB]) {
+		fprintf(stderr, "cosim: DMA destination not LATC/LATB\r\n");
+		return;
+	}
+	s0 = (const unsigned char *)(uintptr_t)dma[0].ssa;
+	s1 = (const unsigned char *)(uintptr_t)dma[1].ssa;
+	for (i = 0; i < dma[0].ssz; i++) {
+		lat[HAL_LATC] = s0[i];
+		lat[HAL_LATB] = s1[i];
+		if (RA2PPS == PPS_CCP1)
+			ram[pic_addr()] = lat[HAL_LATC];
+	}
+	seen[HAL_LATB] = lat[HAL_LATB];
+	seen[HAL_LATC] = lat[HAL_LATC];
+	dma1scntif = 1;
+}
+
+/* Act on what the firmware wrote since the last call */
+static void hal_sync(void)
+{
+	/* /WE rising, with RA2 on LATA2 when it rose: bus_slave() hands RA2
+	 * back to the CLC right after the last write of a block */
+	if (!seen[HAL_LATA2] && lat[HAL_LATA2] && !ra2pps_seen)
+		ram[pic_addr()] = lat[HAL_LATC];
+	if (!lat[HAL_LATE1])
+		z.run = 0;
+	else if (!seen[HAL_LATE1] || !z.run) {	/* RESET released */
+		z80_reset(&cpu);
+		cpu.mem = ram;
+		if (load_len > 0)
+			memcpy(ram, load, load_len);
+		load_len = -1;
+		z.run = 1;
+		z.stall = z.wait = 0;
+	}
+	memcpy((void *)seen, (void *)lat, sizeof(seen));
+	ra2pps_seen = RA2PPS;
+	if (t2con.ON && !t2_seen)
+		dma_run();
+	t2_seen = t2con.ON;
+}
+
+volatile unsigned char *hal_lat(int pin)
+{
+	hal_busy++;
+	hal_sync();
+	hal_busy--;
+	return &lat[pin];
+}
+
+void hal_nop(void)
+{
+	hal_busy++;
+	hal_sync();
+	hal_busy--;
+}
+
+volatile unsigned char *hal_gie(void)
+{
+	return &gie;
+}
+
+unsigned char hal_portc(void)
+{
+	unsigned char v = 0xff;
+
+	hal_busy++;
+	hal_sync();
+	if (z.io_write)
+		v = z.data;
+	else if (!lat[HAL_LATA4] && !RA4PPS)	/* /OE from LATA4 */
+		v = ram[pic_addr()];
+	hal_busy--;
+	return v;
+}
+
+/* /IORQ RA0, /MREQ RA1, /RD RA5 */
+unsigned char hal_porta(void)
+{
+	return (unsigned char)(0xdc | (RA0 & 1) | (z.mreq ? 0 : 0x02) | (z.mreq ? 0 : (RA5 & 1) << 5));
+}
+
+/* A13-A8, /RFSH high, /WAIT */
+unsigned char hal_portd(void)
+{
+	return (unsigned char)((cpu.pc >> 8 & 0x3f) | 0x40 | (z.wait ? 0 : 0x80));
+}
+
+unsigned char hal_porte(void)
+{
+	return (unsigned char)(cpu.pc >> 12 & 0x04);	/* A14 on RE2 */
+}
+
+/* CLC3 D-FF reset: the Z80 finishes its IO cycle */
+volatile unsigned char *hal_g3pol(void)
+{
+	unsigned long long t;
+
+	if (z.wait) {
+		t = ns();
+		z.wait = 0;
+		z.t_rel = t;
+		if (!z.in_clc) {		/* From a bus job */
+			RA0 = 1;
+			z.stall = 0;
+			st[z.hold_port].hold_ns += t - z.t_hold;
+			if (z.hold_port == DISK_CMD)
+				disk_t1 = t;
+		}
+	}
+	return &g3pol;
+}
+
+/* TMR2 starts the upload DMA and runs until it is stopped */
+volatile struct t2con_bits *hal_t2con(void)
+{
+	hal_busy++;
+	hal_sync();
+	hal_busy--;
+	return &t2con;
+}
+
+volatile unsigned char *hal_tmr2if(void)
+{
+	hal_busy++;
+	hal_sync();
+	if (t2con.ON)
+		tmr2if = 1;
+	hal_busy--;
+	return &tmr2if;
+}
+
+volatile struct dma_regs *hal_dma(void)
+{
+	hal_busy++;
+	hal_sync();
+	hal_busy--;
+	return &dma[DMASELECT & 1];
+}
+
+volatile unsigned char *hal_dma1scntif(void)
+{
+	hal_busy++;
+	hal_sync();
+	hal_busy--;
+	return &dma1scntif;
+}
+
+/* Timers on host time, Fosc/4 = 16MHz */
+
+static unsigned long long tcy(unsigned long long t)
+{
+	return t * 16 / 1000;
+}
+
+static unsigned long long tmr0_count(unsigned long long t)
+{
+	if (!(T0CON0 & 0x80))
+		return 0;
+	return tcy(t) >> (T0CON1 & 0x0f);
+}
+
+volatile unsigned char *hal_tmr0l(void)
+{
+	static volatile unsigned char l;
+	unsigned long long c = tmr0_count(ns());
+
+	TMR0H = (unsigned char)(c >> 8);
+	l = (unsigned char)c;
+	return &l;
+}
+
+uint16_t hal_tmr1(void)
+{
+	return (uint16_t)tcy(ns());
+}
+
+/* UART3: a two byte TX FIFO (TXB and the shift register), RX the same */
+
+static struct {
+	unsigned char txq[2];
+	int txq_n;
+	unsigned long long tx_done;	/* Head byte fully sent */
+	volatile uint16_t txb;		/* 0xffff: nothing written */
+	unsigned char rxq[2];
+	int rxq_n;
+	unsigned long long rx_next;	/* Earliest next RX byte */
+	unsigned char out[4096];
+	int out_n;
+	unsigned char in[256];
+	int in_n, in_p, eof;
+	unsigned long long quiet_t;	/* Last TX byte or input */
+	unsigned long tx_bytes, rx_bytes;
+} u = { .txb = 0xffff };
+
+static int done;
+
+static unsigned long long byte_ns(void)
+{
+	unsigned long div;
+
+	if (fast_uart)
+		return 0;
+	div = U3CON0bits.BRGS ? 4 : 16;
+	return 10ULL * 1000000000ULL * div * (U3BRG + 1UL) / 64000000UL;
+}
+
+static void out_flush(void)
+{
+	int n = 0, k;
+
+	while (n < u.out_n) {
+		k = (int)write(1, u.out + n, u.out_n - n);
+		if (k <= 0)
+			break;
+		n += k;
+	}
+	u.out_n = 0;
+}
+
+static void tx_update(unsigned long long t)
+{
+	while (u.txq_n && t >= u.tx_done) {
+		if (u.out_n == sizeof(u.out))
+			out_flush();
+		u.out[u.out_n++] = u.txq[0];
+		u.tx_bytes++;
+		u.quiet_t = t;
+		u.txq[0] = u.txq[1];
+		u.tx_done += byte_ns();
+		u.txq_n--;
+	}
+	if (u.txb != 0xffff && u.txq_n < 2) {	/* Written to U3TXB */
+		if (!u.txq_n)
+			u.tx_done = t + byte_ns();
+		u.txq[u.txq_n++] = (unsigned char)u.txb;
+		u.txb = 0xffff;
+		if (!byte_ns())
+			tx_update(t);
+	}
+}
+
+volatile uint16_t *hal_u3txb(void)
+{
+	hal_busy++;
+	tx_update(ns());
+	if (u.txb != 0xffff) {		/* Written while full: overrun */
+		fprintf(stderr, "cosim: U3TXB written while full\r\n");
+		u.txb = 0xffff;
+	}
+	hal_busy--;
+	return &u.txb;
+}
+
+unsigned char hal_u3txif(void)
+{
+	unsigned char r;
+
+	hal_busy++;
+	tx_update(ns());
+	r = u.txb == 0xffff && u.txq_n < 2;
+	hal_busy--;
+	return r;
+}
+
+unsigned char hal_u3txmtif(void)
+{
+	unsigned char r;
+
+	hal_busy++;
+	tx_update(ns());
+	r = u.txb == 0xffff && !u.txq_n;
+	hal_busy--;
+	return r;
+}
+
+/* Host input, one byte at a time once the firmware has taken the last */
+static void rx_feed(unsigned long long t)
+{
+	struct pollfd pfd = { 0, POLLIN, 0 };
+	unsigned char c;
+	int n;
+
+	if (u.rxq_n || rx_wp != rx_rp || t < u.rx_next)
+		return;
+	if (u.in_p == u.in_n && !u.eof) {
+		if (poll(&pfd, 1, 0) <= 0)
+			return;
+		n = (int)read(0, u.in, sizeof(u.in));
+		if (n <= 0) {
+			u.eof = 1;
+			return;
+		}
+		u.in_n = n;
+		u.in_p = 0;
+	}
+	if (u.in_p == u.in_n)
+		return;
+	c = u.in[u.in_p++];
+	if (c == EXIT_KEY) {
+		done = 1;
+		return;
+	}
+	u.rxq[u.rxq_n++] = c;
+	u.rx_bytes++;
+	u.quiet_t = t;
+	u.rx_next = t + byte_ns();
+}
+
+unsigned char hal_u3rxif(void)
+{
+	unsigned char r;
+
+	hal_busy++;
+	rx_feed(ns());
+	r = u.rxq_n != 0;
+	hal_busy--;
+	return r;
+}
+
+unsigned char hal_u3rxb(void)
+{
+	unsigned char c;
+
+	if (!u.rxq_n)
+		return 0;
+	c = u.rxq[0];
+	u.rxq[0] = u.rxq[1];
+	u.rxq_n--;
+	return c;
+}
+
+/* SD card on SPI1, SDHC in SPI mode backed by a file */
+
+static struct {
+	int fd;
+	unsigned long long blocks;
+	unsigned char cmd[6];
+	int ncmd;
+	int idle, app;
+	unsigned char resp[520];
+	int rn, rp;
+	int wr;					/* 0 none, 1 waiting for a token, 2 data */
+	uint32_t wlba;
+	unsigned char wbuf[514];
+	int wn;
+	unsigned long cmds, rd_blocks, wr_blocks, spi_bytes;
+	volatile uint16_t txb;	/* 0xffff: nothing written */
+	unsigned char rxb;
+} sd = { .fd = -1, .txb = 0xffff };
+
+static void sd_resp(const unsigned char *p, int n)
+{
+	sd.rn = sd.rp = 0;
+	sd.resp[sd.rn++] = 0xff;	/* NCR */
+	memcpy(sd.resp + sd.rn, p, n);
+	sd.rn += n;
+}
+
+static void sd_command(void)
+{
+	uint32_t arg = (uint32_t)sd.cmd[1] << 24 | sd.cmd[2] << 16 | sd.cmd[3] << 8 | sd.cmd[4];
+	unsigned char r[4 + 2 + 512 + 2];
+	unsigned char c = sd.cmd[0] & 0x3f, app = sd.app;
+
+	sd.cmds++;
+	sd.app = 0;
+	r[0] = sd.idle ? 0x01 : 0x00;
+	switch (c) {
+	case 0:						/* GO_IDLE_STATE */
+		sd.idle = 1;
+		r[0] = 0x01;
+		sd_resp(r, 1);
+		return;
+	case 8:						/* SEND_IF_COND */
+		r[1] = 0;
+		r[2] = 0;
+		r[3] = 0x01;
+		r[4] = 0xaa;
+		sd_resp(r, 5);
+		return;
+	case 55:					/* APP_CMD */
+		sd.app = 1;
+		sd_resp(r, 1);
+		return;
+	case 41:					/* SD_SEND_OP_COND */
+		if (app)
+			sd.idle = 0;
+		r[0] = app ? 0x00 : 0x05;
+		sd_resp(r, 1);
+		return;
+	case 58:					/* READ_OCR, CCS set */
+		r[1] = 0xc0;
+		r[2] = 0xff;
+		r[3] = 0x80;
+		r[4] = 0x00;
+		sd_resp(r, 5);
+		return;
+	case 16:					/* SET_BLOCKLEN */
+		sd_resp(r, 1);
+		return;
+	case 17:					/* READ_SINGLE_BLOCK */
+		if (arg >= sd.blocks) {
+			r[0] = 0x20;		/* Address error */
+			sd_resp(r, 1);
+			return;
+		}
+		r[1] = 0xff;
+		r[2] = 0xfe;
+		if (pread(sd.fd, r + 3, 512, (off_t)arg * 512) != 512)
+			memset(r + 3, 0, 512);
+		r[515] = r[516] = 0xff;
+		sd.rd_blocks++;
+		sd_resp(r, 517);
+		return;
+	case 25:					/* WRITE_MULTIPLE_BLOCK */
+		if (arg >= sd.blocks) {
+			r[0] = 0x20;
+			sd_resp(r, 1);
+			return;
+		}
+		sd.wr = 1;
+		sd.wlba = arg;
+		sd_resp(r, 1);
+		return;
+	}
+	r[0] |= 0x04;				/* Illegal command */
+	sd_resp(r, 1);
+}
+
+static unsigned char sd_xfer(unsigned char d)
+{
+	unsigned char r = 0xff;
+	static const unsigned char busy[4] = { 0x00, 0x00, 0x00, 0xff };
+	unsigned char a[5];
+
+	sd.spi_bytes++;
+	if (sd.fd < 0 || hal_sd_cs) {
+		sd.ncmd = 0;
+		return 0xff;
+	}
+	if (sd.rp < sd.rn)
+		r = sd.resp[sd.rp++];
+	if (sd.wr == 1) {
+		if (d == 0xfc) {		/* Data token */
+			sd.wr = 2;
+			sd.wn = 0;
+		} else if (d == 0xfd) {	/* Stop token */
+			sd.wr = 0;
+			sd_resp(busy, sizeof(busy));
+		}
+		return r;
+	}
+	if (sd.wr == 2) {
+		sd.wbuf[sd.wn++] = d;
+		if (sd.wn < 514)
+			return r;
+		a[0] = 0xe5;			/* Data accepted */
+		memcpy(a + 1, busy, sizeof(busy));
+		if (sd.wlba >= sd.blocks
+			|| pwrite(sd.fd, sd.wbuf, 512, (off_t)sd.wlba * 512) != 512)
+			a[0] = 0xed;		/* Write error */
+		sd.wlba++;
+		sd.wr_blocks++;
+		sd.wr = 1;
+		sd_resp(a, sizeof(a));
+		sd.rp = 1;				/* Right after the CRC */
+		return r;
+	}
+	if (!sd.ncmd && (d & 0xc0) != 0x40)
+		return r;
+	sd.cmd[sd.ncmd++] = d;
+	if (sd.ncmd == 6) {
+		sd.ncmd = 0;
+		sd_command();
+	}
+	return r;
+}
+
+volatile uint16_t *hal_spi1txb(void)
+{
+	if (sd.txb != 0xffff)
+		sd.rxb = sd_xfer((unsigned char)sd.txb);
+	sd.txb = 0xffff;
+	return &sd.txb;
+}
+
+unsigned char hal_spi1rxif(void)
+{
+	if (sd.txb != 0xffff) {
+		sd.rxb = sd_xfer((unsigned char)sd.txb);
+		sd.txb = 0xffff;
+	}
+	return 1;
+}
+
+unsigned char hal_spi1rxb(void)
+{
+	hal_spi1rxif();
+	return sd.rxb;
+}
+
+/* Data EEPROM */
+
+static unsigned char ee[EE_SIZE];
+static const char *ee_path;
+static volatile struct nvmcon0_bits nvmcon0;
+
+volatile struct nvmcon0_bits *hal_nvmcon0(void)
+{
+	uint32_t a = NVMADR - EE_BASE;
+
+	if (nvmcon0.GO) {
+		if (a < EE_SIZE) {
+			if (NVMCON1bits.CMD == 0x00)
+				NVMDATL = ee[a];
+			else if (NVMCON1bits.CMD == 0x03)
+				ee[a] = NVMDATL;
+		}
+		nvmcon0.GO = 0;
+	}
+	return &nvmcon0;
+}
+
+static void ee_save(void)
+{
+	FILE *f;
+
+	if (!ee_path || !(f = fopen(ee_path, "wb")))
+		return;
+	fwrite(ee, 1, sizeof(ee), f);
+	fclose(f);
+}
+
+/* printf of XC8: %lu and friends take 32 bits */
+int pic_printf(const char *fmt, ...)
+{
+	char f[256], buf[512];
+	const char *p;
+	int n = 0, spec = 0, i;
+	va_list ap;
+
+	for (p = fmt; *p && n < (int)sizeof(f) - 1; p++) {
+		if (spec && *p == 'l')
+			continue;
+		if (*p == '%')
+			spec = !spec;
+		else if (spec && strchr("diouxXcsfeEgGp", *p))
+			spec = 0;
+		f[n++] = *p;
+	}
+	f[n] = 0;
+	va_start(ap, fmt);
+	n = vsnprintf(buf, sizeof(buf), f, ap);
+	va_end(ap);
+	for (i = 0; i < n && i < (int)sizeof(buf) - 1; i++)
+		putch(buf[i]);
+	return n;
+}
+
+/* Z80 IO cycles */
+
+/* /IORQ rising edge after an IN or acknowledge, then the next opcode fetch */
+static void iorq_edge(void)
+{
+	z.edge = 0;
+	RA0 = 1;
+	if (IOCIE) {
+		IOCAF0 = 1;
+		if (gie)				/* High priority, masked by GIE only */
+			IORQ_ISR();
+	}
+	if (!TRISC)
+		z.clash++;
+}
+
+/* -r: the main loop runs a queued write, the pending edge comes now */
+static io_wr_t wq_wr[256];
+
+static void wq_edge_wr(unsigned char port, unsigned char data)
+{
+	wq_wr[port](port, data);
+	if (z.edge && !z.in_clc) {
+		hal_busy++;
+		z.edges++;
+		iorq_edge();
+		hal_busy--;
+	}
+}
+
+static unsigned char io_cycle(unsigned char port, unsigned char data, int kind)
+{
+	unsigned long long t0;
+	unsigned char wp = io_wq_wp, rp = io_wq_rp, v = 0xff;
+
+	PORTB = port;
+	RA5 = kind != 0;			/* /RD high: OUT or acknowledge */
+	hal_z80_m1 = kind != 2;
+	z.io_write = kind == 1;
+	z.data = data;
+	RA0 = 0;
+	z.wait = 1;
+	CLC3IF = 1;
+	z.in_clc = 1;
+	t0 = ns();
+	CLC_ISR();
+	z.in_clc = 0;
+	z.io_write = 0;
+	hal_z80_m1 = 1;
+	if (io_wq_rp != rp)
+		st[port].drains++;
+	if (kind == 1 && port == DISK_CMD && !st[port].out)
+		disk_t0 = t0;
+	if (kind == 1)
+		st[port].out++;
+	else if (!kind)
+		st[port].in++;
+	if (z.wait) {				/* Held for a bus job */
+		z.stall = 1;
+		z.t_hold = t0;
+		z.hold_port = port;
+		st[port].held++;
+		return 0xff;
+	}
+	st[port].ns += z.t_rel - t0;
+	if (z.t_rel - t0 > st[port].ns_max)
+		st[port].ns_max = z.t_rel - t0;
+	if (io_wq_wp != wp) {
+		st[port].queued++;
+		if (iorq_case && io_wr[port] != wq_edge_wr) {
+			wq_wr[port] = io_wr[port];
+			io_wr[port] = wq_edge_wr;
+		}
+	}
+	if (kind == 1) {
+		RA0 = 1;
+		return v;
+	}
+	v = TRISC ? 0xff : lat[HAL_LATC];
+	if (iorq_case && io_wq_wp != io_wq_rp) {
+		z.edge = 1;				/* Stop until a queued write runs */
+		z.budget = 0;
+	} else
+		iorq_edge();
+	return v;
+}
+
+static unsigned char z_in(void *ctx, unsigned short port)
+{
+	(void)ctx;
+	return io_cycle((unsigned char)port, 0xff, 0);
+}
+
+static void z_out(void *ctx, unsigned short port, unsigned char v)
+{
+	(void)ctx;
+	io_cycle((unsigned char)port, v, 1);
+}
+
+static double z80_hz(void)
+{
+	return NCO1INC * 30.5175781;
+}
+
+/* Run the Z80 for the host time since the last call */
+static void z80_run(unsigned long long t)
+{
+	long long cap = (long long)(z80_hz() / 1000);	/* At most 1ms behind */
+	unsigned long long end = t + TICK_US * 800;
+	unsigned long n = 0;
+	unsigned char v;
+
+	if (flat_out)
+		z.budget = 1LL << 40;
+	else {
+		z.budget += (long long)((t - z.budget_t) * z80_hz() / 1e9);
+		if (z.budget > cap)
+			z.budget = cap;
+	}
+	z.budget_t = t;
+	if (z.edge)
+		iorq_edge();
+	while (z.budget > 0) {
+		if (!z.run || z.stall || !lat[HAL_LATE0] || !gie || !CLC3IE) {
+			z.budget = 0;
+			return;
+		}
+		if (!hal_z80_int && cpu.iff1 && !cpu.ei_delay) {
+			v = io_cycle(0xff, 0xff, 2);	/* Acknowledge, /IORQ with /M1 */
+			z.budget -= z80_int(&cpu, v);
+			continue;
+		}
+		z.budget -= z80_step(&cpu);
+		if (limit_insns && cpu.insns >= limit_insns)
+			done = 1;
+		if (flat_out && !(++n & 0xff) && ns() > end)	/* HALT counts no insns */
+			break;
+	}
+}
+
+/* Interrupts */
+
+static unsigned long long tim_ovf, tick_ms, prof_t;
+
+static void report(void);
+
+static void tick(int sig)
+{
+	unsigned long long t, c;
+	int n;
+
+	(void)sig;
+	if (hal_busy)
+		return;
+	t = ns();
+	hal_sync();
+	tx_update(t);
+	rx_feed(t);
+	if (u.out_n)
+		out_flush();
+	if ((limit_ns && t >= limit_ns)
+		|| (batch && cpu.insns && u.eof && u.in_p == u.in_n && !u.rxq_n && rx_wp == rx_rp
+			&& !u.txq_n && t - u.quiet_t > QUIET_NS))
+		done = 1;
+	if (done)
+		report();
+	if (!gie)
+		return;
+	if (IOCIE && IOCAF0)		/* An edge GIE held back */
+		IORQ_ISR();
+	z80_run(t);
+	if (!INTCON0bits.GIEL)
+		return;
+	c = tmr0_count(t) >> 16;
+	if (c != tim_ovf) {
+		tim_ovf = c;
+		TMR0IF = 1;
+	}
+	if (TMR0IF && TMR0IE)
+		TIM_ISR();
+	if (T4CON & 0x80) {
+		for (n = 0; tick_ms < t / 1000000 && n < 10; n++, tick_ms++) {
+			TMR4IF = 1;
+			if (TMR4IE)
+				TICK_ISR();
+		}
+		tick_ms = t / 1000000;
+	}
+	if (U3RXIE && u.rxq_n)
+		UART_RX_ISR();
+	if (U3TXIE && hal_u3txif())
+		UART_TX_ISR();
+	if (U3IE && U3ERRIEbits.TXMTIE && hal_u3txmtif())
+		UART_TXMT_ISR();
+	if (PROF_ISR && (T6CON & 0x80) && TMR6IE) {
+		for (n = 0; prof_t + (T6PR + 1) * 1000ULL <= t && n < 10; n++) {
+			prof_t += (T6PR + 1) * 1000ULL;
+			z.mreq = z.run && !z.stall && !cpu.halted;	/* A fetch at PC */
+			PORTB = (unsigned char)cpu.pc;
+			TMR6IF = 1;
+			PROF_ISR();
+			z.mreq = 0;
+		}
+		if (n == 10)
+			prof_t = t;
+	} else
+		prof_t = t;
+}
+
+void hal_reset(void)
+{
+	out_flush();
+	ee_save();
+	fprintf(stderr, "\r\ncosim: PIC reset\r\n");
+	if (raw_tty)
+		tcsetattr(0, TCSANOW, &saved_tio);
+	execv("/proc/self/exe", saved_argv);
+	perror("cosim: reset");
+	_exit(1);
+}
+
+/* Report, at the end */
+
+static void report(void)
+{
+	unsigned long long t = ns(), in = 0, out = 0, q = 0, held = 0, dr = 0, sum = 0, max = 0;
+	int p;
+
+	signal(SIGALRM, SIG_IGN);
+	tx_update(t);
+	out_flush();
+	if (raw_tty)
+		tcsetattr(0, TCSANOW, &saved_tio);
+	ee_save();
+	fprintf(stderr, "\r\ncosim: %llu instructions, %llu T states (%.3f s at %.3f MHz), %.3f s host\r\n",
+		cpu.insns, cpu.cycles, cpu.cycles / z80_hz(), z80_hz() / 1e6, t / 1e9);
+	fprintf(stderr, "cosim: UART %lu bytes out, %lu in\r\n", u.tx_bytes, u.rx_bytes);
+	fprintf(stderr, "cosim: CLC_ISR entry to /WAIT release, host ns (held OUTs: until the job releases it)\r\n");
+	fprintf(stderr, "port        IN       OUT    queued      held    drains   mean ns    max ns  held us\r\n");
+	for (p = 0; p < 256; p++) {
+		unsigned long n = st[p].in + st[p].out - st[p].held;
+
+		if (!st[p].in && !st[p].out)
+			continue;
+		fprintf(stderr, "  %02X %9lu %9lu %9lu %9lu %9lu %9llu %9llu %8.1f\r\n", p,
+			st[p].in, st[p].out, st[p].queued, st[p].held, st[p].drains,
+			n ? st[p].ns / n : 0, st[p].ns_max,
+			st[p].held ? st[p].hold_ns / 1e3 / st[p].held : 0.0);
+		in += st[p].in;
+		out += st[p].out;
+		q += st[p].queued;
+		held += st[p].held;
+		dr += st[p].drains;
+		sum += st[p].ns;
+		if (st[p].ns_max > max)
+			max = st[p].ns_max;
+	}
+	fprintf(stderr, " all %9llu %9llu %9llu %9llu %9llu %9llu %9llu\r\n", in, out, q, held, dr,
+		in + out - held ? sum / (in + out - held) : 0, max);
+	if (sd.fd >= 0)
+		fprintf(stderr, "cosim: SD %lu commands, %lu blocks read, %lu written, %lu SPI bytes (%.1f ms at 8MHz)\r\n",
+			sd.cmds, sd.rd_blocks, sd.wr_blocks, sd.spi_bytes, sd.spi_bytes / 1e3);
+	if (iorq_case)
+		fprintf(stderr, "cosim: %lu IN /IORQ edges during a queued write\r\n", z.edges);
+	if (iorq_case || z.clash)
+		fprintf(stderr, "cosim: %lu opcode fetches with the PIC driving D7-D0\r\n", z.clash);
+	if (disk_t1 > disk_t0)
+		fprintf(stderr, "cosim: DISK_CMD %lu sectors in %.3f s host, %.0f sectors/s\r\n",
+			st[DISK_CMD].out, (disk_t1 - disk_t0) / 1e9, st[DISK_CMD].out * 1e9 / (disk_t1 - disk_t0));
+	_exit(z.clash ? 1 : 0);
+}
+
+int main(int argc, char **argv)
+{
+	struct sigaction sa;
+	struct itimerval it;
+	struct termios tio;
+	const char *card = NULL;
+	FILE *f;
+	int i;
+
+	saved_argv = argv;
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-b"))
+			batch = 1;
+		else if (!strcmp(argv[i], "-f"))
+			fast_uart = 1;
+		else if (!strcmp(argv[i], "-F"))
+			flat_out = 1;
+		else if (!strcmp(argv[i], "-r"))
+			iorq_case = 1;
+		else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+			card = argv[++i];
+		else if (!strcmp(argv[i], "-e") && i + 1 < argc)
+			ee_path = argv[++i];
+		else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+			if (!(f = fopen(argv[++i], "rb"))) {
+				perror(argv[i]);
+				return 1;
+			}
+			load_len = (long)fread(load, 1, sizeof(load), f);
+			fclose(f);
+		} else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			limit_insns = strtoull(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			limit_ns = (unsigned long long)(atof(argv[++i]) * 1e9);
+		else {
+			fprintf(stderr, "usage: cosim [-b] [-f] [-F] [-r] [-d CARD] [-e EEPROM] [-l BIN] [-n INSNS] [-t SECS]\n");
+			return 2;
+		}
+	}
+	memset(ee, 0xff, sizeof(ee));
+	if (ee_path && (f = fopen(ee_path, "rb"))) {
+		if (fread(ee, 1, sizeof(ee), f) != sizeof(ee))
+			memset(ee, 0xff, sizeof(ee));
+		fclose(f);
+	}
+	if (card) {
+		if ((sd.fd = open(card, O_RDWR)) < 0) {
+			perror(card);
+			return 1;
+		}
+		sd.blocks = (unsigned long long)lseek(sd.fd, 0, SEEK_END) / 512;
+	}
+	if (!batch && isatty(0) && !tcgetattr(0, &saved_tio)) {
+		tio = saved_tio;
+		cfmakeraw(&tio);
+		tcsetattr(0, TCSANOW, &tio);
+		raw_tty = 1;
+	}
+	fcntl(0, F_SETFL, fcntl(0, F_GETFL) | O_NONBLOCK);
+	z80_reset(&cpu);
+	cpu.mem = ram;
+	cpu.in = z_in;
+	cpu.out = z_out;
+	RA0 = RA5 = 1;
+	lat[HAL_LATA2] = lat[HAL_LATA4] = seen[HAL_LATA2] = seen[HAL_LATA4] = 1;
+
+	clock_gettime(CLOCK_MONOTONIC, &t_start);
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = tick;
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGALRM, &sa, NULL);
+	it.it_interval.tv_sec = it.it_value.tv_sec = 0;
+	it.it_interval.tv_usec = it.it_value.tv_usec = TICK_US;
+	setitimer(ITIMER_REAL, &it, NULL);
+
+	pic_main();
+	return 0;
+}
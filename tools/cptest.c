@@ -0,0 +1,404 @@
+/*
+ * cptest - check the arithmetic coprocessor code of emuz80_z80ram.c
+ * against the BASIC ROM routines it replaces
+ *
+ * Build (from the top of the tree, cpmath.h is the firmware's code):
+ *   sed -n -f tools/cpmath.sed emuz80_z80ram.c > cpmath.h
+ *   cc -O2 -I. -o cptest tools/cptest.c
+ *
+ * Usage: cptest [-n N] [-s SEED] ROM
+ *   ROM      emuz80_z80ram.c (its first image_segs[] row, EMUBASIC) or the
+ *            8KB emubasic.bin
+ *   -n N     random operands per operation (default 100000)
+ *   -s SEED  random seed (default 1)
+ *
+ *   cptest emuz80_z80ram.c
+ *
+ * FPADD, SUBCDE, FPMULT, DVBCDE, SQR and MLDEBC of the unpatched ROM run
+ * on tools/z80.h with FPREG..SGNRES and BCDE set from the operands, up to
+ * the return or the ?OV, ?/0, ?FC or ?BS error entry, and cp_exec() gets
+ * the same bytes. The FPREG..SGNRES bytes and the error must match. The
+ * integer operations the ROM has no routine for are checked against 64-bit
+ * host arithmetic. Each operation prints its case and mismatch counts and
+ * the first few mismatches; the exit status is 1 if there was any.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cpmath.h"
+#include "lz.h"
+#include "z80.h"
+
+#define ROM_SIZE	0x2000
+#define INITAB		0x0324		/* Copied to WRKSPC on a cold start */
+#define WRKSPC		0x2045
+#define INIT_LEN	0x63
+#define FPREG		0x2129		/* FPREG..FPEXP, SGNRES */
+#define OVERR		0x0402
+#define DZERR		0x03f6
+#define FCERR		0x0912
+#define BSERR		0x0fc6
+#define RET_ADDR	0x3fff		/* Pushed as the caller */
+#define MAX_INSNS	2000000L
+#define MAX_SHOWN	5
+
+static unsigned char rom[ROM_SIZE], mem[0x10000];
+static unsigned long long seed = 1;
+
+/* ROM entries and the coprocessor operations that stand in for them */
+static const struct {
+	const char *name;
+	unsigned short entry;
+	unsigned char cmd;
+} fp_ops[] = {
+	{ "FPADD", 0x1454, CP_FADD },
+	{ "SUBCDE", 0x1451, CP_FSUB },
+	{ "FPMULT", 0x158f, CP_FMUL },
+	{ "DVBCDE", 0x15f0, CP_FDIV },
+	{ "SQR", 0x1933, CP_FSQR },
+};
+#define MLDEBC		0x1786
+
+static const char *const int_names[] = {
+	"MUL16U", "MUL16S", "DIV16U", "DIV16S", "MUL32U", "MUL32S", "DIV32U", "DIV32S",
+};
+
+/* xorshift64 */
+static unsigned long long rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed;
+}
+
+static unsigned char z_in(void *ctx, unsigned short port)
+{
+	(void)ctx;
+	(void)port;
+	return 0xff;
+}
+
+static void z_out(void *ctx, unsigned short port, unsigned char v)
+{
+	(void)ctx;
+	(void)port;
+	(void)v;
+}
+
+/* Bytes of the first image_segs[] row of a firmware source, -1 on error */
+static long c_rom(const char *text, unsigned char *out, long max)
+{
+	static unsigned char data[LZ_BOUND(ROM_SIZE)];
+	char key[80], arr[40];
+	const char *p = strstr(text, "image_segs[] = {"), *e;
+	unsigned addr, len, crc, lz;
+	long n = 0;
+
+	while (p && (p = strchr(p, '\n')) && *++p == '/')
+		;					/* comment rows */
+	if (!p || sscanf(p, " { %x, %x, %x, %u, %39[A-Za-z0-9_] }", &addr, &len, &crc, &lz, arr) != 5 || addr)
+		return -1;
+	snprintf(key, sizeof(key), "unsigned char %s[] = {", arr);
+	if (!(p = strstr(text, key)))
+		return -1;
+	for (p += strlen(key); *p && *p != '}'; ) {
+		if (p[0] == '/' && p[1] == '/') {
+			if (!(p = strchr(p, '\n')))
+				break;
+			continue;
+		}
+		if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+			if (n >= (long)sizeof(data))
+				return -1;
+			data[n++] = (unsigned char)strtoul(p, (char **)&e, 16);
+			p = e;
+			continue;
+		}
+		p++;
+	}
+	if (lz)
+		return lz_decompress(data, n, out, max);
+	memcpy(out, data, n < max ? n : max);
+	return n;
+}
+
+static void load(const char *path)
+{
+	FILE *fp = fopen(path, "rb");
+	const char *ext = strrchr(path, '.');
+	char *text;
+	long size, n;
+
+	if (!fp) {
+		perror(path);
+		exit(2);
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	rewind(fp);
+	if (!(text = malloc(size + 1)) || fread(text, 1, size, fp) != (size_t)size) {
+		perror(path);
+		exit(2);
+	}
+	text[size] = '\0';
+	fclose(fp);
+	if (ext && !strcmp(ext, ".c"))
+		n = c_rom(text, rom, ROM_SIZE);
+	else
+		memcpy(rom, text, (n = size) < ROM_SIZE ? size : ROM_SIZE);
+	free(text);
+	if (n < ROM_SIZE) {
+		fprintf(stderr, "%s: no %d byte BASIC ROM\n", path, ROM_SIZE);
+		exit(2);
+	}
+}
+
+/*
+ * Call a ROM routine with FPREG..SGNRES from fp and BCDE, leaving them in
+ * fp. Returns the error as cp_exec() reports it, or -1 if it never returns.
+ */
+static int rom_call(unsigned short entry, unsigned char *fp, unsigned long bcde, unsigned short *hl)
+{
+	struct z80 c;
+	long n;
+
+	memcpy(mem, rom, ROM_SIZE);
+	memcpy(mem + WRKSPC, rom + INITAB, INIT_LEN);
+	memcpy(mem + FPREG, fp, 5);
+	z80_reset(&c);
+	c.mem = mem;
+	c.in = z_in;
+	c.out = z_out;
+	c.r[Z80_B] = (unsigned char)(bcde >> 24);
+	c.r[Z80_C] = (unsigned char)(bcde >> 16);
+	c.r[Z80_D] = (unsigned char)(bcde >> 8);
+	c.r[Z80_E] = (unsigned char)bcde;
+	c.sp = 0x8000;
+	z80_push(&c, RET_ADDR);
+	c.pc = entry;
+	for (n = 0; n < MAX_INSNS; n++) {
+		switch (c.pc) {
+		case RET_ADDR:
+			memcpy(fp, mem + FPREG, 5);
+			*hl = Z80_PAIR(&c, Z80_H);
+			return 0;
+		case OVERR:
+		case BSERR:
+			return CP_OV;
+		case DZERR:
+			return CP_DZ;
+		case FCERR:
+			return CP_FC;
+		}
+		z80_step(&c);
+	}
+	return -1;
+}
+
+/* A BASIC number, biased towards the edge cases of the mantissa */
+static unsigned long rnd_fp(unsigned lo, unsigned n)
+{
+	unsigned long v = (unsigned long)rnd() & 0xffffffffUL;
+
+	switch (rnd() % 8) {
+	case 0:
+		v &= 0xff00ffffUL;
+		break;
+	case 1:
+		v |= 0x007fffffUL;
+		break;
+	case 2:
+		v &= 0xff800000UL;
+		break;
+	case 3:
+		v = (v & 0xff800000UL) | 0x7fff00 | (rnd() & 0xff);
+		break;
+	}
+	if (n)
+		v = (v & 0xffffff) | (unsigned long)(lo + rnd() % n) << 24;
+	if (!(rnd() % 64))
+		v &= 0xffffff;			/* Zero */
+	return v;
+}
+
+/* Start of a mismatch line: operation and operands */
+static void show(const char *name, unsigned long a, unsigned long b)
+{
+	printf("%-7s %08lx %08lx: ", name, a, b);
+}
+
+static void put_op(unsigned char *op, unsigned long a, unsigned long b)
+{
+	cp_put(op, (uint32_t)a);
+	cp_put(op + 4, (uint32_t)b);
+}
+
+/* FPREG, SGNRES and BCDE to the ROM and to cp_exec(), 1 on a mismatch */
+static int fp_case(int i, unsigned long x, unsigned char sgn, unsigned long y, int shown)
+{
+	unsigned char fp[5], op[9], res[8];
+	unsigned short hl;
+	int re, ce;
+
+	cp_put(fp, (uint32_t)x);
+	fp[4] = sgn;
+	memcpy(op, fp, 5);
+	cp_put(op + 5, (uint32_t)y);
+	re = rom_call(fp_ops[i].entry, fp, y, &hl);
+	ce = cp_exec(fp_ops[i].cmd, op, res);
+	if (re == ce && (re || !memcmp(fp, res, 5)))
+		return 0;
+	if (shown < MAX_SHOWN) {
+		show(fp_ops[i].name, x, y);
+		printf("ROM %d %02x%02x%02x%02x %02x, PIC %d %02x%02x%02x%02x %02x\n",
+			re, fp[3], fp[2], fp[1], fp[0], fp[4], ce, res[3], res[2], res[1], res[0], res[4]);
+	}
+	return 1;
+}
+
+/* MLDEBC: HL = DE * BC, ?BS past 64K, against CP_MUL16U */
+static int mul_case(unsigned long de, unsigned long bc, int shown)
+{
+	unsigned char fp[5] = { 0 }, op[9] = { 0 }, res[8];
+	unsigned short hl = 0;
+	unsigned long p;
+	int re;
+
+	re = rom_call(MLDEBC, fp, bc << 16 | de, &hl);
+	put_op(op, de, bc);
+	cp_exec(CP_MUL16U, op, res);
+	p = cp_get(res);
+	if (re == CP_OV ? p > 0xffff : !re && p == hl)
+		return 0;
+	if (shown < MAX_SHOWN) {
+		show("MLDEBC", de, bc);
+		printf("ROM %d %04x, PIC %08lx\n", re, hl, p);
+	}
+	return 1;
+}
+
+/* Integer operations against the host, 1 on a mismatch */
+static int int_case(unsigned char cmd, unsigned long a, unsigned long b, int shown)
+{
+	unsigned char op[9] = { 0 }, res[8];
+	unsigned long long ref = 0, got;
+	long long sa, sb;
+	int wide = cmd >= CP_MUL32U, st, want = 0;
+
+	put_op(op, a, b);
+	st = cp_exec(cmd, op, res);
+	got = cp_get(res) | (unsigned long long)cp_get(res + 4) << 32;
+	sa = wide ? (int32_t)a : (int16_t)a;
+	sb = wide ? (int32_t)b : (int16_t)b;
+	if (!wide) {
+		a &= 0xffff;
+		b &= 0xffff;
+	}
+	switch (cmd) {
+	case CP_MUL16U:
+		ref = (uint32_t)(a * b);
+		break;
+	case CP_MUL16S:
+		ref = (uint32_t)(sa * sb);
+		break;
+	case CP_MUL32U:
+		ref = (unsigned long long)a * b;
+		break;
+	case CP_MUL32S:
+		ref = (unsigned long long)(sa * sb);
+		break;
+	default:
+		if (cmd & 1 ? !sb : !b)
+			want = CP_DZ;
+		else if (cmd & 1) {
+			ref = (uint32_t)(sa / sb) | (unsigned long long)(uint32_t)(sa % sb) << 32;
+			if (sa / sb == (wide ? 0x80000000LL : 0x8000))
+				want = CP_OV;
+		} else
+			ref = (a / b) | (unsigned long long)(a % b) << 32;
+		if (!wide)				/* Quotient at 0-1, remainder at 4-5 */
+			got &= ref &= 0x0000ffff0000ffffULL;
+	}
+	if (st == want && (want || got == ref))
+		return 0;
+	if (shown < MAX_SHOWN) {
+		show(int_names[cmd], a, b);
+		printf("status %d, %016llx, expected %d, %016llx\n", st, got, want, ref);
+	}
+	return 1;
+}
+
+/* A 32-bit operand, often near zero or the ends of the range */
+static unsigned long rnd_int(void)
+{
+	static const unsigned long edge[] = {
+		0, 1, 0xffffffffUL, 0x7fffffffUL, 0x80000000UL, 0x7fff, 0x8000, 0xffff, 0xffff8000UL,
+	};
+
+	switch (rnd() % 4) {
+	case 0:
+		return edge[rnd() % (sizeof(edge) / sizeof(edge[0]))];
+	case 1:
+		return (unsigned long)rnd() & 0xff;
+	}
+	return (unsigned long)rnd() & 0xffffffffUL;
+}
+
+int main(int argc, char **argv)
+{
+	long n = 100000, k;
+	int i, bad, total = 0;
+	unsigned char cmd;
+	unsigned long x, y;
+
+	for (i = 1; i < argc - 1 && argv[i][0] == '-'; i += 2) {
+		if (!strcmp(argv[i], "-n"))
+			n = atol(argv[i + 1]);
+		else if (!strcmp(argv[i], "-s"))
+			seed = strtoull(argv[i + 1], NULL, 0) | 1;
+		else
+			break;
+	}
+	if (i != argc - 1) {
+		fprintf(stderr, "usage: cptest [-n N] [-s SEED] ROM\n");
+		return 2;
+	}
+	load(argv[i]);
+
+	for (i = 0; i < (int)(sizeof(fp_ops) / sizeof(fp_ops[0])); i++) {
+		for (bad = 0, k = 0; k < n; k++) {
+			cmd = fp_ops[i].cmd;
+			if (cmd == CP_FSQR) {			/* LOG and EXP over the whole range */
+				x = rnd_fp(0, 0x100);
+				if (rnd() % 8 == 0)
+					x |= 0x800000;			/* ?FC */
+			} else
+				x = rnd_fp(cmd == CP_FADD || cmd == CP_FSUB ? 0x60 : 0, cmd == CP_FADD || cmd == CP_FSUB ? 0x40 : 0x100);
+			y = rnd_fp(0, 0);
+			if ((cmd == CP_FADD || cmd == CP_FSUB) && rnd() % 4 == 0) {
+				y = (y & 0xffffff) | (x & 0xff000000UL);	/* Equal exponents */
+				if (rnd() & 1)				/* and nearly equal mantissas */
+					y = (y & 0xff000000UL) | ((x & 0xffffff) ^ (rnd() & 0x800007));
+			}
+			bad += fp_case(i, x, (unsigned char)rnd(), y, bad);
+		}
+		printf("%-7s %ld cases, %d mismatches\n", fp_ops[i].name, n, bad);
+		total += bad;
+	}
+	for (bad = 0, k = 0; k < n; k++) {
+		x = rnd() % 4 ? (unsigned long)rnd() & 0xff : (unsigned long)rnd() & 0xffff;
+		y = (unsigned long)rnd() & (rnd() % 2 ? 0xff : 0xffff);
+		bad += mul_case(x, y, bad);
+	}
+	printf("%-7s %ld cases, %d mismatches\n", "MLDEBC", n, bad);
+	total += bad;
+	for (cmd = CP_MUL16U; cmd <= CP_DIV32S; cmd++) {
+		for (bad = 0, k = 0; k < n; k++)
+			bad += int_case(cmd, rnd_int(), rnd_int(), bad);
+		printf("%-7s %ld cases, %d mismatches\n", int_names[cmd], n, bad);
+		total += bad;
+	}
+	return total != 0;
+}
@@ -0,0 +1,126 @@
+; fppatch - EMUBASIC arithmetic on the SuperMEZ80 coprocessor
+;
+; Build: any Z80 assembler with Intel HEX output, e.g.
+;        zmac -o fppatch.hex fppatch.asm   (fppatch.hex is checked in)
+;
+; Usage: mkimage ... -z -i EMUBASIC-FP emubasic.bin fppatch.hex
+;
+; Patches the BASIC ROM so FPADD, FPMULT, DVBCDE, SQR and the array index
+; multiply MLDEBC hand their operands to the coprocessor ports (CP_DATA,
+; CP_CMD in emuz80_z80ram.c) instead of shifting bits on the Z80. The
+; PIC gives the same FPREG, FPEXP and SGNRES bits as the ROM code and the
+; stubs return the registers the ROM's main path leaves: BCDE and A from
+; the result, HL at SGNRES. Errors go to the ROM's own ?OV, ?/0, ?FC and
+; ?BS. The ROM entries are jumped over, everything else stays in place;
+; the stubs sit in the unused space above 0x1CA3.
+
+CP_DATA	EQU	38H
+CP_CMD	EQU	39H
+CP_FADD	EQU	10H
+CP_FMUL	EQU	12H
+CP_FDIV	EQU	13H
+CP_FSQR	EQU	14H
+
+FPREG	EQU	2129H		; FPREG, FPREG+1, FPREG+2, FPEXP, SGNRES
+FPEXP	EQU	212CH
+OVERR	EQU	0402H
+DZERR	EQU	03F6H
+FCERR	EQU	0912H
+BSERR	EQU	0FC6H
+
+	ORG	1454H		; FPADD: FPREG = FPREG + BCDE
+	JP	FADD
+	ORG	158FH		; FPMULT: FPREG = FPREG * BCDE
+	JP	FMULT
+	ORG	15F0H		; DVBCDE: FPREG = BCDE / FPREG
+	JP	DVBCDE
+	ORG	1786H		; MLDEBC: HL = DE * BC, ?BS past 64K
+	JP	MLDEBC
+	ORG	1933H		; SQR: FPREG = SQR(FPREG)
+	JP	SQR
+
+	ORG	1D00H
+FADD:	LD	A,B		; Adding zero leaves the registers alone
+	OR	A
+	RET	Z
+	LD	A,CP_FADD
+	JR	CPFP
+
+FMULT:	LD	A,(FPEXP)	; So does multiplying zero
+	OR	A
+	RET	Z
+	LD	A,CP_FMUL
+	JR	CPFP
+
+DVBCDE:	LD	A,CP_FDIV
+	JR	CPFP
+
+SQR:	LD	A,CP_FSQR
+
+; Operation in A: FPREG..SGNRES and BCDE out, the Z80 waits in the
+; CP_CMD write until the result is ready, FPREG..SGNRES back in
+CPFP:	PUSH	AF
+	PUSH	BC
+	LD	HL,FPREG
+	LD	BC,5*256+CP_DATA
+	OTIR
+	POP	BC
+	LD	A,E
+	OUT	(CP_DATA),A
+	LD	A,D
+	OUT	(CP_DATA),A
+	LD	A,C
+	OUT	(CP_DATA),A
+	LD	A,B
+	OUT	(CP_DATA),A
+	POP	AF
+	OUT	(CP_CMD),A
+	IN	A,(CP_CMD)
+	OR	A
+	JR	NZ,CPERR
+	LD	HL,FPREG
+	LD	BC,5*256+CP_DATA
+	INIR
+	DEC	HL		; SGNRES, as RONDB leaves it
+	LD	DE,(FPREG)
+	LD	BC,(FPREG+2)
+	LD	A,C
+	RET
+
+CPERR:	DEC	A		; 1 overflow
+	JP	Z,OVERR
+	DEC	A		; 2 division by zero
+	JP	Z,DZERR
+	JP	FCERR		; 3 SQR of a negative number
+
+; CP_MUL16U, bytes 2-3 of A are not used
+MLDEBC:	LD	HL,0
+	LD	A,B
+	OR	C
+	RET	Z
+	LD	A,E
+	OUT	(CP_DATA),A
+	LD	A,D
+	OUT	(CP_DATA),A
+	OUT	(CP_DATA),A
+	OUT	(CP_DATA),A
+	LD	A,C
+	OUT	(CP_DATA),A
+	LD	A,B
+	OUT	(CP_DATA),A
+	XOR	A		; CP_MUL16U
+	OUT	(CP_CMD),A
+	IN	A,(CP_DATA)
+	LD	L,A
+	IN	A,(CP_DATA)
+	LD	H,A
+	IN	A,(CP_DATA)
+	LD	E,A
+	IN	A,(CP_DATA)
+	OR	E
+	JP	NZ,BSERR
+	LD	D,A		; DE shifted out, as in the ROM
+	LD	E,A
+	RET
+
+	END
@@ -0,0 +1,211 @@
+/*
+ * iotrace - decode the SuperMEZ80 IO trace dump
+ *
+ * Build: cc -O2 -o iotrace iotrace.c
+ *
+ * Usage: iotrace [-t] [-s] CAPTURE
+ *   CAPTURE  UART capture holding the output of the console t command
+ *            (firmware built with IO_TRACE), the dump is found by its magic
+ *   -t       timeline only
+ *   -s       per port statistics only
+ *
+ * Dump: "Z80TRACE", record count (16-bit) and TIM_US at the dump
+ * (32-bit), then the records oldest first: port, data, flags, TMR0
+ * (16-bit), then CRC-16/XMODEM of everything after the magic.
+ *
+ * Timestamps are the low 16 bits of the microsecond counter, so times
+ * are relative to the first record and a gap of 65.536ms or more
+ * between two records is folded.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_OUT	0x01
+#define TRACE_INTA	0x02
+#define TRACE_HELD	0x04
+#define TRACE_QUEUED	0x08
+#define REC_SIZE	5
+
+static const char magic[8] = "Z80TRACE";
+
+/* Port names, as in emuz80_z80ram.c */
+static const struct {
+	unsigned char port;
+	const char *name;
+} names[] = {
+	{ 0x00, "UART_DREG" }, { 0x01, "UART_CREG" }, { 0x02, "UART_BREG" },
+	{ 0x03, "CLK_REG" }, { 0x06, "INT_CTRL" }, { 0x07, "INT_VECT" },
+	{ 0x08, "STAT_PORT" }, { 0x09, "STAT_CMD" }, { 0x0a, "STAT_DATA" },
+	{ 0x0b, "TRACE_DUMP" },
+	{ 0x10, "DISK_DRIVE" }, { 0x11, "DISK_TRACK" }, { 0x12, "DISK_TRACKH" },
+	{ 0x13, "DISK_SECTOR" }, { 0x14, "DISK_CMD" }, { 0x15, "DISK_DATA" },
+	{ 0x18, "BLK_ADDRL" }, { 0x19, "BLK_ADDRH" }, { 0x1a, "BLK_LENL" },
+	{ 0x1b, "BLK_LENH" }, { 0x1c, "BLK_ARG" }, { 0x1d, "BLK_CMD" },
+	{ 0x20, "TIM_US" }, { 0x21, "TIM_US+1" }, { 0x22, "TIM_US+2" },
+	{ 0x23, "TIM_US+3" }, { 0x24, "TIM_TICKL" }, { 0x25, "TIM_TICKH" },
+	{ 0x26, "TIM_STAT" }, { 0x28, "SNAP_SPL" }, { 0x29, "SNAP_SPH" },
+	{ 0x2a, "SNAP_CMD" },
+};
+
+static const char *port_name(unsigned char p)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+		if (names[i].port == p)
+			return names[i].name;
+	return "";
+}
+
+static unsigned crc16(const unsigned char *p, size_t n)
+{
+	unsigned crc = 0;
+	int i;
+
+	while (n--) {
+		crc ^= (unsigned)*p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1 ^ 0x1021) & 0xffff : (crc << 1) & 0xffff;
+	}
+	return crc;
+}
+
+static unsigned char *load(const char *path, long *size)
+{
+	FILE *fp = fopen(path, "rb");
+	unsigned char *buf;
+
+	if (!fp) {
+		perror(path);
+		exit(1);
+	}
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	rewind(fp);
+	buf = malloc(*size ? *size : 1);
+	if (!buf || fread(buf, 1, *size, fp) != (size_t)*size) {
+		perror(path);
+		exit(1);
+	}
+	fclose(fp);
+	return buf;
+}
+
+static void timeline(const unsigned char *rec, unsigned n)
+{
+	unsigned long long t = 0;
+	unsigned i, dt, prev = 0;
+	const unsigned char *r;
+
+	printf("     time us    delta  dir  port              data\n");
+	for (i = 0; i < n; i++) {
+		r = rec + i * REC_SIZE;
+		dt = i ? ((r[3] | r[4] << 8) - prev) & 0xffff : 0;
+		prev = r[3] | r[4] << 8;
+		t += dt;
+		printf("%12llu %8u  %-4s %02X %-13s  %02X",
+			t, dt, r[2] & TRACE_INTA ? "INTA" : r[2] & TRACE_OUT ? "OUT" : "IN",
+			r[0], port_name(r[0]), r[1]);
+		if (r[0] == 0x00 && r[1] >= 0x20 && r[1] < 0x7f)
+			printf(" '%c'", r[1]);
+		if (r[2] & TRACE_HELD)
+			printf(" (bus job)");
+		else if (r[2] & TRACE_QUEUED)
+			printf(" (queued)");
+		printf("\n");
+	}
+}
+
+static void stats(const unsigned char *rec, unsigned n)
+{
+	unsigned long cnt[256][3], last[256], gap_min[256];
+	unsigned long long t = 0, span;
+	unsigned i, prev = 0, p, d;
+	const unsigned char *r;
+
+	memset(cnt, 0, sizeof(cnt));
+	memset(last, 0, sizeof(last));
+	for (p = 0; p < 256; p++)
+		gap_min[p] = ~0UL;
+	for (i = 0; i < n; i++) {
+		r = rec + i * REC_SIZE;
+		if (i)
+			t += ((r[3] | r[4] << 8) - prev) & 0xffff;
+		prev = r[3] | r[4] << 8;
+		p = r[0];
+		d = r[2] & TRACE_INTA ? 2 : r[2] & TRACE_OUT ? 1 : 0;
+		if (cnt[p][0] + cnt[p][1] + cnt[p][2] && t - last[p] < gap_min[p])
+			gap_min[p] = (unsigned long)(t - last[p]);
+		last[p] = (unsigned long)t;
+		cnt[p][d]++;
+	}
+	span = t;
+	printf("%u records over %llu us\n", n, span);
+	printf("port               IN    OUT   INTA   per s  min gap us\n");
+	for (p = 0; p < 256; p++) {
+		unsigned long tot = cnt[p][0] + cnt[p][1] + cnt[p][2];
+
+		if (!tot)
+			continue;
+		printf(" %02X %-13s %6lu %6lu %6lu %7.0f", p, port_name(p),
+			cnt[p][0], cnt[p][1], cnt[p][2], span ? tot * 1e6 / span : 0.0);
+		if (gap_min[p] != ~0UL)
+			printf(" %11lu", gap_min[p]);
+		printf("\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *in = NULL;
+	int i, show_t = 1, show_s = 1;
+	unsigned char *buf, *h = NULL;
+	unsigned n, crc;
+	long size, off;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-t")) {
+			show_s = 0;
+		} else if (!strcmp(argv[i], "-s")) {
+			show_t = 0;
+		} else if (argv[i][0] != '-' && !in) {
+			in = argv[i];
+		} else {
+			in = NULL;
+			break;
+		}
+	}
+	if (!in) {
+		fprintf(stderr, "usage: iotrace [-t] [-s] CAPTURE\n");
+		return 2;
+	}
+	buf = load(in, &size);
+	for (off = 0; off + 14 <= size; off++)
+		if (!memcmp(buf + off, magic, sizeof(magic))) {
+			h = buf + off;
+			break;
+		}
+	if (!h) {
+		fprintf(stderr, "%s: no trace dump\n", in);
+		return 1;
+	}
+	n = h[8] | h[9] << 8;
+	if (n > 256 || off + 14 + n * REC_SIZE + 2 > size) {
+		fprintf(stderr, "%s: truncated trace dump\n", in);
+		return 1;
+	}
+	crc = h[14 + n * REC_SIZE] | h[15 + n * REC_SIZE] << 8;
+	if (crc16(h + 8, 6 + n * REC_SIZE) != crc) {
+		fprintf(stderr, "%s: CRC %04X, expected %04X\n",
+			in, crc16(h + 8, 6 + n * REC_SIZE), crc);
+		return 1;
+	}
+	printf("dump at TIM_US %lu\n", (unsigned long)(h[10] | h[11] << 8
+		| (unsigned long)h[12] << 16 | (unsigned long)h[13] << 24));
+	if (show_t)
+		timeline(h + 14, n);
+	if (show_s)
+		stats(h + 14, n);
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * LZ image format shared by the host tools and the SuperMEZ80 firmware
+ *
+ * The stream is a sequence of tokens:
+ *   0x00-0x7f  literal run, token+1 bytes follow
+ *   0x80-0xff  match, (token & 0x7f)+4 bytes are copied from 'distance'
+ *              bytes back in the output, distance follows as 16-bit LE
+ * A match with distance 0 ends the stream.
+ *
+ * Matches only ever refer back into data already written, so the
+ * firmware expands the stream straight into Z80 RAM and reads the
+ * back references from there, without any buffer on the PIC.
+ */
+#ifndef LZ_H
+#define LZ_H
+
+#include <stddef.h>
+#include <string.h>
+
+#define LZ_MIN_MATCH	4	/* a 3 byte match would save nothing */
+#define LZ_MAX_MATCH	(0x7f + LZ_MIN_MATCH)
+#define LZ_MAX_LITERAL	0x80
+#define LZ_WINDOW		0xffff
+#define LZ_HASH_BITS	13
+#define LZ_MAX_CHAIN	512
+
+/* Worst case output size for n input bytes */
+#define LZ_BOUND(n)		((n) + (n) / LZ_MAX_LITERAL + 4)
+
+static inline unsigned lz_hash(const unsigned char *p)
+{
+	return ((p[0] << 8 ^ p[1] << 4 ^ p[2]) * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static inline size_t lz_flush_literals(const unsigned char *lit, size_t n, unsigned char *out)
+{
+	size_t o = 0, k;
+
+	while (n) {
+		k = n > LZ_MAX_LITERAL ? LZ_MAX_LITERAL : n;
+		out[o++] = (unsigned char)(k - 1);
+		memcpy(out + o, lit, k);
+		o += k;
+		lit += k;
+		n -= k;
+	}
+	return o;
+}
+
+/* Compress n bytes, out must hold LZ_BOUND(n). Returns the stream size */
+static inline size_t lz_compress(const unsigned char *in, size_t n, unsigned char *out)
+{
+	static long head[1 << LZ_HASH_BITS];
+	static long prev[LZ_WINDOW + 1];
+	size_t i = 0, o = 0, lit = 0;
+	long c;
+	int chain;
+
+	for (i = 0; i < (1 << LZ_HASH_BITS); i++)
+		head[i] = -1;
+
+	i = 0;
+	while (i < n) {
+		size_t best = 0, dist = 0;
+
+		if (i + LZ_MIN_MATCH <= n) {
+			unsigned h = lz_hash(in + i);
+
+			for (c = head[h], chain = 0; c >= 0 && i - c <= LZ_WINDOW && chain < LZ_MAX_CHAIN;
+			     c = prev[c & LZ_WINDOW], chain++) {
+				size_t l = 0;
+
+				while (l < LZ_MAX_MATCH && i + l < n && in[c + l] == in[i + l])
+					l++;
+				if (l > best) {
+					best = l;
+					dist = i - c;
+					if (l == LZ_MAX_MATCH)
+						break;
+				}
+			}
+		}
+		if (best >= LZ_MIN_MATCH) {
+			o += lz_flush_literals(in + i - lit, lit, out + o);
+			lit = 0;
+			out[o++] = (unsigned char)(0x80 | (best - LZ_MIN_MATCH));
+			out[o++] = (unsigned char)dist;
+			out[o++] = (unsigned char)(dist >> 8);
+		} else {
+			best = 1;
+			lit++;
+		}
+		while (best--) {
+			if (i + LZ_MIN_MATCH <= n) {
+				unsigned h = lz_hash(in + i);
+
+				prev[i & LZ_WINDOW] = head[h];
+				head[h] = (long)i;
+			}
+			i++;
+		}
+	}
+	o += lz_flush_literals(in + n - lit, lit, out + o);
+	out[o++] = 0x80;		/* end of stream */
+	out[o++] = 0;
+	out[o++] = 0;
+	return o;
+}
+
+/* Expand a stream into out (max bytes). Returns the size, or -1 if broken */
+static inline long lz_decompress(const unsigned char *in, size_t n, unsigned char *out, size_t max)
+{
+	size_t i = 0, o = 0, k, dist;
+	unsigned char t;
+
+	while (i < n) {
+		t = in[i++];
+		if (t < 0x80) {
+			k = (size_t)t + 1;
+			if (i + k > n || o + k > max)
+				return -1;
+			memcpy(out + o, in + i, k);
+			i += k;
+			o += k;
+			continue;
+		}
+		if (i + 2 > n)
+			return -1;
+		dist = in[i] | in[i + 1] << 8;
+		i += 2;
+		if (dist == 0)
+			return (long)o;
+		k = (size_t)(t & 0x7f) + LZ_MIN_MATCH;
+		if (dist > o || o + k > max)
+			return -1;
+		while (k--) {
+			out[o] = out[o - dist];
+			o++;
+		}
+	}
+	return -1;			/* no end marker */
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*
+ * lzpack - compress a Z80 image for the SuperMEZ80 firmware
+ *
+ * Build: cc -O2 -o lzpack lzpack.c
+ *
+ * Usage: lzpack [-t] [-n NAME] input [output.c]
+ *   input   raw binary, or a C source holding a NAME[] array
+ *           (e.g. emuz80_z80ram.c)
+ *   output  C array NAME[] of the LZ stream and, in a comment, its
+ *           image_segs[] entry, stdout if omitted
+ *   -n NAME array name, as in the data column of image_segs[]
+ *           (default rom0, the first segment mkimage emits)
+ *   -t      round trip only: compress, expand and compare
+ *
+ * mkimage -z builds LZ segments of the image table with the same coder.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "lz.h"
+
+#define IMAGE_MAX	0x10000
+
+static unsigned char image[IMAGE_MAX];
+static unsigned char packed[LZ_BOUND(IMAGE_MAX)];
+static unsigned char check[IMAGE_MAX];
+static const char *name = "rom0";
+
+/* CRC-16/XMODEM, as the image_segs[] crc column */
+static unsigned crc16(const unsigned char *p, size_t n)
+{
+	unsigned crc = 0;
+	int i;
+
+	while (n--) {
+		crc ^= *p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc & 0xffff;
+}
+
+/* Pick the bytes of 'const unsigned char NAME[] = { ... };' out of C source */
+static long load_c_array(const char *text)
+{
+	const char *p = text, *eol;
+	char decl[80];
+	long n = 0;
+
+	snprintf(decl, sizeof(decl), "unsigned char %s[]", name);
+	for (;;) {				/* the definition, not the extern */
+		if (!(p = strstr(p, decl)))
+			return -1;
+		eol = strchr(p, '\n');
+		p = strchr(p, '{');
+		if (p && (!eol || p < eol))
+			break;
+		if (!p)
+			return -1;
+		p = eol;
+	}
+	for (p++; *p && *p != '}'; ) {
+		if (p[0] == '/' && p[1] == '/') {
+			p = strchr(p, '\n');
+			if (!p)
+				break;
+			continue;
+		}
+		if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+			char *e;
+			unsigned long v = strtoul(p, &e, 16);
+
+			if (n >= IMAGE_MAX || v > 0xff)
+				return -1;
+			image[n++] = (unsigned char)v;
+			p = e;
+			continue;
+		}
+		p++;
+	}
+	return n;
+}
+
+static long load(const char *path)
+{
+	FILE *fp = fopen(path, "rb");
+	static char buf[IMAGE_MAX * 8];
+	size_t n;
+	const char *ext = strrchr(path, '.');
+
+	if (!fp) {
+		perror(path);
+		return -1;
+	}
+	n = fread(buf, 1, sizeof(buf) - 1, fp);
+	fclose(fp);
+	if (ext && !strcmp(ext, ".c")) {
+		buf[n] = '\0';
+		return load_c_array(buf);
+	}
+	if (n > IMAGE_MAX)
+		return -1;
+	memcpy(image, buf, n);
+	return (long)n;
+}
+
+/* Same layout as an LZ segment from mkimage */
+static void emit(FILE *fp, const char *src, long n, size_t m)
+{
+	size_t i;
+
+	fprintf(fp, "// LZ image of %s, %ld bytes packed to %lu\n", src, n, (unsigned long)m);
+	fprintf(fp, "// image_segs[]: { 0x0000, 0x%04lx, 0x%04x, 1, %s },\n",
+		(unsigned long)n, crc16(image, (size_t)n), name);
+	fprintf(fp, "const unsigned char %s[] = {\n", name);
+	for (i = 0; i < m; i++) {
+		if (i % 256 == 0)
+			fprintf(fp, "// +0x%04lx\n", (unsigned long)i);
+		if (i % 16 == 0)
+			fprintf(fp, "\t");
+		fprintf(fp, "0x%02x%s", packed[i], i == m - 1 ? "\n" : i % 16 == 15 ? ",\n" : ", ");
+	}
+	fprintf(fp, "};\n");
+}
+
+/* NAME has to be a C identifier, it goes into the output as is */
+static int valid_name(const char *s)
+{
+	if (!isalpha((unsigned char)*s) && *s != '_')
+		return 0;
+	while (*++s)
+		if (!isalnum((unsigned char)*s) && *s != '_')
+			return 0;
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int test = 0;
+	long n, r;
+	size_t m;
+	FILE *fp = stdout;
+
+	for (; argc > 1 && argv[1][0] == '-'; argc--, argv++) {
+		if (!strcmp(argv[1], "-t"))
+			test = 1;
+		else if (!strcmp(argv[1], "-n") && argc > 2 && valid_name(argv[2])) {
+			name = argv[2];
+			argc--;
+			argv++;
+		} else
+			break;
+	}
+	if (argc < 2 || argc > 3 || argv[1][0] == '-') {
+		fprintf(stderr, "usage: lzpack [-t] [-n NAME] input [output.c]\n");
+		return 2;
+	}
+	n = load(argv[1]);
+	if (n <= 0) {
+		fprintf(stderr, "%s: no image\n", argv[1]);
+		return 1;
+	}
+	m = lz_compress(image, (size_t)n, packed);
+	r = lz_decompress(packed, m, check, sizeof(check));
+	if (r != n || memcmp(image, check, (size_t)n)) {
+		fprintf(stderr, "%s: round trip FAILED\n", argv[1]);
+		return 1;
+	}
+	if (test) {
+		printf("%s: %s[] %ld -> %lu bytes, round trip OK\n", argv[1], name, n, (unsigned long)m);
+		return 0;
+	}
+	if (argc == 3 && !(fp = fopen(argv[2], "w"))) {
+		perror(argv[2]);
+		return 1;
+	}
+	emit(fp, argv[1], n, m);
+	if (fp != stdout)
+		fclose(fp);
+	return 0;
+}
@@ -0,0 +1,325 @@
+/*
+ * mkimage - build the SuperMEZ80 Z80 image table from Intel HEX / binary files
+ *
+ * Build: cc -O2 -o mkimage mkimage.c
+ *
+ * Usage: mkimage [-z] [-o table.c] -i NAME [-e ENTRY] FILE... [[-z] -i NAME ...]
+ *   -i NAME   start a new bootable image
+ *   -e ENTRY  Z80 start address (default: HEX start record, else 0x0000)
+ *   -z        store the segments of the images after it LZ compressed
+ *             (see lz.h), all of them when it comes first
+ *   -o FILE   output, stdout if omitted
+ *   FILE      name.hex, or name.bin[@ADDR] loaded at ADDR (default 0x0000),
+ *             a later file overwrites an earlier one (a binary and a patch)
+ *
+ * Every image becomes one or more segments, one per populated address
+ * range, each with its load address, length and CRC-16/XMODEM. Paste the
+ * output over the image table at the end of emuz80_z80ram.c.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "lz.h"
+
+#define RAM_SIZE	0x10000
+#define PIC_LIMIT	0x8000	/* Uploads reach 0x0000-0x7FFF only */
+#define MAX_IMAGES	16
+#define MAX_SEGS	64
+
+struct seg {
+	unsigned addr, len, crc;
+	int lz;
+	unsigned char *data;
+	size_t size;		/* bytes in data[] */
+};
+
+struct image {
+	char name[32];
+	long entry;			/* -1: not given */
+	int seg, nseg;
+	int lz;
+	unsigned char ram[RAM_SIZE];
+	unsigned char used[RAM_SIZE];
+	char files[256];
+};
+
+static struct image *images[MAX_IMAGES];
+static int nimages;
+static struct seg segs[MAX_SEGS];
+static int nsegs;
+static int compress;
+
+static unsigned crc16(const unsigned char *p, size_t n)
+{
+	unsigned crc = 0;
+	int i;
+
+	while (n--) {
+		crc ^= (unsigned)*p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1 ^ 0x1021) & 0xffff : (crc << 1) & 0xffff;
+	}
+	return crc;
+}
+
+static int hexbyte(const char *p)
+{
+	int v = 0, i;
+
+	for (i = 0; i < 2; i++) {
+		v <<= 4;
+		if (isdigit((unsigned char)p[i]))
+			v |= p[i] - '0';
+		else if (isxdigit((unsigned char)p[i]))
+			v |= toupper((unsigned char)p[i]) - 'A' + 10;
+		else
+			return -1;
+	}
+	return v;
+}
+
+static void put(struct image *img, unsigned long addr, int v, const char *path)
+{
+	if (addr >= PIC_LIMIT) {
+		fprintf(stderr, "%s: address 0x%lx above 0x%x, the PIC only drives A0-A14\n",
+			path, addr, PIC_LIMIT - 1);
+		exit(1);
+	}
+	img->ram[addr] = (unsigned char)v;
+	img->used[addr] = 1;
+}
+
+static void load_hex(struct image *img, const char *path)
+{
+	FILE *fp = fopen(path, "r");
+	char line[600];
+	int lineno = 0;
+
+	if (!fp) {
+		perror(path);
+		exit(1);
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		int n, type, sum = 0, i, v;
+		unsigned addr;
+
+		lineno++;
+		if (line[0] != ':')
+			continue;
+		n = hexbyte(line + 1);
+		for (i = 0; i < n + 5; i++) {
+			v = hexbyte(line + 1 + i * 2);
+			if (v < 0)
+				goto bad;
+			sum += v;
+		}
+		if (sum & 0xff)
+			goto bad;
+		addr = (unsigned)(hexbyte(line + 3) << 8 | hexbyte(line + 5));
+		type = hexbyte(line + 7);
+		switch (type) {
+		case 0x00:			/* data */
+			for (i = 0; i < n; i++)
+				put(img, addr + i, hexbyte(line + 9 + i * 2), path);
+			break;
+		case 0x01:			/* end of file */
+			fclose(fp);
+			return;
+		case 0x02:			/* extended segment / linear address */
+		case 0x04:
+			if (hexbyte(line + 9) || hexbyte(line + 11)) {
+				fprintf(stderr, "%s:%d: address above 64K\n", path, lineno);
+				exit(1);
+			}
+			break;
+		case 0x03:			/* start address */
+		case 0x05:
+			if (img->entry < 0)
+				img->entry = hexbyte(line + 13) << 8 | hexbyte(line + 15);
+			break;
+		default:
+			goto bad;
+		}
+		continue;
+bad:
+		fprintf(stderr, "%s:%d: bad record\n", path, lineno);
+		exit(1);
+	}
+	fclose(fp);
+}
+
+static void load_bin(struct image *img, const char *arg)
+{
+	char path[256];
+	const char *at = strchr(arg, '@');
+	unsigned long addr = 0;
+	FILE *fp;
+	int c;
+
+	snprintf(path, sizeof(path), "%.*s", at ? (int)(at - arg) : (int)strlen(arg), arg);
+	if (at)
+		addr = strtoul(at + 1, NULL, 0);
+	if (!(fp = fopen(path, "rb"))) {
+		perror(path);
+		exit(1);
+	}
+	while ((c = getc(fp)) != EOF)
+		put(img, addr++, c, path);
+	fclose(fp);
+}
+
+static void load(struct image *img, const char *arg)
+{
+	const char *ext = strrchr(arg, '.');
+
+	if (ext && (!strncmp(ext, ".hex", 4) || !strncmp(ext, ".HEX", 4) || !strncmp(ext, ".ihx", 4)))
+		load_hex(img, arg);
+	else
+		load_bin(img, arg);
+	if (strlen(img->files) + strlen(arg) + 2 < sizeof(img->files)) {
+		if (img->files[0])
+			strcat(img->files, " ");
+		strcat(img->files, arg);
+	}
+}
+
+/* One segment per populated address range */
+static void split(struct image *img)
+{
+	unsigned a = 0, b;
+
+	img->seg = nsegs;
+	while (a < RAM_SIZE) {
+		struct seg *s;
+
+		if (!img->used[a]) {
+			a++;
+			continue;
+		}
+		for (b = a; b < RAM_SIZE && img->used[b]; b++)
+			;
+		if (nsegs == MAX_SEGS) {
+			fprintf(stderr, "too many segments\n");
+			exit(1);
+		}
+		s = &segs[nsegs++];
+		s->addr = a;
+		s->len = b - a;
+		s->crc = crc16(img->ram + a, s->len);
+		s->lz = img->lz;
+		if (img->lz) {
+			static unsigned char check[RAM_SIZE];
+
+			s->data = malloc(LZ_BOUND(s->len));
+			s->size = lz_compress(img->ram + a, s->len, s->data);
+			if (lz_decompress(s->data, s->size, check, sizeof(check)) != (long)s->len ||
+			    memcmp(check, img->ram + a, s->len)) {
+				fprintf(stderr, "%s: LZ round trip failed\n", img->name);
+				exit(1);
+			}
+		} else {
+			s->data = malloc(s->len);
+			memcpy(s->data, img->ram + a, s->len);
+			s->size = s->len;
+		}
+		a = b;
+	}
+	img->nseg = nsegs - img->seg;
+	if (img->entry < 0)
+		img->entry = 0;
+	if (img->entry && img->used[0] + img->used[1] + img->used[2]) {
+		fprintf(stderr, "%s: entry 0x%04lx needs 0x0000-0x0002 free for the jump\n",
+			img->name, img->entry);
+		exit(1);
+	}
+}
+
+static void emit_data(FILE *fp, int n)
+{
+	struct seg *s = &segs[n];
+	size_t i;
+
+	fprintf(fp, "const unsigned char rom%d[] = {\n", n);
+	for (i = 0; i < s->size; i++) {
+		if (i % 256 == 0)
+			fprintf(fp, s->lz ? "// +0x%04lx\n" : "// 0x%04lx\n",
+				(unsigned long)(s->lz ? i : s->addr + i));
+		if (i % 16 == 0)
+			fprintf(fp, "\t");
+		fprintf(fp, "0x%02x%s", s->data[i], i == s->size - 1 ? "\n" : i % 16 == 15 ? ",\n" : ", ");
+	}
+	fprintf(fp, "};\n\n");
+}
+
+int main(int argc, char **argv)
+{
+	struct image *img = NULL;
+	FILE *fp = stdout;
+	const char *out = NULL;
+	int i, j;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-z")) {
+			compress = 1;
+		} else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			out = argv[++i];
+		} else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+			if (nimages == MAX_IMAGES) {
+				fprintf(stderr, "too many images\n");
+				return 1;
+			}
+			img = images[nimages++] = calloc(1, sizeof(*img));
+			snprintf(img->name, sizeof(img->name), "%s", argv[++i]);
+			img->entry = -1;
+			img->lz = compress;
+		} else if (!strcmp(argv[i], "-e") && i + 1 < argc && img) {
+			img->entry = strtol(argv[++i], NULL, 0) & 0xffff;
+		} else if (argv[i][0] != '-' && img) {
+			load(img, argv[i]);
+		} else {
+			fprintf(stderr, "usage: mkimage [-z] [-o table.c] -i NAME [-e ENTRY] FILE... [[-z] -i NAME ...]\n");
+			return 2;
+		}
+	}
+	if (!nimages) {
+		fprintf(stderr, "no image\n");
+		return 2;
+	}
+	for (i = 0; i < nimages; i++)
+		split(images[i]);
+
+	if (out && !(fp = fopen(out, "w"))) {
+		perror(out);
+		return 1;
+	}
+	fprintf(fp, "//Z80 image table generated by tools/mkimage\n");
+	for (i = 0; i < nimages; i++)
+		fprintf(fp, "// %d:%s %s\n", i, images[i]->name, images[i]->files);
+	for (i = 0; i < nsegs; i++)
+		emit_data(fp, i);
+	fprintf(fp, "const struct image_seg image_segs[] = {\n");
+	fprintf(fp, "//    addr    len     crc     lz  data\n");
+	for (i = 0; i < nsegs; i++)
+		fprintf(fp, "\t{ 0x%04x, 0x%04x, 0x%04x, %d, rom%d },\n",
+			segs[i].addr, segs[i].len, segs[i].crc, segs[i].lz, i);
+	fprintf(fp, "};\n\n");
+	fprintf(fp, "const struct image images[] = {\n");
+	fprintf(fp, "//    name        entry   seg nseg\n");
+	for (i = 0; i < nimages; i++)
+		fprintf(fp, "\t{ \"%s\", 0x%04lx, %d, %d },\n",
+			images[i]->name, images[i]->entry, images[i]->seg, images[i]->nseg);
+	fprintf(fp, "};\n");
+	fprintf(fp, "const unsigned char image_count = %d;\n", nimages);
+	fprintf(fp, "const unsigned char image_seg_count = %d;\n", nsegs);
+	if (fp != stdout)
+		fclose(fp);
+
+	for (i = 0; i < nimages; i++) {
+		fprintf(stderr, "%d:%s entry 0x%04lx\n", i, images[i]->name, images[i]->entry);
+		for (j = images[i]->seg; j < images[i]->seg + images[i]->nseg; j++)
+			fprintf(stderr, "  0x%04x-0x%04x crc 0x%04x %lu bytes\n", segs[j].addr,
+				segs[j].addr + segs[j].len - 1, segs[j].crc, (unsigned long)segs[j].size);
+	}
+	return 0;
+}
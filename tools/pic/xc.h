@@ -0,0 +1,207 @@
+/*
+ * xc.h - host stand-in for the XC8 <xc.h> of the PIC18F47Q43, used by
+ * tools/cosim.c to run emuz80_z80ram.c unchanged on the host
+ *
+ * Every SFR the firmware touches is declared here. Most are plain
+ * variables. The ones with a side effect on the Z80 bus, the UART, the
+ * SD card, the data EEPROM, the timers or the DMA expand to a call into
+ * cosim.c, either returning the value (registers that are only read) or
+ * a pointer to the register (read-modify-write, bit and write-only
+ * registers). A write through such a pointer is seen at the next hooked
+ * access, which is always before anything could observe it: the SRAM
+ * /WE rising edge, for one, is taken when the next bus register is
+ * touched and the address and data latches still hold their values.
+ *
+ * The firmware is built through xc8types.sed first, so int is 16 and
+ * long 32 bits as with XC8, and with -funsigned-char.
+ */
+#ifndef COSIM_XC_H
+#define COSIM_XC_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef HAL_REG
+#define HAL_REG extern			/* cosim.c defines them */
+#endif
+
+typedef int16_t pic_int;
+typedef uint16_t pic_uint;
+typedef int32_t pic_long;
+typedef uint32_t pic_ulong;
+
+#define _18F47Q43
+
+#define __interrupt(...)
+#define NOP()			hal_nop()
+#define RESET()			hal_reset()
+#define __delay_us(x)	hal_delay_ns((x) * 1000ULL)
+#define __delay_ms(x)	hal_delay_ns((x) * 1000000ULL)
+#define printf			pic_printf
+#define main			pic_main
+
+void hal_nop(void);
+void hal_reset(void);
+void hal_delay_ns(unsigned long long ns);
+int pic_printf(const char *fmt, ...);
+
+/* Interrupts */
+struct intcon0_bits { unsigned char IPEN, GIEL; };
+HAL_REG volatile struct intcon0_bits INTCON0bits;
+volatile unsigned char *hal_gie(void);
+#define GIE				(*hal_gie())
+HAL_REG volatile unsigned char CLC3IE, CLC3IF, CLC3IP, IOCIE, IOCIP, IOCAF0, IOCAP0, IOCAN0;
+HAL_REG volatile unsigned char U3RXIE, U3RXIP, U3TXIE, U3TXIP, U3IE, U3IP;
+HAL_REG volatile unsigned char TMR0IE, TMR0IF, TMR0IP, TMR4IE, TMR4IF, TMR4IP;
+HAL_REG volatile unsigned char TMR6IE, TMR6IF, TMR6IP;
+HAL_REG volatile unsigned char IVTLOCK;
+HAL_REG volatile uint32_t IVTBASE;
+struct lock_bits { unsigned char IVTLOCKED, PRLOCKED; };
+HAL_REG volatile struct lock_bits IVTLOCKbits, PRLOCKbits;
+
+/* Pins. RA0 /IORQ, RA5 /RD and the ports read back what cosim drives */
+HAL_REG volatile unsigned char RA0, RA5, RD7;
+HAL_REG volatile unsigned char PORTB;
+unsigned char hal_porta(void);
+unsigned char hal_portc(void);
+unsigned char hal_portd(void);
+unsigned char hal_porte(void);
+#define PORTA			hal_porta()
+#define PORTC			hal_portc()
+#define PORTD			hal_portd()
+#define PORTE			hal_porte()
+
+volatile unsigned char *hal_lat(int pin);
+#define HAL_LATB		0
+#define HAL_LATC		1
+#define HAL_LATD		2
+#define HAL_LATA2		3		/* /WE */
+#define HAL_LATA4		4		/* /OE */
+#define HAL_LATE0		5		/* /BUSREQ */
+#define HAL_LATE1		6		/* RESET */
+#define HAL_LATE2		7		/* A14 */
+#define LATB			(*hal_lat(HAL_LATB))
+#define LATC			(*hal_lat(HAL_LATC))
+#define LATD			(*hal_lat(HAL_LATD))
+#define LATA2			(*hal_lat(HAL_LATA2))
+#define LATA4			(*hal_lat(HAL_LATA4))
+#define LATE0			(*hal_lat(HAL_LATE0))
+#define LATE1			(*hal_lat(HAL_LATE1))
+#define LATE2			(*hal_lat(HAL_LATE2))
+HAL_REG volatile unsigned char LATA6, LATD7;
+
+HAL_REG volatile unsigned char TRISA0, TRISA1, TRISA2, TRISA3, TRISA4, TRISA5, TRISA6, TRISA7;
+HAL_REG volatile unsigned char TRISB, TRISC, TRISD, TRISD6, TRISD7, TRISE0, TRISE1, TRISE2;
+HAL_REG volatile unsigned char ANSELA0, ANSELA1, ANSELA2, ANSELA3, ANSELA4, ANSELA5, ANSELA6, ANSELA7;
+HAL_REG volatile unsigned char ANSELB, ANSELC, ANSELD, ANSELD6, ANSELD7, ANSELE0, ANSELE1, ANSELE2;
+HAL_REG volatile unsigned char WPUA0, WPUA1, WPUA5, WPUB, WPUC, WPUD, WPUD6, WPUE2;
+HAL_REG volatile unsigned char RA2PPS, RA3PPS, RA4PPS, RA6PPS, RD7PPS, RC0PPS, RC1PPS;
+HAL_REG volatile unsigned char U3RXPPS, SPI1SCKPPS, SPI1SDIPPS;
+HAL_REG volatile unsigned char CLCIN0PPS, CLCIN1PPS, CLCIN2PPS, CLCIN4PPS;
+
+/* CLC, only the /WAIT D-FF reset has an effect */
+HAL_REG volatile unsigned char CLCSELECT, CLCnSEL0, CLCnSEL1, CLCnSEL2, CLCnSEL3;
+HAL_REG volatile unsigned char CLCnGLS0, CLCnGLS1, CLCnGLS2, CLCnGLS3, CLCnPOL, CLCnCON, CLCDATA;
+volatile unsigned char *hal_g3pol(void);
+#define G3POL			(*hal_g3pol())
+
+/* Z80 clock */
+HAL_REG volatile unsigned char OSCFRQ, NCO1CLK, NCO1PFM, NCO1OUT, NCO1EN;
+HAL_REG volatile uint32_t NCO1INC;
+
+/* UART3 */
+struct u3con0_bits { unsigned char BRGS; };
+HAL_REG volatile struct u3con0_bits U3CON0bits;
+HAL_REG volatile uint16_t U3BRG;
+HAL_REG volatile unsigned char U3ON, U3RXEN, U3TXEN;
+struct u3errie_bits { unsigned char TXMTIE; };
+HAL_REG volatile struct u3errie_bits U3ERRIEbits;
+#define U3ERRIE			(*(volatile unsigned char *)&U3ERRIEbits)
+unsigned char hal_u3rxif(void);
+unsigned char hal_u3rxb(void);
+unsigned char hal_u3txif(void);
+unsigned char hal_u3txmtif(void);
+volatile uint16_t *hal_u3txb(void);
+#define U3RXIF			hal_u3rxif()
+#define U3RXB			hal_u3rxb()
+#define U3TXIF			hal_u3txif()
+#define U3TXMTIF		hal_u3txmtif()
+#define U3TXB			(*hal_u3txb())
+
+/* Timers. TMR0 and TMR1 run on host time, TMR0L latches TMR0H */
+HAL_REG volatile unsigned char T0CON0, T0CON1, TMR0H;
+volatile unsigned char *hal_tmr0l(void);
+#define TMR0L			(*hal_tmr0l())
+HAL_REG volatile unsigned char T1CLK, T1CON;
+uint16_t hal_tmr1(void);
+#define TMR1			hal_tmr1()
+struct t2con_bits { unsigned char ON; };
+volatile struct t2con_bits *hal_t2con(void);
+#define T2CONbits		(*hal_t2con())
+#define T2CON			(hal_t2con()->ON)
+volatile unsigned char *hal_tmr2if(void);
+#define TMR2IF			(*hal_tmr2if())
+HAL_REG volatile unsigned char T2CLKCON, T2HLT, T2PR, TMR2;
+HAL_REG volatile unsigned char T4CLKCON, T4HLT, T4PR, T4CON;
+HAL_REG volatile unsigned char T6CLKCON, T6HLT, T6PR, T6CON, TMR6;
+
+/* ROM upload DMA, CCP1 PWM on TMR2 */
+struct dma_regs {
+	unsigned char con0, con1, sirq;
+	uint32_t ssa;
+	uint16_t ssz, dsa, dsz;
+};
+volatile struct dma_regs *hal_dma(void);
+volatile unsigned char *hal_dma1scntif(void);
+HAL_REG volatile unsigned char DMASELECT, DMA1PR, DMA2PR, MAINPR, ISRPR, PRLOCK;
+#define DMAnCON0		(hal_dma()->con0)
+#define DMAnCON1		(hal_dma()->con1)
+#define DMAnSIRQ		(hal_dma()->sirq)
+#define DMAnSSA			(hal_dma()->ssa)
+#define DMAnSSZ			(hal_dma()->ssz)
+#define DMAnDSA			(hal_dma()->dsa)
+#define DMAnDSZ			(hal_dma()->dsz)
+#define DMA1SCNTIF		(*hal_dma1scntif())
+/* Host pointers are 64 bits, cosim builds -no-pie so they fit the fields */
+#define DMA_ADDR(p)		((uintptr_t)(p))
+struct ccptmrs0_bits { unsigned char C1TSEL; };
+HAL_REG volatile struct ccptmrs0_bits CCPTMRS0bits;
+HAL_REG volatile unsigned char CCP1CON;
+HAL_REG volatile uint16_t CCPR1;
+
+/* SPI1 and the card /CS (USE_SD below) */
+struct spi1con0_bits { unsigned char EN; };
+HAL_REG volatile struct spi1con0_bits SPI1CON0bits;
+HAL_REG volatile unsigned char SPI1CON0, SPI1CON1, SPI1CON2, SPI1CLK, SPI1BAUD;
+volatile uint16_t *hal_spi1txb(void);
+unsigned char hal_spi1rxif(void);
+unsigned char hal_spi1rxb(void);
+#define SPI1TXB			(*hal_spi1txb())
+#define SPI1RXIF		hal_spi1rxif()
+#define SPI1RXB			hal_spi1rxb()
+HAL_REG volatile unsigned char hal_sd_cs, hal_sd_cs_tris;
+
+/* Data EEPROM through the NVM controller */
+struct nvmcon0_bits { unsigned char GO; };
+struct nvmcon1_bits { unsigned char CMD; };
+volatile struct nvmcon0_bits *hal_nvmcon0(void);
+#define NVMCON0bits		(*hal_nvmcon0())
+HAL_REG volatile struct nvmcon1_bits NVMCON1bits;
+HAL_REG volatile uint32_t NVMADR;
+HAL_REG volatile unsigned char NVMDATL, NVMLOCK;
+
+/* Wiring the board leaves to the builder, all present here */
+#define USE_SD
+#define SD_CS			hal_sd_cs
+#define SD_CS_TRIS		hal_sd_cs_tris
+#define USE_Z80_INT
+#define Z80_INT			hal_z80_int
+#define Z80_INT_TRIS	hal_z80_int_tris
+#define Z80_M1			hal_z80_m1
+#define Z80_M1_TRIS		hal_z80_m1_tris
+#define Z80_M1_ANSEL	hal_z80_m1_ansel
+HAL_REG volatile unsigned char hal_z80_int, hal_z80_int_tris;
+HAL_REG volatile unsigned char hal_z80_m1, hal_z80_m1_tris, hal_z80_m1_ansel;
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * profmap - map a SuperMEZ80 profiler dump to Z80 symbols
+ *
+ * Build: cc -O2 -o profmap profmap.c
+ *
+ * Usage: profmap [-b] CAPTURE [SYMFILE...]
+ *   CAPTURE  UART capture holding the output of the console "p o"
+ *            command, the dump is found by its magic
+ *   SYMFILE  assembler listing, map or symbol file. Recognised lines:
+ *              0123  ...  NAME:  ...     listing with a label
+ *              NAME  EQU  0123H          NAME = $0123    NAME: equ 0x123
+ *              NAME 0123   or   0123 NAME
+ *            hex with or without $ 0x # H. Without symbols every bucket
+ *            is listed by address.
+ *   -b       list the buckets too, each with the symbol it starts in
+ *
+ * Dump: "Z80PROF\0", base (16-bit), shift, buckets (16-bit), samples,
+ * missed, outside (32-bit each), the 16-bit bucket counters, then
+ * CRC-16/XMODEM of everything after the magic. All little endian.
+ *
+ * A bucket is 1 << shift bytes and goes to the symbol at or below its
+ * first address, so use a small shift (p s BASE SHIFT) around the code
+ * of interest for routine level results.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#define HDR_SIZE	25	/* magic through outside */
+#define MAX_SYMS	8192
+
+static const char magic[8] = "Z80PROF";
+
+struct sym {
+	unsigned addr;
+	char name[32];
+	unsigned long count;
+};
+
+static struct sym syms[MAX_SYMS];
+static int nsyms;
+
+static unsigned crc16(const unsigned char *p, size_t n)
+{
+	unsigned crc = 0;
+	int i;
+
+	while (n--) {
+		crc ^= (unsigned)*p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1 ^ 0x1021) & 0xffff : (crc << 1) & 0xffff;
+	}
+	return crc;
+}
+
+static unsigned long get32(const unsigned char *p)
+{
+	return p[0] | p[1] << 8 | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+}
+
+static unsigned char *load(const char *path, long *size)
+{
+	FILE *fp = fopen(path, "rb");
+	unsigned char *buf;
+
+	if (!fp) {
+		perror(path);
+		exit(1);
+	}
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	rewind(fp);
+	buf = malloc(*size ? *size : 1);
+	if (!buf || fread(buf, 1, *size, fp) != (size_t)*size) {
+		perror(path);
+		exit(1);
+	}
+	fclose(fp);
+	return buf;
+}
+
+/* Hex number in one of the assembler spellings, -1 if it is not one */
+static long hexval(const char *t)
+{
+	char buf[16], *e;
+	size_t n = strlen(t);
+	long v;
+
+	if (n >= sizeof(buf) || !n)
+		return -1;
+	strcpy(buf, t);
+	if (buf[0] == '$' || buf[0] == '#')
+		memmove(buf, buf + 1, n--);
+	else if (buf[0] == '0' && (buf[1] == 'x' || buf[1] == 'X'))
+		memmove(buf, buf + 2, (n -= 2) + 1);
+	else if (n > 1 && (buf[n - 1] == 'h' || buf[n - 1] == 'H'))
+		buf[--n] = '\0';
+	if (!n || !isxdigit((unsigned char)buf[0]))
+		return -1;
+	v = strtol(buf, &e, 16);
+	if (*e || v < 0 || v > 0xffff)
+		return -1;
+	return v;
+}
+
+static int is_name(const char *t)
+{
+	if (!isalpha((unsigned char)*t) && *t != '_' && *t != '.' && *t != '?')
+		return 0;
+	for (t++; *t; t++)
+		if (!isalnum((unsigned char)*t) && !strchr("_.?$@", *t))
+			return 0;
+	return 1;
+}
+
+static int is_equ(const char *t)
+{
+	return !strcmp(t, "=") || !strcasecmp(t, "equ") || !strcasecmp(t, "defl");
+}
+
+static void add_sym(const char *name, long addr)
+{
+	if (nsyms >= MAX_SYMS || addr < 0)
+		return;
+	snprintf(syms[nsyms].name, sizeof(syms[nsyms].name), "%s", name);
+	syms[nsyms].addr = (unsigned)addr;
+	nsyms++;
+}
+
+static void load_syms(const char *path)
+{
+	FILE *fp = fopen(path, "r");
+	char line[512], *tok[16], *p;
+	int n, i;
+	long a;
+
+	if (!fp) {
+		perror(path);
+		exit(1);
+	}
+	while (fgets(line, sizeof(line), fp)) {
+		if ((p = strchr(line, ';')))
+			*p = '\0';
+		for (n = 0, p = strtok(line, " \t\r\n"); p && n < 16; p = strtok(NULL, " \t\r\n"))
+			tok[n++] = p;
+		if (n < 2)
+			continue;
+		/* NAME EQU value, NAME: EQU value */
+		if (n >= 3 && is_equ(tok[1])) {
+			tok[0][strcspn(tok[0], ":")] = '\0';
+			if (is_name(tok[0]))
+				add_sym(tok[0], hexval(tok[2]));
+			continue;
+		}
+		/* listing: address first, then a label with a colon */
+		if ((a = hexval(tok[0])) >= 0) {
+			for (i = 1; i < n; i++) {
+				size_t l = strlen(tok[i]);
+
+				if (l > 1 && tok[i][l - 1] == ':') {
+					tok[i][l - 1] = '\0';
+					if (is_name(tok[i]))
+						add_sym(tok[i], a);
+					break;
+				}
+			}
+			if (i < n)
+				continue;
+		}
+		/* two column symbol tables */
+		if (n == 2) {
+			if (is_name(tok[0]) && hexval(tok[1]) >= 0)
+				add_sym(tok[0], hexval(tok[1]));
+			else if (hexval(tok[0]) >= 0 && is_name(tok[1]))
+				add_sym(tok[1], hexval(tok[0]));
+		}
+	}
+	fclose(fp);
+}
+
+static int by_addr(const void *a, const void *b)
+{
+	return (int)((const struct sym *)a)->addr - (int)((const struct sym *)b)->addr;
+}
+
+static int by_count(const void *a, const void *b)
+{
+	unsigned long x = ((const struct sym *)a)->count, y = ((const struct sym *)b)->count;
+
+	return x < y ? 1 : x > y ? -1 : by_addr(a, b);
+}
+
+/* Symbol at or below addr, samples have no A15 so addr is below 0x8000 */
+static struct sym *lookup(unsigned addr)
+{
+	int lo = 0, hi = nsyms - 1, mid;
+	struct sym *s = NULL;
+
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (syms[mid].addr <= addr) {
+			s = &syms[mid];
+			lo = mid + 1;
+		} else
+			hi = mid - 1;
+	}
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned char *buf, *h = NULL, *cnt;
+	unsigned base, shift, nb, i, c, crc;
+	unsigned long samples, missed, outside, other = 0;
+	const char *in = NULL;
+	int list = 0, k;
+	long size, off;
+	struct sym *s;
+
+	for (k = 1; k < argc; k++) {
+		if (!strcmp(argv[k], "-b"))
+			list = 1;
+		else if (argv[k][0] == '-') {
+			in = NULL;
+			break;
+		} else if (!in)
+			in = argv[k];
+		else
+			load_syms(argv[k]);
+	}
+	if (!in) {
+		fprintf(stderr, "usage: profmap [-b] CAPTURE [SYMFILE...]\n");
+		return 2;
+	}
+	buf = load(in, &size);
+	for (off = 0; off + HDR_SIZE <= size; off++)
+		if (!memcmp(buf + off, magic, sizeof(magic))) {
+			h = buf + off;
+			break;
+		}
+	if (!h) {
+		fprintf(stderr, "%s: no profiler dump\n", in);
+		return 1;
+	}
+	base = h[8] | h[9] << 8;
+	shift = h[10];
+	nb = h[11] | h[12] << 8;
+	if (shift > 15 || off + HDR_SIZE + nb * 2 + 2 > size) {
+		fprintf(stderr, "%s: truncated profiler dump\n", in);
+		return 1;
+	}
+	crc = h[HDR_SIZE + nb * 2] | h[HDR_SIZE + nb * 2 + 1] << 8;
+	if (crc16(h + 8, HDR_SIZE - 8 + nb * 2) != crc) {
+		fprintf(stderr, "%s: CRC %04X, expected %04X\n",
+			in, crc16(h + 8, HDR_SIZE - 8 + nb * 2), crc);
+		return 1;
+	}
+	samples = get32(h + 13);
+	missed = get32(h + 17);
+	outside = get32(h + 21);
+	cnt = h + HDR_SIZE;
+	printf("%lu samples, %lu missed, %lu outside %04X-%04X, %u bytes per bucket\n",
+		samples, missed, outside, base, (base + (nb << shift) - 1) & 0xffff, 1u << shift);
+	if (!samples)
+		return 0;
+
+	qsort(syms, nsyms, sizeof(syms[0]), by_addr);
+	for (i = 0; i < nb; i++) {
+		c = cnt[i * 2] | cnt[i * 2 + 1] << 8;
+		if (!c)
+			continue;
+		s = lookup((base + (i << shift)) & 0x7fff);
+		if (s)
+			s->count += c;
+		else
+			other += c;
+		if (list || !nsyms) {
+			printf(" %04X %6u %5.1f%%", (base + (i << shift)) & 0xffff, c, c * 100.0 / samples);
+			if (s)
+				printf("  %s+%X", s->name, ((base + (i << shift)) & 0x7fff) - s->addr);
+			printf("\n");
+		}
+	}
+	if (!nsyms)
+		return 0;
+	qsort(syms, nsyms, sizeof(syms[0]), by_count);
+	printf("   samples      %%  address  symbol\n");
+	for (k = 0; k < nsyms && syms[k].count; k++)
+		printf(" %9lu %5.1f%%  %04X     %s\n", syms[k].count,
+			syms[k].count * 100.0 / samples, syms[k].addr, syms[k].name);
+	if (other)
+		printf(" %9lu %5.1f%%           (below the first symbol)\n", other, other * 100.0 / samples);
+	if (outside)
+		printf(" %9lu %5.1f%%           (outside the buckets)\n", outside, outside * 100.0 / samples);
+	return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * sdbench - SD card image and CP/M disk benchmark for tools/cosim
+ *
+ * Build: cc -O2 -o sdbench sdbench.c
+ *
+ * Usage: sdbench [-w] card.img bench.bin
+ *   card.img   new FAT32 volume (no partition table) holding DRIVEA.DSK-
+ *              DRIVED.DSK (77 tracks of 26 128-byte sectors, 0xE5) and an
+ *              empty SNAPSHOT.BIN, as USE_SD expects on the card
+ *   bench.bin  Z80 program: every sector of drive A through DISK_CMD and
+ *              DISK_DATA (INIR/OTIR), then DISK_CMD_FLUSH and HALT
+ *   -w         write the sectors instead of reading them
+ *
+ *   sdbench card.img bench.bin
+ *   ./cosim -b -F -f -d card.img -l bench.bin < /dev/null
+ *
+ * cosim reports the sectors and the host time from the first to the last
+ * DISK_CMD; the sectors/s figure compares firmware builds on one host.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SECTOR		512
+#define RESERVED	32			/* Boot sector, FSInfo, backup at 6 */
+#define DRIVES		4
+#define DRIVE_SIZE	(77UL * 26 * 128)
+#define SNAP_SIZE	(512UL + 0x8000)
+
+/* Sector loop, the listing is in the comments */
+static unsigned char bench[] = {
+	0x31, 0x00, 0x00,		/* 0000      LD   SP,0 */
+	0xaf,					/* 0003      XOR  A */
+	0xd3, 0x10,				/* 0004      OUT  (DISK_DRIVE),A */
+	0x11, 0x00, 0x00,		/* 0006      LD   DE,0        ; Track */
+	0x7b,					/* 0009 T:   LD   A,E */
+	0xd3, 0x11,				/* 000A      OUT  (DISK_TRACK),A */
+	0x7a,					/* 000C      LD   A,D */
+	0xd3, 0x12,				/* 000D      OUT  (DISK_TRACKH),A */
+	0xaf,					/* 000F      XOR  A           ; Sector */
+	0xd3, 0x13,				/* 0010 S:   OUT  (DISK_SECTOR),A */
+	0xf5,					/* 0012      PUSH AF */
+	0x21, 0x00, 0x40,		/* 0013      LD   HL,4000H */
+	0x01, 0x15, 0x80,		/* 0016      LD   BC,8015H    ; 128, DISK_DATA */
+	0x00, 0x00,				/* 0019      OTIR (-w) or 2 NOPs */
+	0x3e, 0x00,				/* 001B      LD   A,cmd */
+	0xd3, 0x14,				/* 001D      OUT  (DISK_CMD),A */
+	0xdb, 0x14,				/* 001F      IN   A,(DISK_CMD) */
+	0xb7,					/* 0021      OR   A */
+	0x20, 0x0e,				/* 0022      JR   NZ,E        ; Past the end */
+	0x21, 0x00, 0x40,		/* 0024      LD   HL,4000H */
+	0x00, 0x00,				/* 0027      INIR (read) or 2 NOPs */
+	0xf1,					/* 0029      POP  AF */
+	0x3c,					/* 002A      INC  A */
+	0xfe, 0x1a,				/* 002B      CP   26 */
+	0x20, 0xe1,				/* 002D      JR   NZ,S */
+	0x13,					/* 002F      INC  DE */
+	0x18, 0xd7,				/* 0030      JR   T */
+	0xf1,					/* 0032 E:   POP  AF */
+	0x3e, 0x02,				/* 0033      LD   A,DISK_CMD_FLUSH */
+	0xd3, 0x14,				/* 0035      OUT  (DISK_CMD),A */
+	0x76,					/* 0037      HALT */
+};
+#define BENCH_OTIR	0x19
+#define BENCH_CMD	0x1c
+#define BENCH_INIR	0x27
+
+static unsigned char *img;
+static unsigned long fat_sectors, data_lba, next_cl = 3;	/* 2 is the root */
+
+static void put16(unsigned char *p, unsigned v)
+{
+	p[0] = v & 0xff;
+	p[1] = v >> 8 & 0xff;
+}
+
+static void put32(unsigned char *p, unsigned long v)
+{
+	put16(p, v & 0xffff);
+	put16(p + 2, v >> 16);
+}
+
+static unsigned long clusters(unsigned long size)
+{
+	return (size + SECTOR - 1) / SECTOR;
+}
+
+static void fat_set(unsigned long cl, unsigned long v)
+{
+	put32(img + RESERVED * SECTOR + cl * 4, v);
+	put32(img + (RESERVED + fat_sectors) * SECTOR + cl * 4, v);
+}
+
+/* Contiguous chain filled with fill, directory entry e of the root */
+static void add_file(int e, const char *name, unsigned long size, int fill)
+{
+	unsigned char *d = img + data_lba * SECTOR + e * 32;
+	unsigned long n = clusters(size), i;
+
+	memcpy(d, name, 11);
+	d[11] = 0x20;				/* Archive */
+	put16(d + 20, next_cl >> 16);
+	put16(d + 26, next_cl & 0xffff);
+	put32(d + 28, size);
+	for (i = 0; i < n; i++)
+		fat_set(next_cl + i, i + 1 < n ? next_cl + i + 1 : 0x0fffffffUL);
+	memset(img + (data_lba + next_cl - 2) * SECTOR, fill, size);
+	next_cl += n;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long ncl, total;
+	unsigned char *b;
+	const char *card, *prog;
+	int wr = 0, d;
+	char name[12];
+	FILE *f;
+
+	if (argc > 1 && !strcmp(argv[1], "-w")) {
+		wr = 1;
+		argv++;
+		argc--;
+	}
+	if (argc != 3) {
+		fprintf(stderr, "usage: sdbench [-w] card.img bench.bin\n");
+		return 2;
+	}
+	card = argv[1];
+	prog = argv[2];
+
+	ncl = 1 + DRIVES * clusters(DRIVE_SIZE) + clusters(SNAP_SIZE);
+	fat_sectors = ((ncl + 2) * 4 + SECTOR - 1) / SECTOR;
+	data_lba = RESERVED + 2 * fat_sectors;
+	total = data_lba + ncl;
+	if (!(img = calloc(total, SECTOR))) {
+		perror("sdbench");
+		return 1;
+	}
+
+	b = img;					/* Boot sector */
+	memcpy(b, "\xeb\x58\x90" "MSWIN4.1", 11);
+	put16(b + 11, SECTOR);
+	b[13] = 1;					/* Sectors per cluster */
+	put16(b + 14, RESERVED);
+	b[16] = 2;					/* FATs */
+	b[21] = 0xf8;				/* Media */
+	put16(b + 24, 63);
+	put16(b + 26, 255);
+	put32(b + 32, total);
+	put32(b + 36, fat_sectors);
+	put32(b + 44, 2);			/* Root directory cluster */
+	put16(b + 48, 1);			/* FSInfo */
+	put16(b + 50, 6);			/* Backup boot sector */
+	b[64] = 0x80;
+	b[66] = 0x29;
+	memcpy(b + 71, "NO NAME    FAT32   ", 19);
+	b[510] = 0x55;
+	b[511] = 0xaa;
+	b = img + SECTOR;			/* FSInfo, free count unknown */
+	put32(b, 0x41615252UL);
+	put32(b + 484, 0x61417272UL);
+	put32(b + 488, 0xffffffffUL);
+	put32(b + 492, 0xffffffffUL);
+	put32(b + 508, 0xaa550000UL);
+	memcpy(img + 6 * SECTOR, img, 2 * SECTOR);
+
+	fat_set(0, 0x0ffffff8UL);
+	fat_set(1, 0x0fffffffUL);
+	fat_set(2, 0x0fffffffUL);	/* Root directory, one cluster */
+	for (d = 0; d < DRIVES; d++) {
+		snprintf(name, sizeof(name), "DRIVE%c  DSK", 'A' + d);
+		add_file(d, name, DRIVE_SIZE, 0xe5);
+	}
+	add_file(DRIVES, "SNAPSHOTBIN", SNAP_SIZE, 0x00);
+
+	if (!(f = fopen(card, "wb")) || fwrite(img, SECTOR, total, f) != total || fclose(f)) {
+		perror(card);
+		return 1;
+	}
+
+	bench[BENCH_CMD] = wr;		/* DISK_CMD_WRITE or DISK_CMD_READ */
+	if (wr) {
+		bench[BENCH_OTIR] = 0xed;
+		bench[BENCH_OTIR + 1] = 0xb3;
+	} else {
+		bench[BENCH_INIR] = 0xed;
+		bench[BENCH_INIR + 1] = 0xb2;
+	}
+	if (!(f = fopen(prog, "wb")) || fwrite(bench, 1, sizeof(bench), f) != sizeof(bench) || fclose(f)) {
+		perror(prog);
+		return 1;
+	}
+	printf("%s: %lu sectors, %d drives of %luKB, SNAPSHOT.BIN\n", card, total, DRIVES, DRIVE_SIZE / 1024);
+	printf("%s: %s the %lu sectors of drive A\n", prog, wr ? "writes" : "reads", DRIVE_SIZE / 128);
+	return 0;
+}
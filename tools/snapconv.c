@@ -0,0 +1,172 @@
+/*
+ * snapconv - convert SuperMEZ80 RAM snapshots to and from binary files
+ *
+ * Build: cc -O2 -o snapconv snapconv.c
+ *
+ * Usage: snapconv [-o ram.bin] SNAPSHOT
+ *          show the header, check the CRC and extract the RAM image.
+ *          SNAPSHOT is SNAPSHOT.BIN from the SD card, or a UART capture
+ *          holding a snapshot stream anywhere in it
+ *        snapconv -s SP [-f] -o SNAPSHOT ram.bin
+ *          build a snapshot of ram.bin (up to 32KB) resuming with SP
+ *          -f  SNAPSHOT.BIN layout for the SD card (RAM at 512),
+ *              otherwise a stream for the console r command (RAM at 16)
+ *
+ * Header: "Z80SNAP\0", SP, length, CRC-16/XMODEM of the RAM and the
+ * offset of the RAM from the header, all 16-bit little endian.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAP_LEN	0x8000
+#define SNAP_HDR	16
+
+static const char magic[8] = "Z80SNAP";
+
+static unsigned crc16(const unsigned char *p, size_t n)
+{
+	unsigned crc = 0;
+	int i;
+
+	while (n--) {
+		crc ^= *p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc & 0xffff;
+}
+
+static unsigned get16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static void put16(unsigned char *p, unsigned v)
+{
+	p[0] = v & 0xff;
+	p[1] = (v >> 8) & 0xff;
+}
+
+static unsigned char *load(const char *path, long *size)
+{
+	FILE *fp = fopen(path, "rb");
+	unsigned char *buf;
+
+	if (!fp) {
+		perror(path);
+		exit(1);
+	}
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	rewind(fp);
+	buf = malloc(*size ? *size : 1);
+	if (!buf || fread(buf, 1, *size, fp) != (size_t)*size) {
+		perror(path);
+		exit(1);
+	}
+	fclose(fp);
+	return buf;
+}
+
+static void save(const char *path, const unsigned char *buf, long size)
+{
+	FILE *fp = fopen(path, "wb");
+
+	if (!fp || fwrite(buf, 1, size, fp) != (size_t)size || fclose(fp)) {
+		perror(path);
+		exit(1);
+	}
+}
+
+static int extract(const char *in, const char *out)
+{
+	unsigned char *buf, *h = NULL, *ram;
+	unsigned sp, len, crc, off;
+	long size, i;
+
+	buf = load(in, &size);
+	for (i = 0; i + SNAP_HDR <= size; i++)
+		if (!memcmp(buf + i, magic, sizeof(magic))) {
+			h = buf + i;
+			break;
+		}
+	if (!h) {
+		fprintf(stderr, "%s: no snapshot header\n", in);
+		return 1;
+	}
+	sp = get16(h + 8);
+	len = get16(h + 10);
+	crc = get16(h + 12);
+	off = get16(h + 14);
+	printf("header at %ld: SP=%04X length=%04X CRC=%04X offset=%u\n",
+		i, sp, len, crc, off);
+	if (len != SNAP_LEN || i + off + len > size) {
+		fprintf(stderr, "%s: truncated snapshot\n", in);
+		return 1;
+	}
+	ram = h + off;
+	if (crc16(ram, len) != crc) {
+		fprintf(stderr, "%s: CRC %04X, expected %04X\n", in, crc16(ram, len), crc);
+		return 1;
+	}
+	if (out)
+		save(out, ram, len);
+	return 0;
+}
+
+static int build(const char *in, const char *out, unsigned sp, int sdfile)
+{
+	unsigned char *ram, *snap;
+	unsigned off = sdfile ? 512 : SNAP_HDR;
+	long size;
+
+	ram = load(in, &size);
+	if (size > SNAP_LEN) {
+		fprintf(stderr, "%s: larger than %d bytes\n", in, SNAP_LEN);
+		return 1;
+	}
+	if (sp < 19 + 3 || sp > SNAP_LEN - 2) {
+		fprintf(stderr, "SP %04X leaves no room for the resume stub\n", sp);
+		return 1;
+	}
+	snap = calloc(1, off + SNAP_LEN);
+	memcpy(snap, magic, sizeof(magic));
+	memcpy(snap + off, ram, size);
+	put16(snap + 8, sp);
+	put16(snap + 10, SNAP_LEN);
+	put16(snap + 12, crc16(snap + off, SNAP_LEN));
+	put16(snap + 14, off);
+	save(out, snap, off + SNAP_LEN);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *out = NULL, *in = NULL;
+	long sp = -1;
+	int i, sdfile = 0;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			out = argv[++i];
+		} else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+			sp = strtol(argv[++i], NULL, 0) & 0xffff;
+		} else if (!strcmp(argv[i], "-f")) {
+			sdfile = 1;
+		} else if (argv[i][0] != '-' && !in) {
+			in = argv[i];
+		} else {
+			in = NULL;
+			break;
+		}
+	}
+	if (!in || (sp >= 0 && !out)) {
+		fprintf(stderr, "usage: snapconv [-o ram.bin] SNAPSHOT\n"
+			"       snapconv -s SP [-f] -o SNAPSHOT ram.bin\n");
+		return 2;
+	}
+	if (sp >= 0)
+		return build(in, out, (unsigned)sp, sdfile);
+	return extract(in, out);
+}
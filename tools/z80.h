@@ -0,0 +1,788 @@
+/*
+ * z80.h - small Z80 interpreter for the SuperMEZ80 host tools
+ *
+ * Header only, everything static. The caller owns the 64KB memory and
+ * supplies the IO callbacks:
+ *
+ *	struct z80 cpu;
+ *	z80_reset(&cpu);
+ *	cpu.mem = ram; cpu.in = my_in; cpu.out = my_out; cpu.ctx = ...;
+ *	while (...)
+ *		z80_step(&cpu);		returns the T states of the instruction
+ *
+ * All documented instructions plus the usual undocumented ones (IXH/IXL,
+ * SLL, DDCB with register copy, IN (C) / OUT (C),0). Flag bits 3 and 5
+ * follow the result like the real part except for the block IO group.
+ * z80_int() raises a maskable interrupt in mode 0 (RST only), 1 or 2.
+ */
+#ifndef Z80_INTERP_H
+#define Z80_INTERP_H
+
+#define Z80_CF	0x01
+#define Z80_NF	0x02
+#define Z80_PF	0x04
+#define Z80_XF	0x08
+#define Z80_HF	0x10
+#define Z80_YF	0x20
+#define Z80_ZF	0x40
+#define Z80_SF	0x80
+
+/* r[] order follows the opcode encoding, F sits in the (HL) slot */
+enum { Z80_B, Z80_C, Z80_D, Z80_E, Z80_H, Z80_L, Z80_F, Z80_A };
+
+struct z80 {
+	unsigned char r[8];
+	unsigned char alt[8];			/* B' C' D' E' H' L' F' A' */
+	unsigned short ix, iy, sp, pc;
+	unsigned char i, rr, iff1, iff2, im, halted;
+	unsigned char ei_delay;			/* no interrupt right after EI */
+	unsigned long long cycles;
+	unsigned long long insns;
+	unsigned char *mem;
+	unsigned char (*in)(void *ctx, unsigned short port);
+	void (*out)(void *ctx, unsigned short port, unsigned char v);
+	void *ctx;
+};
+
+static unsigned char z80_szp[256];		/* S, Z, P, X, Y of a byte */
+
+static void z80_reset(struct z80 *c)
+{
+	int i, p, b;
+
+	for (i = 0; i < 256; i++) {
+		for (p = 0, b = i; b; b >>= 1)
+			p ^= b & 1;
+		z80_szp[i] = (i & (Z80_SF | Z80_XF | Z80_YF)) | (i ? 0 : Z80_ZF) | (p ? 0 : Z80_PF);
+	}
+	memset(c->r, 0xff, sizeof(c->r));
+	memset(c->alt, 0xff, sizeof(c->alt));
+	c->ix = c->iy = c->sp = 0xffff;
+	c->pc = 0;
+	c->i = c->rr = 0;
+	c->iff1 = c->iff2 = c->im = c->halted = c->ei_delay = 0;
+}
+
+#define Z80_RD(c, a)		((c)->mem[(unsigned short)(a)])
+#define Z80_WR(c, a, v)		((c)->mem[(unsigned short)(a)] = (unsigned char)(v))
+#define Z80_PAIR(c, h)		((unsigned short)((c)->r[h] << 8 | (c)->r[(h) + 1]))
+#define Z80_SETPAIR(c, h, v)	((c)->r[h] = (unsigned char)((v) >> 8), (c)->r[(h) + 1] = (unsigned char)(v))
+#define Z80_AF(c)			((unsigned short)((c)->r[Z80_A] << 8 | (c)->r[Z80_F]))
+
+static unsigned char z80_fetch(struct z80 *c)
+{
+	return Z80_RD(c, c->pc++);
+}
+
+static unsigned short z80_fetch16(struct z80 *c)
+{
+	unsigned short v = Z80_RD(c, c->pc) | Z80_RD(c, c->pc + 1) << 8;
+
+	c->pc += 2;
+	return v;
+}
+
+static unsigned short z80_rd16(struct z80 *c, unsigned short a)
+{
+	return Z80_RD(c, a) | Z80_RD(c, a + 1) << 8;
+}
+
+static void z80_wr16(struct z80 *c, unsigned short a, unsigned short v)
+{
+	Z80_WR(c, a, v & 0xff);
+	Z80_WR(c, a + 1, v >> 8);
+}
+
+static void z80_push(struct z80 *c, unsigned short v)
+{
+	c->sp -= 2;
+	z80_wr16(c, c->sp, v);
+}
+
+static unsigned short z80_pop(struct z80 *c)
+{
+	unsigned short v = z80_rd16(c, c->sp);
+
+	c->sp += 2;
+	return v;
+}
+
+static void z80_inc_r(struct z80 *c)
+{
+	c->rr = (c->rr & 0x80) | ((c->rr + 1) & 0x7f);
+}
+
+/* 8-bit arithmetic, op: 0 ADD 1 ADC 2 SUB 3 SBC 4 AND 5 XOR 6 OR 7 CP */
+static void z80_alu(struct z80 *c, int op, unsigned char v)
+{
+	unsigned a = c->r[Z80_A], res, cy = c->r[Z80_F] & Z80_CF;
+	unsigned char f;
+
+	switch (op) {
+	case 0:
+	case 1:
+		res = a + v + (op == 1 ? cy : 0);
+		f = (z80_szp[res & 0xff] & ~Z80_PF) | ((a ^ v ^ res) & Z80_HF)
+			| ((~(a ^ v) & (a ^ res) & 0x80) ? Z80_PF : 0) | (res > 0xff ? Z80_CF : 0);
+		c->r[Z80_A] = (unsigned char)res;
+		break;
+	case 2:
+	case 3:
+	case 7:
+		res = a - v - (op == 3 ? cy : 0);
+		f = (z80_szp[res & 0xff] & ~Z80_PF) | Z80_NF | ((a ^ v ^ res) & Z80_HF)
+			| (((a ^ v) & (a ^ res) & 0x80) ? Z80_PF : 0) | (res > 0xff ? Z80_CF : 0);
+		if (op == 7)		/* CP: bits 3 and 5 come from the operand */
+			f = (f & ~(Z80_XF | Z80_YF)) | (v & (Z80_XF | Z80_YF));
+		else
+			c->r[Z80_A] = (unsigned char)res;
+		break;
+	case 4:
+		c->r[Z80_A] = a &= v;
+		f = z80_szp[a] | Z80_HF;
+		break;
+	case 5:
+		c->r[Z80_A] = a ^= v;
+		f = z80_szp[a];
+		break;
+	default:
+		c->r[Z80_A] = a |= v;
+		f = z80_szp[a];
+		break;
+	}
+	c->r[Z80_F] = f;
+}
+
+static unsigned char z80_inc8(struct z80 *c, unsigned char v)
+{
+	unsigned char r = v + 1;
+
+	c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | (z80_szp[r] & ~Z80_PF)
+		| ((v & 0x0f) == 0x0f ? Z80_HF : 0) | (v == 0x7f ? Z80_PF : 0);
+	return r;
+}
+
+static unsigned char z80_dec8(struct z80 *c, unsigned char v)
+{
+	unsigned char r = v - 1;
+
+	c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | (z80_szp[r] & ~Z80_PF) | Z80_NF
+		| ((v & 0x0f) == 0x00 ? Z80_HF : 0) | (v == 0x80 ? Z80_PF : 0);
+	return r;
+}
+
+static unsigned short z80_add16(struct z80 *c, unsigned short a, unsigned short v)
+{
+	unsigned long res = (unsigned long)a + v;
+
+	c->r[Z80_F] = (c->r[Z80_F] & (Z80_SF | Z80_ZF | Z80_PF))
+		| (((a ^ v ^ res) >> 8) & Z80_HF) | ((res >> 8) & (Z80_XF | Z80_YF))
+		| (res > 0xffff ? Z80_CF : 0);
+	return (unsigned short)res;
+}
+
+static unsigned short z80_adc16(struct z80 *c, unsigned short a, unsigned short v, int sub)
+{
+	unsigned long cy = c->r[Z80_F] & Z80_CF;
+	unsigned long res = sub ? (unsigned long)a - v - cy : (unsigned long)a + v + cy;
+	unsigned char f;
+
+	f = ((res >> 8) & (Z80_SF | Z80_XF | Z80_YF)) | ((res & 0xffff) ? 0 : Z80_ZF)
+		| (((a ^ v ^ res) >> 8) & Z80_HF) | ((res >> 16) & 1 ? Z80_CF : 0);
+	if (sub)
+		f |= Z80_NF | (((a ^ v) & (a ^ res) & 0x8000) ? Z80_PF : 0);
+	else
+		f |= ((~(a ^ v) & (a ^ res) & 0x8000) ? Z80_PF : 0);
+	c->r[Z80_F] = f;
+	return (unsigned short)res;
+}
+
+/* CB rotates and shifts, op: RLC RRC RL RR SLA SRA SLL SRL */
+static unsigned char z80_rot(struct z80 *c, int op, unsigned char v)
+{
+	unsigned char r, cy;
+
+	switch (op) {
+	case 0: cy = v >> 7; r = (unsigned char)(v << 1 | cy); break;
+	case 1: cy = v & 1; r = (unsigned char)(v >> 1 | cy << 7); break;
+	case 2: cy = v >> 7; r = (unsigned char)(v << 1 | (c->r[Z80_F] & Z80_CF)); break;
+	case 3: cy = v & 1; r = (unsigned char)(v >> 1 | (c->r[Z80_F] & Z80_CF) << 7); break;
+	case 4: cy = v >> 7; r = (unsigned char)(v << 1); break;
+	case 5: cy = v & 1; r = (unsigned char)((v >> 1) | (v & 0x80)); break;
+	case 6: cy = v >> 7; r = (unsigned char)(v << 1 | 1); break;
+	default: cy = v & 1; r = v >> 1; break;
+	}
+	c->r[Z80_F] = z80_szp[r] | cy;
+	return r;
+}
+
+static void z80_daa(struct z80 *c)
+{
+	unsigned char a = c->r[Z80_A], f = c->r[Z80_F], d = 0, cy = f & Z80_CF;
+
+	if ((f & Z80_HF) || (a & 0x0f) > 9)
+		d = 0x06;
+	if (cy || a > 0x99) {
+		d |= 0x60;
+		cy = Z80_CF;
+	}
+	a = f & Z80_NF ? a - d : a + d;
+	c->r[Z80_F] = z80_szp[a] | cy | (f & Z80_NF) | ((c->r[Z80_A] ^ a) & Z80_HF);
+	c->r[Z80_A] = a;
+}
+
+static int z80_cond(struct z80 *c, int y)
+{
+	static const unsigned char mask[4] = { Z80_ZF, Z80_CF, Z80_PF, Z80_SF };
+	int set = (c->r[Z80_F] & mask[y >> 1]) != 0;
+
+	return y & 1 ? set : !set;
+}
+
+/* HL, IX or IY by prefix */
+static unsigned short z80_hl(struct z80 *c, int idx)
+{
+	return idx == 1 ? c->ix : idx == 2 ? c->iy : Z80_PAIR(c, Z80_H);
+}
+
+static void z80_sethl(struct z80 *c, int idx, unsigned short v)
+{
+	if (idx == 1)
+		c->ix = v;
+	else if (idx == 2)
+		c->iy = v;
+	else
+		Z80_SETPAIR(c, Z80_H, v);
+}
+
+/* rp table: BC DE HL SP */
+static unsigned short z80_rp(struct z80 *c, int p, int idx)
+{
+	return p == 3 ? c->sp : p == 2 ? z80_hl(c, idx) : Z80_PAIR(c, p * 2);
+}
+
+static void z80_setrp(struct z80 *c, int p, int idx, unsigned short v)
+{
+	if (p == 3)
+		c->sp = v;
+	else if (p == 2)
+		z80_sethl(c, idx, v);
+	else
+		Z80_SETPAIR(c, p * 2, v);
+}
+
+/* Register k (not 6) with IXH/IXL/IYH/IYL under a prefix */
+static unsigned char z80_get8(struct z80 *c, int k, int idx)
+{
+	if (idx && (k == Z80_H || k == Z80_L)) {
+		unsigned short x = idx == 1 ? c->ix : c->iy;
+
+		return k == Z80_H ? x >> 8 : x & 0xff;
+	}
+	return c->r[k];
+}
+
+static void z80_set8(struct z80 *c, int k, int idx, unsigned char v)
+{
+	if (idx && (k == Z80_H || k == Z80_L)) {
+		unsigned short *x = idx == 1 ? &c->ix : &c->iy;
+
+		*x = k == Z80_H ? (unsigned short)((*x & 0x00ff) | v << 8) : (unsigned short)((*x & 0xff00) | v);
+		return;
+	}
+	c->r[k] = v;
+}
+
+static int z80_cb(struct z80 *c, int idx)
+{
+	unsigned short addr = 0;
+	unsigned char op, v;
+	int x, y, z;
+
+	if (idx) {					/* DD CB d op */
+		addr = z80_hl(c, idx) + (signed char)z80_fetch(c);
+		op = z80_fetch(c);
+	} else {
+		op = z80_fetch(c);
+		z80_inc_r(c);
+	}
+	x = op >> 6;
+	y = (op >> 3) & 7;
+	z = op & 7;
+	if (idx || z == 6) {
+		if (!idx)
+			addr = Z80_PAIR(c, Z80_H);
+		v = Z80_RD(c, addr);
+	} else
+		v = c->r[z];
+	switch (x) {
+	case 0:
+		v = z80_rot(c, y, v);
+		break;
+	case 1:
+		c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | Z80_HF
+			| (z80_szp[v & (1 << y)] & (Z80_SF | Z80_ZF | Z80_PF)) | (v & (Z80_XF | Z80_YF));
+		if (idx)
+			return 20;
+		return z == 6 ? 12 : 8;
+	case 2:
+		v &= ~(1 << y);
+		break;
+	default:
+		v |= 1 << y;
+		break;
+	}
+	if (idx || z == 6) {
+		Z80_WR(c, addr, v);
+		if (idx && z != 6)		/* Undocumented copy to a register */
+			c->r[z] = v;
+		return idx ? 23 : 15;
+	}
+	c->r[z] = v;
+	return 8;
+}
+
+static int z80_ed(struct z80 *c)
+{
+	unsigned char op = z80_fetch(c), v, n;
+	int x, y, z, p, q;
+	unsigned short bc, hl, de;
+
+	z80_inc_r(c);
+	x = op >> 6;
+	y = (op >> 3) & 7;
+	z = op & 7;
+	p = y >> 1;
+	q = y & 1;
+	if (x == 1) {
+		switch (z) {
+		case 0:					/* IN r,(C) */
+			v = c->in(c->ctx, Z80_PAIR(c, Z80_B));
+			if (y != 6)
+				c->r[y] = v;
+			c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | z80_szp[v];
+			return 12;
+		case 1:					/* OUT (C),r */
+			c->out(c->ctx, Z80_PAIR(c, Z80_B), y == 6 ? 0 : c->r[y]);
+			return 12;
+		case 2:					/* SBC/ADC HL,rp */
+			Z80_SETPAIR(c, Z80_H, z80_adc16(c, Z80_PAIR(c, Z80_H), z80_rp(c, p, 0), !q));
+			return 15;
+		case 3:					/* LD (nn),rp / LD rp,(nn) */
+			if (q)
+				z80_setrp(c, p, 0, z80_rd16(c, z80_fetch16(c)));
+			else
+				z80_wr16(c, z80_fetch16(c), z80_rp(c, p, 0));
+			return 20;
+		case 4:					/* NEG */
+			v = c->r[Z80_A];
+			c->r[Z80_A] = 0;
+			z80_alu(c, 2, v);
+			return 8;
+		case 5:					/* RETN / RETI */
+			c->iff1 = c->iff2;
+			c->pc = z80_pop(c);
+			return 14;
+		case 6:					/* IM */
+			c->im = (y & 3) < 2 ? 0 : (y & 3) - 1;
+			return 8;
+		default:
+			switch (y) {
+			case 0: c->i = c->r[Z80_A]; return 9;
+			case 1: c->rr = c->r[Z80_A]; return 9;
+			case 2:
+			case 3:
+				v = y == 2 ? c->i : c->rr;
+				c->r[Z80_A] = v;
+				c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | (z80_szp[v] & ~Z80_PF) | (c->iff2 ? Z80_PF : 0);
+				return 9;
+			case 4:				/* RRD */
+				hl = Z80_PAIR(c, Z80_H);
+				v = Z80_RD(c, hl);
+				Z80_WR(c, hl, (c->r[Z80_A] << 4) | (v >> 4));
+				c->r[Z80_A] = (c->r[Z80_A] & 0xf0) | (v & 0x0f);
+				c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | z80_szp[c->r[Z80_A]];
+				return 18;
+			case 5:				/* RLD */
+				hl = Z80_PAIR(c, Z80_H);
+				v = Z80_RD(c, hl);
+				Z80_WR(c, hl, (v << 4) | (c->r[Z80_A] & 0x0f));
+				c->r[Z80_A] = (c->r[Z80_A] & 0xf0) | (v >> 4);
+				c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | z80_szp[c->r[Z80_A]];
+				return 18;
+			default:
+				return 8;
+			}
+		}
+	}
+	if (x == 2 && z <= 3 && y >= 4) {	/* Block instructions */
+		int dir = y & 1 ? -1 : 1, rep = y >= 6;
+
+		bc = Z80_PAIR(c, Z80_B);
+		hl = Z80_PAIR(c, Z80_H);
+		de = Z80_PAIR(c, Z80_D);
+		switch (z) {
+		case 0:					/* LDI LDD LDIR LDDR */
+			v = Z80_RD(c, hl);
+			Z80_WR(c, de, v);
+			Z80_SETPAIR(c, Z80_H, hl + dir);
+			Z80_SETPAIR(c, Z80_D, de + dir);
+			Z80_SETPAIR(c, Z80_B, --bc);
+			n = v + c->r[Z80_A];
+			c->r[Z80_F] = (c->r[Z80_F] & (Z80_SF | Z80_ZF | Z80_CF)) | (bc ? Z80_PF : 0)
+				| (n & Z80_XF) | ((n << 4) & Z80_YF);
+			if (rep && bc) {
+				c->pc -= 2;
+				return 21;
+			}
+			return 16;
+		case 1:					/* CPI CPD CPIR CPDR */
+			v = Z80_RD(c, hl);
+			n = c->r[Z80_A] - v;
+			Z80_SETPAIR(c, Z80_H, hl + dir);
+			Z80_SETPAIR(c, Z80_B, --bc);
+			c->r[Z80_F] = (c->r[Z80_F] & Z80_CF) | Z80_NF | (z80_szp[n] & (Z80_SF | Z80_ZF))
+				| ((c->r[Z80_A] ^ v ^ n) & Z80_HF) | (bc ? Z80_PF : 0);
+			if (c->r[Z80_F] & Z80_HF)
+				n--;
+			c->r[Z80_F] |= (n & Z80_XF) | ((n << 4) & Z80_YF);
+			if (rep && bc && v != c->r[Z80_A]) {
+				c->pc -= 2;
+				return 21;
+			}
+			return 16;
+		case 2:					/* INI IND INIR INDR */
+			v = c->in(c->ctx, bc);
+			Z80_WR(c, hl, v);
+			Z80_SETPAIR(c, Z80_H, hl + dir);
+			c->r[Z80_B]--;
+			c->r[Z80_F] = (z80_szp[c->r[Z80_B]] & ~Z80_PF) | Z80_NF | (c->r[Z80_F] & Z80_CF);
+			if (rep && c->r[Z80_B]) {
+				c->pc -= 2;
+				return 21;
+			}
+			return 16;
+		default:				/* OUTI OUTD OTIR OTDR */
+			v = Z80_RD(c, hl);
+			c->r[Z80_B]--;
+			c->out(c->ctx, Z80_PAIR(c, Z80_B), v);
+			Z80_SETPAIR(c, Z80_H, hl + dir);
+			c->r[Z80_F] = (z80_szp[c->r[Z80_B]] & ~Z80_PF) | Z80_NF | (c->r[Z80_F] & Z80_CF);
+			if (rep && c->r[Z80_B]) {
+				c->pc -= 2;
+				return 21;
+			}
+			return 16;
+		}
+	}
+	return 8;					/* NONI */
+}
+
+/* Execute one instruction, returns T states */
+static int z80_step(struct z80 *c)
+{
+	unsigned char op, v;
+	unsigned short addr, w;
+	int x, y, z, p, q, idx = 0, t = 0, k;
+
+	c->ei_delay = 0;
+	if (c->halted) {
+		z80_inc_r(c);
+		c->cycles += 4;
+		return 4;
+	}
+	c->insns++;
+	for (;;) {
+		op = z80_fetch(c);
+		z80_inc_r(c);
+		if (op == 0xdd || op == 0xfd) {
+			idx = op == 0xdd ? 1 : 2;
+			t += 4;
+			continue;
+		}
+		break;
+	}
+	x = op >> 6;
+	y = (op >> 3) & 7;
+	z = op & 7;
+	p = y >> 1;
+	q = y & 1;
+
+	switch (x) {
+	case 0:
+		switch (z) {
+		case 0:
+			switch (y) {
+			case 0:
+				t += 4;
+				break;
+			case 1:				/* EX AF,AF' */
+				v = c->r[Z80_A]; c->r[Z80_A] = c->alt[Z80_A]; c->alt[Z80_A] = v;
+				v = c->r[Z80_F]; c->r[Z80_F] = c->alt[Z80_F]; c->alt[Z80_F] = v;
+				t += 4;
+				break;
+			case 2:				/* DJNZ */
+				v = z80_fetch(c);
+				if (--c->r[Z80_B]) {
+					c->pc += (signed char)v;
+					t += 13;
+				} else
+					t += 8;
+				break;
+			default:			/* JR, JR cc */
+				v = z80_fetch(c);
+				if (y == 3 || z80_cond(c, y - 4)) {
+					c->pc += (signed char)v;
+					t += 12;
+				} else
+					t += 7;
+				break;
+			}
+			break;
+		case 1:
+			if (q) {
+				z80_sethl(c, idx, z80_add16(c, z80_hl(c, idx), z80_rp(c, p, idx)));
+				t += 11;
+			} else {
+				z80_setrp(c, p, idx, z80_fetch16(c));
+				t += 10;
+			}
+			break;
+		case 2:
+			switch (y) {
+			case 0: Z80_WR(c, Z80_PAIR(c, Z80_B), c->r[Z80_A]); t += 7; break;
+			case 1: c->r[Z80_A] = Z80_RD(c, Z80_PAIR(c, Z80_B)); t += 7; break;
+			case 2: Z80_WR(c, Z80_PAIR(c, Z80_D), c->r[Z80_A]); t += 7; break;
+			case 3: c->r[Z80_A] = Z80_RD(c, Z80_PAIR(c, Z80_D)); t += 7; break;
+			case 4: z80_wr16(c, z80_fetch16(c), z80_hl(c, idx)); t += 16; break;
+			case 5: z80_sethl(c, idx, z80_rd16(c, z80_fetch16(c))); t += 16; break;
+			case 6: Z80_WR(c, z80_fetch16(c), c->r[Z80_A]); t += 13; break;
+			default: c->r[Z80_A] = Z80_RD(c, z80_fetch16(c)); t += 13; break;
+			}
+			break;
+		case 3:
+			z80_setrp(c, p, idx, z80_rp(c, p, idx) + (q ? -1 : 1));
+			t += 6;
+			break;
+		case 4:
+		case 5:
+			if (y == 6) {
+				addr = z80_hl(c, idx);
+				if (idx) {
+					addr += (signed char)z80_fetch(c);
+					t += 8;
+				}
+				v = Z80_RD(c, addr);
+				Z80_WR(c, addr, z == 4 ? z80_inc8(c, v) : z80_dec8(c, v));
+				t += 11;
+			} else {
+				v = z80_get8(c, y, idx);
+				z80_set8(c, y, idx, z == 4 ? z80_inc8(c, v) : z80_dec8(c, v));
+				t += 4;
+			}
+			break;
+		case 6:
+			if (y == 6) {
+				addr = z80_hl(c, idx);
+				if (idx) {
+					addr += (signed char)z80_fetch(c);
+					t += 5;
+				}
+				Z80_WR(c, addr, z80_fetch(c));
+				t += 10;
+			} else {
+				z80_set8(c, y, idx, z80_fetch(c));
+				t += 7;
+			}
+			break;
+		default: {
+			unsigned char a = c->r[Z80_A], f = c->r[Z80_F];
+
+			switch (y) {
+			case 0: a = (unsigned char)(a << 1 | a >> 7); f = (f & ~(Z80_HF | Z80_NF | Z80_CF)) | (a & 1); break;
+			case 1: f = (f & ~(Z80_HF | Z80_NF | Z80_CF)) | (a & 1); a = (unsigned char)(a >> 1 | a << 7); break;
+			case 2: v = a >> 7; a = (unsigned char)(a << 1 | (f & Z80_CF)); f = (f & ~(Z80_HF | Z80_NF | Z80_CF)) | v; break;
+			case 3: v = a & 1; a = (unsigned char)(a >> 1 | (f & Z80_CF) << 7); f = (f & ~(Z80_HF | Z80_NF | Z80_CF)) | v; break;
+			case 4: c->r[Z80_A] = a; z80_daa(c); a = c->r[Z80_A]; f = c->r[Z80_F]; break;
+			case 5: a = ~a; f |= Z80_HF | Z80_NF; break;
+			case 6: f = (f & ~(Z80_HF | Z80_NF)) | Z80_CF; break;
+			default: f = ((f & ~(Z80_HF | Z80_NF)) | ((f & Z80_CF) << 4)) ^ Z80_CF; break;
+			}
+			c->r[Z80_A] = a;
+			c->r[Z80_F] = (f & ~(Z80_XF | Z80_YF)) | (a & (Z80_XF | Z80_YF));
+			t += 4;
+			break;
+		}
+		}
+		break;
+	case 1:
+		if (y == 6 && z == 6) {	/* HALT */
+			c->halted = 1;
+			t += 4;
+		} else if (y == 6 || z == 6) {
+			addr = z80_hl(c, idx);
+			if (idx) {
+				addr += (signed char)z80_fetch(c);
+				t += 8;
+			}
+			if (y == 6)
+				Z80_WR(c, addr, c->r[z]);	/* LD (HL),r uses H/L even with a prefix */
+			else
+				c->r[y] = Z80_RD(c, addr);
+			t += 7;
+		} else {
+			z80_set8(c, y, idx, z80_get8(c, z, idx));
+			t += 4;
+		}
+		break;
+	case 2:
+		if (z == 6) {
+			addr = z80_hl(c, idx);
+			if (idx) {
+				addr += (signed char)z80_fetch(c);
+				t += 8;
+			}
+			z80_alu(c, y, Z80_RD(c, addr));
+			t += 7;
+		} else {
+			z80_alu(c, y, z80_get8(c, z, idx));
+			t += 4;
+		}
+		break;
+	default:
+		switch (z) {
+		case 0:					/* RET cc */
+			if (z80_cond(c, y)) {
+				c->pc = z80_pop(c);
+				t += 11;
+			} else
+				t += 5;
+			break;
+		case 1:
+			if (!q) {			/* POP */
+				w = z80_pop(c);
+				if (p == 3) {
+					c->r[Z80_A] = w >> 8;
+					c->r[Z80_F] = w & 0xff;
+				} else
+					z80_setrp(c, p, idx, w);
+				t += 10;
+				break;
+			}
+			switch (p) {
+			case 0: c->pc = z80_pop(c); t += 10; break;
+			case 1:				/* EXX */
+				for (k = 0; k < 6; k++) {
+					v = c->r[k]; c->r[k] = c->alt[k]; c->alt[k] = v;
+				}
+				t += 4;
+				break;
+			case 2: c->pc = z80_hl(c, idx); t += 4; break;
+			default: c->sp = z80_hl(c, idx); t += 6; break;
+			}
+			break;
+		case 2:					/* JP cc */
+			w = z80_fetch16(c);
+			if (z80_cond(c, y))
+				c->pc = w;
+			t += 10;
+			break;
+		case 3:
+			switch (y) {
+			case 0: c->pc = z80_fetch16(c); t += 10; break;
+			case 1: t += z80_cb(c, idx); break;
+			case 2:				/* OUT (n),A */
+				c->out(c->ctx, (unsigned short)(c->r[Z80_A] << 8 | z80_fetch(c)), c->r[Z80_A]);
+				t += 11;
+				break;
+			case 3:				/* IN A,(n) */
+				c->r[Z80_A] = c->in(c->ctx, (unsigned short)(c->r[Z80_A] << 8 | z80_fetch(c)));
+				t += 11;
+				break;
+			case 4:				/* EX (SP),HL */
+				w = z80_rd16(c, c->sp);
+				z80_wr16(c, c->sp, z80_hl(c, idx));
+				z80_sethl(c, idx, w);
+				t += 19;
+				break;
+			case 5:				/* EX DE,HL (never IX) */
+				w = Z80_PAIR(c, Z80_D);
+				Z80_SETPAIR(c, Z80_D, Z80_PAIR(c, Z80_H));
+				Z80_SETPAIR(c, Z80_H, w);
+				t += 4;
+				break;
+			case 6:
+				c->iff1 = c->iff2 = 0;
+				t += 4;
+				break;
+			default:
+				c->iff1 = c->iff2 = 1;
+				c->ei_delay = 1;
+				t += 4;
+				break;
+			}
+			break;
+		case 4:					/* CALL cc */
+			w = z80_fetch16(c);
+			if (z80_cond(c, y)) {
+				z80_push(c, c->pc);
+				c->pc = w;
+				t += 17;
+			} else
+				t += 10;
+			break;
+		case 5:
+			if (!q) {			/* PUSH */
+				z80_push(c, p == 3 ? Z80_AF(c) : z80_rp(c, p, idx));
+				t += 11;
+			} else if (p == 0) {	/* CALL */
+				w = z80_fetch16(c);
+				z80_push(c, c->pc);
+				c->pc = w;
+				t += 17;
+			} else				/* ED (DD/FD were taken above) */
+				t += z80_ed(c);
+			break;
+		case 6:
+			z80_alu(c, y, z80_fetch(c));
+			t += 7;
+			break;
+		default:				/* RST */
+			z80_push(c, c->pc);
+			c->pc = (unsigned short)(y * 8);
+			t += 11;
+			break;
+		}
+		break;
+	}
+	c->cycles += t;
+	return t;
+}
+
+/* Maskable interrupt, data is the byte on the bus in the acknowledge.
+ * Returns T states taken, 0 when not accepted. */
+static inline int z80_int(struct z80 *c, unsigned char data)
+{
+	if (!c->iff1 || c->ei_delay)
+		return 0;
+	c->halted = 0;				/* PC is already past the HALT */
+	c->iff1 = c->iff2 = 0;
+	z80_inc_r(c);
+	z80_push(c, c->pc);
+	switch (c->im) {
+	case 0:						/* Only RST n is supported */
+		c->pc = data & 0x38;
+		c->cycles += 13;
+		return 13;
+	case 1:
+		c->pc = 0x0038;
+		c->cycles += 13;
+		return 13;
+	default:
+		c->pc = z80_rd16(c, (unsigned short)(c->i << 8 | (data & 0xfe)));
+		c->cycles += 19;
+		return 19;
+	}
+}
+
+#endif
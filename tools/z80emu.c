@@ -0,0 +1,697 @@
+/*
+ * z80emu - run SuperMEZ80 Z80 images on the host with the firmware IO map
+ *
+ * Build (from the top of the tree, cpmath.h is the firmware's coprocessor):
+ *   sed -n -f tools/cpmath.sed emuz80_z80ram.c > cpmath.h
+ *   cc -O2 -I. -o z80emu tools/z80emu.c
+ *
+ * Usage: z80emu [-i N] [-p] [-b] [-I] [-n INSNS] IMAGE
+ *   IMAGE     emuz80_z80ram.c (boots images[N] of its image table, like
+ *             the firmware), a table from mkimage, name.hex, or
+ *             name.bin[@ADDR] (default 0x0000, started at 0x0000)
+ *   -i N      image table entry (default 0, BOOT_IMAGE)
+ *   -p        console on a new pty instead of stdin/stdout
+ *   -b        batch: stdin is not put in raw mode, and the run ends once
+ *             stdin is at EOF and the Z80 keeps finding RX empty
+ *   -I        raise /INT like USE_Z80_INT (INT_CTRL / INT_VECT ports)
+ *   -n INSNS  stop after INSNS instructions
+ *
+ * This is the reference model of the PIC side: the ports behave as
+ * CLC_ISR and the io_rd[] / io_wr[] handlers do, including 0xFF from
+ * unmapped ports, apart from the points below. Mapped are UART_DREG/CREG/
+ * BREG, CLK_REG, the timer (TIM_US runs on T states at the CLK_REG
+ * clock), the blitter and the arithmetic coprocessor, which both finish
+ * within the OUT. The coprocessor is the firmware's own code, taken out by
+ * tools/cpmath.sed. Not modelled and read as 0xFF: the IO statistics and
+ * trace (0x08-0x0B), disk (0x10-0x15), block transfer (0x18-0x1D) and
+ * snapshot (0x28-0x2A) ports; tools/cosim runs the firmware itself for
+ * those. RAM is a flat 64KB, the PIC itself only reaches 0x0000-0x7FFF.
+ *
+ * Where the model differs from the firmware:
+ * - The UART has no baud rate, a byte written to UART_DREG is out at
+ *   once. UART_CREG always reports TX ready, where the firmware clears
+ *   bit1 while its 128 byte TX buffer is full, and a UART_BREG write
+ *   applies at once, so bit7 (change pending) never reads 1. This keeps
+ *   the T state counts those of the program, not of the serial line.
+ * - There is no data EEPROM. The board starts as one never calibrated:
+ *   Z80_CLK (6MHz) and CLK_REG reads 0xFF, then 0xF0 | index after a
+ *   write, as the firmware does. Bit7 (store as the boot clock) is not
+ *   kept and 0x40 (calibrate, the PIC resets) is ignored.
+ *
+ * Ctrl-\ (the firmware console key) or a HALT nothing can wake ends the
+ * run, then instruction, T state and per port IN/OUT counts go to stderr.
+ */
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "cpmath.h"
+#include "lz.h"
+#include "z80.h"
+
+#define RAM_SIZE	0x10000
+
+/* Ports, as in emuz80_z80ram.c */
+#define UART_DREG	0x00
+#define UART_CREG	0x01
+#define UART_BREG	0x02
+#define CLK_REG		0x03
+#define INT_CTRL	0x06
+#define INT_VECT	0x07
+#define TIM_US		0x20
+#define TIM_TICKL	0x24
+#define TIM_TICKH	0x25
+#define TIM_STAT	0x26
+#define BLT_SRCL	0x30
+#define BLT_DSTL	0x32
+#define BLT_LENL	0x34
+#define BLT_VAL		0x36
+#define BLT_CMD		0x37
+#define CP_DATA		0x38
+#define CP_CMD		0x39
+
+#define BLT_TOP		0x8000
+#define BLT_COPY	0
+#define BLT_MOVE	1
+#define BLT_FILL	2
+#define BLT_CMP		3
+
+#define INT_RX		0x01
+#define INT_TX		0x02
+#define INT_TICK	0x04
+
+#define CONSOLE_KEY	0x1c
+#define RX_SIZE		128		/* UART_RXBUF_SIZE */
+#define BAUD_TABLE_SIZE	9
+#define EOF_POLLS	100000	/* -b: empty RX reads after EOF before the end */
+
+static const unsigned clk_table[] = {	/* kHz */
+	2500, 4000, 5000, 6000, 8000, 10000, 12000, 14000, 16000, 18000, 20000
+};
+#define CLK_TABLE_SIZE	(sizeof(clk_table) / sizeof(clk_table[0]))
+#define CLK_NONE	0x0f
+#define Z80_CLK_KHZ	6000	/* Z80_CLK, the boot clock while none is stored */
+
+static unsigned char ram[RAM_SIZE];
+static struct z80 cpu;
+
+static struct {
+	int in_fd, out_fd;
+	unsigned char rx[RX_SIZE];
+	int rx_rp, rx_wp;
+	int eof, batch, done;
+	unsigned long empty;	/* RX empty reads in a row */
+	unsigned char baud, clk;	/* clk: CLK_REG index, CLK_NONE for Z80_CLK */
+	unsigned khz;
+	unsigned char int_on, int_mask, int_vect;
+	unsigned long long tick_base;	/* T states at the last 1ms tick */
+	unsigned tick_period, tick_ms;
+	unsigned char ticks;
+	unsigned char tim_latch[4];
+	unsigned short blt[3];		/* Source, destination, length */
+	unsigned char blt_val, blt_status;
+	unsigned char cp_op[9], cp_res[8];	/* Coprocessor operands, results */
+	unsigned char cp_wi, cp_ri, cp_status;
+	unsigned long n_in[256], n_out[256];
+} io;
+
+static struct termios saved_tio;
+static int raw_tty;
+
+/* Image loading */
+
+static unsigned crc16(const unsigned char *p, size_t n)
+{
+	unsigned crc = 0;
+	int i;
+
+	while (n--) {
+		crc ^= (unsigned)*p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = crc & 0x8000 ? (crc << 1 ^ 0x1021) & 0xffff : (crc << 1) & 0xffff;
+	}
+	return crc;
+}
+
+static char *slurp(const char *path, long *size)
+{
+	FILE *fp = fopen(path, "rb");
+	char *buf;
+
+	if (!fp) {
+		perror(path);
+		exit(1);
+	}
+	fseek(fp, 0, SEEK_END);
+	*size = ftell(fp);
+	rewind(fp);
+	buf = malloc(*size + 1);
+	if (!buf || fread(buf, 1, *size, fp) != (size_t)*size) {
+		perror(path);
+		exit(1);
+	}
+	buf[*size] = '\0';
+	fclose(fp);
+	return buf;
+}
+
+/* Bytes of 'unsigned char NAME[] = { ... };' in C source, -1 if missing */
+static long c_array(const char *text, const char *name, unsigned char *out, long max)
+{
+	char key[80];
+	const char *p = text, *e;
+	size_t klen;
+	long n = 0;
+
+	snprintf(key, sizeof(key), "unsigned char %s[]", name);
+	klen = strlen(key);
+	for (;;) {				/* the definition, not the extern */
+		if (!(p = strstr(p, key)))
+			return -1;
+		p += klen;
+		while (*p == ' ')
+			p++;
+		if (*p == '=')
+			break;
+	}
+	p = strchr(p, '{');
+	for (p++; *p && *p != '}'; ) {
+		if (p[0] == '/' && p[1] == '/') {
+			if (!(p = strchr(p, '\n')))
+				break;
+			continue;
+		}
+		if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+			unsigned long v = strtoul(p, (char **)&e, 16);
+
+			if (n >= max || v > 0xff)
+				return -1;
+			out[n++] = (unsigned char)v;
+			p = e;
+			continue;
+		}
+		p++;
+	}
+	return n;
+}
+
+/* Body of the table 'NAME[] = {' up to its closing '};' */
+static const char *c_table(const char *text, const char *name)
+{
+	char key[80];
+	const char *p;
+
+	snprintf(key, sizeof(key), "%s[] = {", name);
+	p = strstr(text, key);
+	return p ? p + strlen(key) : NULL;
+}
+
+/* Boot images[n] of a firmware image table into ram[], returns the entry */
+static unsigned load_table(const char *path, const char *text, int n)
+{
+	static unsigned char data[LZ_BOUND(RAM_SIZE)], out[RAM_SIZE];
+	const char *p = c_table(text, "images"), *s;
+	unsigned entry, seg, nseg, addr, len, crc, lz, i;
+	char name[40], arr[40];
+	long m;
+
+	for (i = 0; p; i++) {
+		do {				/* next row that is not a comment */
+			if ((p = strchr(p, '\n')))
+				p++;
+		} while (p && *p == '/');
+		if (!p || sscanf(p, " { \"%39[^\"]\", %x, %u, %u }", name, &entry, &seg, &nseg) != 4) {
+			p = NULL;
+			break;
+		}
+		if ((int)i == n)
+			break;
+	}
+	if (!p) {
+		fprintf(stderr, "%s: no image %d in images[]\n", path, n);
+		exit(1);
+	}
+	s = c_table(text, "image_segs");
+	for (i = 0; s && i < seg + nseg; ) {
+		if (!(s = strchr(s, '\n')))
+			break;
+		if (*++s == '/')		/* comment rows */
+			continue;
+		if (sscanf(s, " { %x, %x, %x, %u, %39[A-Za-z0-9_] }", &addr, &len, &crc, &lz, arr) != 5)
+			break;
+		if (i++ < seg)
+			continue;
+		m = c_array(text, arr, data, sizeof(data));
+		if (m < 0) {
+			fprintf(stderr, "%s: no array %s\n", path, arr);
+			exit(1);
+		}
+		if (lz)
+			m = lz_decompress(data, m, out, sizeof(out));
+		else
+			memcpy(out, data, m);
+		if (m < (long)len || addr + len > RAM_SIZE) {
+			fprintf(stderr, "%s: segment %s is short\n", path, arr);
+			exit(1);
+		}
+		memcpy(ram + addr, out, len);
+		if (crc16(ram + addr, len) != crc)
+			fprintf(stderr, "%s: segment %s CRC %04X, expected %04X\n",
+				path, arr, crc16(ram + addr, len), crc);
+	}
+	if (i != seg + nseg) {
+		fprintf(stderr, "%s: image_segs[] too short for %s\n", path, name);
+		exit(1);
+	}
+	fprintf(stderr, "z80emu: %s, %u segment(s), entry %04X\r\n", name, nseg, entry);
+	return entry;
+}
+
+static int hexbyte(const char *p)
+{
+	int v = 0, i;
+
+	for (i = 0; i < 2; i++) {
+		v <<= 4;
+		if (isdigit((unsigned char)p[i]))
+			v |= p[i] - '0';
+		else if (isxdigit((unsigned char)p[i]))
+			v |= toupper((unsigned char)p[i]) - 'A' + 10;
+		else
+			return -1;
+	}
+	return v;
+}
+
+static unsigned load_hex(const char *path, const char *text)
+{
+	const char *p = text;
+	unsigned entry = 0;
+	int n, i, type, addr;
+
+	while ((p = strchr(p, ':'))) {
+		n = hexbyte(p + 1);
+		addr = hexbyte(p + 3) << 8 | hexbyte(p + 5);
+		type = hexbyte(p + 7);
+		if (n < 0 || addr < 0 || type < 0) {
+			fprintf(stderr, "%s: bad record\n", path);
+			exit(1);
+		}
+		if (type == 0x00)
+			for (i = 0; i < n; i++)
+				ram[(addr + i) & 0xffff] = (unsigned char)hexbyte(p + 9 + i * 2);
+		else if (type == 0x01)
+			break;
+		else if (type == 0x03 || type == 0x05)
+			entry = hexbyte(p + 13) << 8 | hexbyte(p + 15);
+		p++;
+	}
+	return entry;
+}
+
+static unsigned load(const char *arg, int n)
+{
+	char path[256], *at;
+	const char *ext;
+	unsigned long addr = 0;
+	char *text;
+	long size;
+
+	snprintf(path, sizeof(path), "%s", arg);
+	ext = strrchr(path, '.');
+	at = strrchr(path, '@');
+	if (at && ext && at > ext) {
+		*at = '\0';
+		addr = strtoul(at + 1, NULL, 0) & 0xffff;
+	}
+	text = slurp(path, &size);
+	if (ext && !strcmp(ext, ".c"))
+		return load_table(path, text, n);
+	if (ext && !strcmp(ext, ".hex"))
+		return load_hex(path, text);
+	if (addr + size > RAM_SIZE) {
+		fprintf(stderr, "%s: does not fit at %04lX\n", path, addr);
+		exit(1);
+	}
+	memcpy(ram + addr, text, size);
+	free(text);
+	return 0;
+}
+
+/* Console */
+
+static void console_restore(void)
+{
+	if (raw_tty)
+		tcsetattr(0, TCSANOW, &saved_tio);
+}
+
+static void console_init(int pty)
+{
+	struct termios t;
+
+	io.in_fd = 0;
+	io.out_fd = 1;
+	if (pty) {
+		int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+		if (fd < 0 || grantpt(fd) || unlockpt(fd)) {
+			perror("pty");
+			exit(1);
+		}
+		if (!tcgetattr(fd, &t)) {
+			cfmakeraw(&t);
+			tcsetattr(fd, TCSANOW, &t);
+		}
+		fprintf(stderr, "z80emu: console on %s\n", ptsname(fd));
+		io.in_fd = io.out_fd = fd;
+		return;
+	}
+	if (io.batch || !isatty(0) || tcgetattr(0, &saved_tio))
+		return;
+	t = saved_tio;
+	cfmakeraw(&t);
+	tcsetattr(0, TCSANOW, &t);
+	raw_tty = 1;
+	atexit(console_restore);
+}
+
+/* Move waiting input into the RX buffer, wait up to ms for it */
+static void console_poll(int ms)
+{
+	struct pollfd pfd = { io.in_fd, POLLIN, 0 };
+	unsigned char c;
+
+	if (io.eof || poll(&pfd, 1, ms) <= 0)
+		return;
+	while (((io.rx_wp + 1) % RX_SIZE) != io.rx_rp) {
+		if (read(io.in_fd, &c, 1) != 1) {
+			if (io.in_fd == 0)
+				io.eof = 1;
+			return;
+		}
+		if (c == CONSOLE_KEY) {
+			io.done = 1;
+			return;
+		}
+		io.rx[io.rx_wp] = c;
+		io.rx_wp = (io.rx_wp + 1) % RX_SIZE;
+		if (poll(&pfd, 1, 0) <= 0)
+			return;
+	}
+}
+
+/* RX polling programs spin on UART_CREG, ease off the host while idle */
+static int rx_ready(void)
+{
+	if (io.rx_wp != io.rx_rp) {
+		io.empty = 0;
+		return 1;
+	}
+	console_poll(io.empty > 10000 ? 1 : 0);
+	if (io.rx_wp != io.rx_rp) {
+		io.empty = 0;
+		return 1;
+	}
+	if (++io.empty > EOF_POLLS && io.eof && io.batch)
+		io.done = 1;
+	return 0;
+}
+
+/* Timer, in T states at the selected clock */
+
+static unsigned long long tstate_us(unsigned long long t)
+{
+	return t * 1000 / io.khz;
+}
+
+static void tick_update(void)
+{
+	unsigned long long per_ms = io.khz;
+
+	while (cpu.cycles - io.tick_base >= per_ms) {
+		io.tick_base += per_ms;
+		if (!io.tick_period || ++io.tick_ms < io.tick_period)
+			continue;
+		io.tick_ms = 0;
+		if (io.ticks != 0xff)
+			io.ticks++;
+	}
+}
+
+static unsigned char int_pending(void)
+{
+	return (unsigned char)(((io.rx_wp != io.rx_rp ? INT_RX : 0) | INT_TX
+		| (io.ticks ? INT_TICK : 0)) & io.int_mask);
+}
+
+/* Blitter, as blt_exec() */
+static unsigned char blt_exec(unsigned char cmd)
+{
+	unsigned src = io.blt[0], dst = io.blt[1], len = io.blt[2], n;
+
+	if (dst + len > BLT_TOP || (cmd != BLT_FILL && src + len > BLT_TOP))
+		return 1;
+	switch (cmd) {
+	case BLT_COPY:
+		for (n = 0; n < len; n++)	/* LDIR order */
+			ram[dst + n] = ram[src + n];
+		break;
+	case BLT_MOVE:
+		memmove(ram + dst, ram + src, len);
+		break;
+	case BLT_FILL:
+		memset(ram + dst, io.blt_val, len);
+		io.blt[1] += len;
+		io.blt[2] = 0;
+		return 0;
+	case BLT_CMP:
+		for (n = 0; n < len && ram[src + n] == ram[dst + n]; n++)
+			;
+		len = n;
+		break;
+	default:
+		return 1;
+	}
+	io.blt[0] += len;
+	io.blt[1] += len;
+	io.blt[2] -= len;
+	return io.blt[2] ? 2 : 0;
+}
+
+/* Ports */
+
+static unsigned char port_in(void *ctx, unsigned short port)
+{
+	unsigned long long us;
+	unsigned char c, p = port & 0xff;
+
+	(void)ctx;
+	io.n_in[p]++;
+	switch (p) {
+	case UART_DREG:
+		if (!rx_ready())
+			return 0xff;
+		c = io.rx[io.rx_rp];
+		io.rx_rp = (io.rx_rp + 1) % RX_SIZE;
+		return c;
+	case UART_CREG:
+		return (unsigned char)((rx_ready() ? 0x01 : 0) | 0x02);
+	case UART_BREG:
+		return io.baud;
+	case CLK_REG:
+		return (unsigned char)(CLK_NONE << 4 | io.clk);	/* Never calibrated */
+	case INT_CTRL:
+		return io.int_on ? int_pending() : 0xff;
+	case INT_VECT:
+		return io.int_on ? io.int_vect : 0xff;
+	case TIM_US:
+		us = tstate_us(cpu.cycles);
+		io.tim_latch[0] = us & 0xff;
+		io.tim_latch[1] = (us >> 8) & 0xff;
+		io.tim_latch[2] = (us >> 16) & 0xff;
+		io.tim_latch[3] = (us >> 24) & 0xff;
+		return io.tim_latch[0];
+	case TIM_US + 1:
+	case TIM_US + 2:
+	case TIM_US + 3:
+		return io.tim_latch[p - TIM_US];
+	case TIM_TICKL:
+		return io.tick_period & 0xff;
+	case TIM_TICKH:
+		return io.tick_period >> 8;
+	case TIM_STAT:
+		tick_update();
+		c = io.ticks;
+		io.ticks = 0;
+		return c;
+	case BLT_SRCL: case BLT_SRCL + 1:
+	case BLT_DSTL: case BLT_DSTL + 1:
+	case BLT_LENL: case BLT_LENL + 1:
+		c = p - BLT_SRCL;
+		return (io.blt[c >> 1] >> (c & 1) * 8) & 0xff;
+	case BLT_VAL:
+		return io.blt_val;
+	case BLT_CMD:
+		return io.blt_status;
+	case CP_DATA:
+		return io.cp_res[io.cp_ri++ & 7];
+	case CP_CMD:
+		return io.cp_status;
+	}
+	return 0xff;				/* Unmapped */
+}
+
+static void port_out(void *ctx, unsigned short port, unsigned char v)
+{
+	unsigned char p = port & 0xff;
+
+	(void)ctx;
+	io.n_out[p]++;
+	switch (p) {
+	case UART_DREG:
+		if (write(io.out_fd, &v, 1) != 1)
+			io.done = 1;
+		break;
+	case UART_BREG:
+		if (v < BAUD_TABLE_SIZE)
+			io.baud = v;		/* Applied at once, TX never waits here */
+		break;
+	case CLK_REG:
+		if ((v & 0x0f) < CLK_TABLE_SIZE && v != 0x40) {
+			tick_update();
+			io.clk = v & 0x0f;
+			io.khz = clk_table[io.clk];
+		}
+		break;
+	case INT_CTRL:
+		io.int_mask = v & (INT_RX | INT_TX | INT_TICK);
+		break;
+	case INT_VECT:
+		io.int_vect = v;
+		break;
+	case TIM_TICKL:
+		io.tick_period = (io.tick_period & 0xff00) | v;
+		io.tick_ms = 0;
+		break;
+	case TIM_TICKH:
+		io.tick_period = (io.tick_period & 0x00ff) | v << 8;
+		io.tick_ms = 0;
+		break;
+	case BLT_SRCL: case BLT_SRCL + 1:
+	case BLT_DSTL: case BLT_DSTL + 1:
+	case BLT_LENL: case BLT_LENL + 1:
+		p -= BLT_SRCL;
+		if (p & 1)
+			io.blt[p >> 1] = (io.blt[p >> 1] & 0x00ff) | v << 8;
+		else
+			io.blt[p >> 1] = (io.blt[p >> 1] & 0xff00) | v;
+		break;
+	case BLT_VAL:
+		io.blt_val = v;
+		break;
+	case BLT_CMD:
+		io.blt_status = blt_exec(v);
+		break;
+	case CP_DATA:
+		if (io.cp_wi < sizeof(io.cp_op))
+			io.cp_op[io.cp_wi++] = v;
+		break;
+	case CP_CMD:
+		io.cp_wi = io.cp_ri = 0;
+		io.cp_status = cp_exec(v, io.cp_op, io.cp_res);
+		break;
+	}
+}
+
+static double now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void report(double secs)
+{
+	int p;
+
+	fprintf(stderr, "\r\nz80emu: %llu instructions, %llu T states (%.3f s at %u kHz)\r\n",
+		cpu.insns, cpu.cycles, tstate_us(cpu.cycles) / 1e6, io.khz);
+	fprintf(stderr, "z80emu: %.3f s host, %.1f MIPS\r\n",
+		secs, secs > 0 ? cpu.insns / secs / 1e6 : 0.0);
+	fprintf(stderr, "port         IN        OUT\r\n");
+	for (p = 0; p < 256; p++)
+		if (io.n_in[p] || io.n_out[p])
+			fprintf(stderr, "  %02X %10lu %10lu\r\n", p, io.n_in[p], io.n_out[p]);
+}
+
+int main(int argc, char **argv)
+{
+	const char *image = NULL;
+	unsigned long long limit = 0;
+	int i, n = 0, pty = 0;
+	unsigned char p;
+	double t0;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-i") && i + 1 < argc)
+			n = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			limit = strtoull(argv[++i], NULL, 0);
+		else if (!strcmp(argv[i], "-p"))
+			pty = 1;
+		else if (!strcmp(argv[i], "-b"))
+			io.batch = 1;
+		else if (!strcmp(argv[i], "-I"))
+			io.int_on = 1;
+		else if (argv[i][0] != '-' && !image)
+			image = argv[i];
+		else {
+			image = NULL;
+			break;
+		}
+	}
+	if (!image) {
+		fprintf(stderr, "usage: z80emu [-i N] [-p] [-b] [-I] [-n INSNS] IMAGE\n");
+		return 2;
+	}
+	z80_reset(&cpu);
+	cpu.mem = ram;
+	cpu.in = port_in;
+	cpu.out = port_out;
+	cpu.pc = load(image, n);
+	io.clk = CLK_NONE;
+	io.khz = Z80_CLK_KHZ;
+	console_init(pty);
+
+	t0 = now();
+	while (!io.done) {
+		z80_step(&cpu);
+		if (io.int_on && io.int_mask) {
+			tick_update();
+			p = int_pending();
+			if (p && cpu.iff1)
+				z80_int(&cpu, (unsigned char)((io.int_vect & 0xfe)
+					+ (p & INT_RX ? 0 : p & INT_TX ? 2 : 4)));
+		}
+		if (!(cpu.insns & 0xfffff))	/* Ctrl-\ while nothing reads RX */
+			console_poll(0);
+		if (cpu.halted && (!cpu.iff1 || !io.int_on)) {
+			fprintf(stderr, "\r\nz80emu: HALT at %04X\r\n", (cpu.pc - 1) & 0xffff);
+			break;
+		}
+		if (limit && cpu.insns >= limit)
+			break;
+	}
+	report(now() - t0);
+	return 0;
+}